@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+# ds2cgb.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+
+from s2plot import *
+import numpy
+
+N = 2000
+P = numpy.random.uniform(-1.0, 1.0, (N,3)).astype(numpy.float32)
+
+def cb(t, kc, moving):
+    """Only the moving points go back through python; the rest is redrawn from C"""
+    try:
+        P[:N/10] += numpy.random.uniform(-0.01, 0.01, (N/10,3)).astype(numpy.float32)
+        ds2ugb(moving, P[:N/10])
+    except Exception, e:
+        print e
+
+def main():
+    s2opendo("/s2mono")
+    s2swin(-1.,1., -1.,1., -1.,1.)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    col = (0.5*(P + 1.)).astype(numpy.float32)
+    moving = ds2cgb('p', P[:N/10], {'r':1., 'g':1., 'b':0.}, 3.)
+    still = ds2cgb('p', P[N/10:], col[N/10:], 2.)
+    axes = numpy.array([[-1,0,0],[1,0,0], [0,-1,0],[0,1,0], [0,0,-1],[0,0,1]], numpy.float32)
+    lines = ds2cgb('l', axes, axes*0.5 + 0.5)
+    
+    for bufid in (moving, still, lines):
+        ds2agb(bufid)
+    cs2scbx(cb, moving)
+    
+    s2disp(-1,1)
+
+if __name__ == '__main__':
+	main()
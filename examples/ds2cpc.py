@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+# ds2cpc.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import numpy
+from s2plot import *
+
+def main():
+    N = 20000000
+    
+    s2opendo("/s2mono")
+    s2swin(-1.,1., -1.,1., -1.,1.)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    # a clumpy cloud: gaussian blobs around random centres
+    centres = numpy.random.uniform(-0.8, 0.8, (200,3))
+    P = (centres[numpy.random.randint(0, 200, N)] + numpy.random.normal(0., 0.05, (N,3))).astype(numpy.float32)
+    col = numpy.clip(0.5 + P, 0., 1.).astype(numpy.float32)
+    
+    # at most a million points per frame, picked for the current camera
+    pcid = ds2cpc(P, col, 1000000)
+    del P, col
+    ds2apc(pcid)
+    
+    s2disp(-1,1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+# ds2vnbb.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import numpy
+from s2plot import *
+
+N = 200000
+P = numpy.random.normal(0.0, 0.3, (N,3)).astype(numpy.float32)
+col = numpy.random.uniform(0.5, 1.0, (N,3)).astype(numpy.float32)
+size = numpy.random.uniform(0.002, 0.01, N).astype(numpy.float32)
+stretch = {"x":0.0, "y":0.0, "z":0.0}
+
+def cb(t, kc):
+    global tid, sid
+    try:
+        # one call for every star, twinkling by rotating the sprites
+        # the handle keeps the back-to-front order from the last frame
+        ds2vnbb(P, stretch, size, col, tid, 0.8, 's', (t*30.0) % 360.0, sid)
+    except Exception, e:
+        print e
+
+def main():
+    global tid, sid
+    s2opendo("/S2MONO")
+    s2swin(-1.0,1.0, -1.0,1.0, -1.0,1.0)
+    s2box("BCDE",0,0,"BCDE",0,0,"BCDE",0,0)
+    
+    tid = ss2lt("firetile2_pow2_rgb.tga")
+    sid = ss2cds()
+    cs2scb(cb)
+    
+    s2disp(-1,1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,62 @@
+#!/usr/bin/env python
+# ns2cisc.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import numpy
+from s2plot import *
+
+CELLS = 128
+
+def temperature(P):
+    """Colour every vertex at once: P is an (N,3) array of positions"""
+    t = numpy.sqrt(((P - 0.5*(CELLS - 1))**2).sum(axis=1))/CELLS
+    return numpy.column_stack((t, 1.0 - t, 0.5*numpy.ones_like(t)))
+
+def main():
+    n = CELLS
+    
+    s2opendo("/s2mono")
+    s2swin(0, n-1, 0, n-1, 0, n-1)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    x = numpy.linspace(-1.0, 1.0, n)
+    i, j, k = numpy.meshgrid(x, x, x, indexing='ij')
+    grid = (numpy.sin(4*i)*numpy.cos(4*j) + numpy.sin(4*k)).astype(numpy.float32)
+    
+    isid = ns2cisc(grid, n, n, n, 0, n-1, 0, n-1, 0, n-1,
+        None, 0.3, 1, 'o', 1.0, temperature, 1)
+    ns2dis(isid, 0)
+    
+    s2disp(-1, 1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,66 @@
+#!/usr/bin/env python
+# ns2cmesh.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import sys
+import os, random
+import numpy
+from s2plot import *
+import sys
+import os
+import numpy
+from s2plot import *
+
+def main():
+    nu, nv = 64, 32
+    
+    s2opendo("/s2mono")
+    s2swin(-1.,1., -1.,1., -1.,1.)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    # a sphere as a (nu x nv) grid of shared vertices joined by quads
+    u, v = numpy.meshgrid(numpy.linspace(0, 2*numpy.pi, nu), numpy.linspace(0, numpy.pi, nv))
+    verts = numpy.column_stack((numpy.cos(u.ravel())*numpy.sin(v.ravel()),
+                                numpy.sin(u.ravel())*numpy.sin(v.ravel()),
+                                numpy.cos(v.ravel()))).astype(numpy.float32)
+    i, j = numpy.meshgrid(numpy.arange(nu-1), numpy.arange(nv-1))
+    k = (j*nu + i).ravel()
+    faces = numpy.column_stack((k, k+1, k+nu+1, k+nu)).astype(numpy.int32)
+    col = (0.5*(verts + 1.)).astype(numpy.float32)
+    
+    meshid = ns2cmesh(verts, faces, col)
+    ns2dmesh(meshid)
+    
+    s2disp(-1,1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,70 @@
+#!/usr/bin/env python
+# ns2cvrp.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import numpy
+from s2plot import *
+
+# A 512^3 volume that is explored at interactive rates: distant bricks are
+# drawn from coarse levels of the pyramid, and near ones refine once the
+# camera stops moving.
+
+N = 512
+
+def cb(t, kc):
+    ds2dvrp(vrpid)
+
+def main():
+    global vrpid
+    s2opendo("/s2monof")
+    s2swin(0, N-1, 0, N-1, 0, N-1)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    ss2srm(SHADE_FLAT)
+    ss2sl({'r':0.8, 'g':0.8, 'b':0.8}, 0, None, None, 0)
+    s2icm("rainbow", 2000, 3000)
+    s2scir(2000, 3000)
+    
+    x = numpy.linspace(-1.0, 1.0, N).astype(numpy.float32)
+    grid = numpy.empty((N, N, N), dtype=numpy.float32)
+    for i in range(N):
+        grid[i] = numpy.exp(-8.0*(x[i]**2 + x[:,None]**2 + x[None,:]**2)) \
+            * (1.0 + 0.3*numpy.sin(40.0*x[None,:]))
+    
+    vrpid = ns2cvrp(grid, N, N, N, 0, N-1, 0, N-1, 0, N-1,
+        None, 's', 1.0, 0.0, 0.0, 0.6, 8*2**20)
+    
+    cs2scb(cb)
+    
+    s2disp(-1, 1)
+
+if __name__ == '__main__':
+	main()
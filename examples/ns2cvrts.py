@@ -0,0 +1,70 @@
+#!/usr/bin/env python
+# ns2cvrts.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import sys
+from s2plot import *
+
+# Usage: python ns2cvrts.py snapshot*.fits
+# Plays a series of FITS cubes through one volume render, one frame per
+# redraw. Frames are decoded ahead of time by a background thread.
+
+def cb(t, kc, step=[0]):
+    frame, nframes, ready = ss2qts(tsid)
+    # only move on when the next frame is already decoded
+    if ready > 0:
+        step[0] = (frame + 1) % nframes
+    ds2dvr(vrid, ss2sts(tsid, step[0]))
+
+def main():
+    global tsid, vrid
+    tsid = ss2cts(sys.argv[1:], 8)
+    # every frame has the shape of the first
+    na, nb, nc = ss2mfits(sys.argv[1])[0].shape
+    
+    s2opendo("/s2monof")
+    s2swin(0, na-1, 0, nb-1, 0, nc-1)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    ss2srm(SHADE_FLAT)
+    ss2sl({'r':0.8, 'g':0.8, 'b':0.8}, 0, None, None, 0)
+    s2icm("rainbow", 2000, 3000)
+    s2scir(2000, 3000)
+    
+    # datamin > datamax auto-scales
+    vrid = ns2cvrts(tsid, 0, na-1, 0, nb-1, 0, nc-1, None, 's', 1., 0., 0., 0.6)
+    
+    cs2scb(cb)
+    
+    s2disp(-1, 1)
+
+if __name__ == '__main__':
+	main()
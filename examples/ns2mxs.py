@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+# ns2mxs.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import numpy
+from s2plot import *
+
+# A small blob orbits inside a large static field. Only the region it moves
+# through is marked, so each frame re-summarises a handful of blocks instead
+# of the whole grid.
+
+N = 256
+R = 12
+level = 0.5
+
+def blob(grid, c, sign):
+    a, b, e = [int(v) for v in c]
+    sl = (slice(a-R, a+R+1), slice(b-R, b+R+1), slice(e-R, e+R+1))
+    x = numpy.arange(-R, R+1, dtype=numpy.float32)
+    i, j, k = numpy.meshgrid(x, x, x, indexing='ij')
+    grid[sl] += sign*numpy.exp(-(i*i + j*j + k*k)/(0.2*R*R))
+    ns2mxs(xsid, a-R, a+R, b-R, b+R, e-R, e+R)
+
+def cb(t, kc, last=[None]):
+    c = (N/2 + N/4*numpy.cos(t), N/2 + N/4*numpy.sin(t), N/2)
+    if last[0] is not None:
+        blob(grid, last[0], -1.0)
+    blob(grid, c, 1.0)
+    last[0] = c
+    ns2dxs(xsid)
+
+def main():
+    global grid, xsid
+    s2opendo("/s2mono")
+    s2swin(0, N-1, 0, N-1, 0, N-1)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    x = numpy.linspace(-1.0, 1.0, N)
+    i, j, k = numpy.meshgrid(x, x, x, indexing='ij')
+    grid = (0.3*numpy.sin(6*i)*numpy.cos(6*j)*numpy.sin(6*k)).astype(numpy.float32)
+    
+    xsid = ns2cxs(grid, N, N, N, 0, N-1, 0, N-1, 0, N-1,
+        None, level, 1, {'r':1.0, 'g':0.6, 'b':0.2})
+    
+    cs2scb(cb)
+    
+    s2disp(-1, 1)
+
+if __name__ == '__main__':
+	main()
@@ -0,0 +1,75 @@
+#!/usr/bin/env python
+# ns2wxs.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import numpy
+from s2plot import *
+
+# Press 1 and 2 to step the isosurface level down and up; the surface is
+# re-extracted on a worker thread and the old one stays on screen until the
+# new one is ready
+
+N = 384
+level = [0.3]
+
+def ncb(num):
+    if num == 1:
+        level[0] -= 0.05
+    elif num == 2:
+        level[0] += 0.05
+    ns2sxsl(xsid, level[0], 1)
+
+def cb(t, kc):
+    # draws the newest finished surface
+    ns2dxs(xsid)
+
+def main():
+    global xsid
+    s2opendo("/s2mono")
+    s2swin(0, N-1, 0, N-1, 0, N-1)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    x = numpy.linspace(-1.0, 1.0, N)
+    i, j, k = numpy.meshgrid(x, x, x, indexing='ij')
+    grid = (numpy.sin(4*i)*numpy.cos(4*j) + numpy.sin(4*k)).astype(numpy.float32)
+    
+    # returns at once; the first surface appears when its build is done
+    xsid = ns2cxs(grid, N, N, N, 0, N-1, 0, N-1, 0, N-1,
+        None, level[0], 1, {'r':0.2, 'g':0.7, 'b':1.0}, 1)
+    
+    cs2scb(cb)
+    cs2sncb(ncb)
+    
+    s2disp(-1, 1)
+
+if __name__ == '__main__':
+	main()
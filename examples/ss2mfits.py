@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+# ss2mfits.py
+#
+# Copyright 2008 Swinburne University of Technology.
+#
+# This file is part of the S2PLOT Python module.
+#
+# The S2PLOT Python module is free software: you can redistribute it
+# and/or modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation, either version 3 of
+# the License, or (at your option) any later version.  
+#
+# The S2PLOT Python module is distributed in the hope that it will be
+# useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+# of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with the S2PLOT Python module.  If not, see
+# <http://www.gnu.org/licenses/>.
+#
+# We would appreciate it if research outcomes using S2PLOT would
+# provide the following acknowledgement:
+#
+# "Three-dimensional visualisation was conducted with the S2PLOT
+# progamming library"
+#
+# and a reference to 
+#
+# D.G.Barnes, C.J.Fluke, P.D.Bourke & O.T.Parry, 2006, Publications
+# of the Astronomical Society of Australia, 23(2), 82-93.
+#
+# original version: Nick Jones, October 2007.
+import sys
+from s2plot import *
+
+# Usage: python ss2mfits.py cube.fits level
+# The cube is memory-mapped, and only the central quarter of it is read, in
+# its stored type and byte order, by the isosurface extractor.
+
+def cb(t, kc):
+    ns2dxs(xsid)
+
+def main():
+    global xsid
+    grid, scale, offset = ss2mfits(sys.argv[1])
+    level = float(sys.argv[2])
+    na, nb, nc = grid.shape
+    a1, a2 = na/4, 3*na/4
+    b1, b2 = nb/4, 3*nb/4
+    c1, c2 = nc/4, 3*nc/4
+    
+    s2opendo("/s2mono")
+    s2swin(a1, a2, b1, b2, c1, c2)
+    s2box("BCDET",0,0,"BCDET",0,0,"BCDET",0,0)
+    
+    xsid = ns2cxs(grid, na, nb, nc, a1, a2, b1, b2, c1, c2,
+        None, level, 1, {'r':0.3, 'g':0.8, 'b':0.4}, 0, scale, offset)
+    
+    cs2scb(cb)
+    
+    s2disp(-1, 1)
+
+if __name__ == '__main__':
+	main()
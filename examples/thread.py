@@ -61,11 +61,11 @@ def main():
     s2disp(-1,1)
 
 if __name__ == '__main__':
-    #backgroundDisp = DispThread()
-    #backgroundDisp.start()
+    # s2disp releases the GIL, so the worker keeps running alongside the display
+    backgroundDisp = DispThread()
+    backgroundDisp.daemon = True
+    backgroundDisp.start()
     main()
-    #while True:
-    #    pass
     
     
     
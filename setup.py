@@ -95,6 +95,7 @@ def main():
                            library_dirs = libPath,
                            runtime_library_dirs = libPath,
                            extra_compile_args=['-ftree-vectorize', '-fopenmp'],
+                           extra_link_args=['-fopenmp'],
                            )
 
     setup(name = 's2plot-python',
@@ -102,16 +102,16 @@ static PyMethodDef S2PlotMethods[] = {
     {"s2help", s2plot_s2help, METH_VARARGS, "s2help(helpstr)\n\nSet the custom help string.  This is shown on the second press of the F1 key for S2PLOT programs, if it is set."}, /* NEW */
     // XY(Z) PLOTS
     {"s2errb", s2plot_s2errb, METH_VARARGS, "s2errb(dir, n, xpts, ypts, zpts, edelt, termsize)\n\nDraw error bars at the coordinates (xpts[i], ypts[i], zpts[i]) which should be numpy arrays. Error bars are drawn in the direction indicated by argument dir as described below. One-sided error bar lengths are given by edelt, such that for error bars in eg. the x direction, error bars are drawn to xpts[i]+edelt[i], to xpts[i]-edelt[i], or to both. Argument termsize gives the size of the terminals to draw for each error bar; it is given in an integer increment of the current linewidth. Eg. if t=1, then end points are one pixel larger than the line width used to draw the bars.\n\n    dir: 1	for error bar in	+x	direction\n    2	...	+y	...\n    3	...	+z	...\n    4	...	-x	...\n    5	...	-y	...\n    6	...	-z	...\n    7	...	+/-x	...\n    8	...	+/-y	...\n    9	...	+/-z	..."},
-    {"s2funt", s2plot_s2funt, METH_VARARGS, "s2funt(fx, fy, fz, n, tmin, tmax)\n\nDraw a curve defined by parametric equations fx(t), fy(t) and fz(t), which must all be callables taking a float and returning a float.  N points are constructed, uniformly spaced from tmin to tmax."},
-    {"s2funtc", s2plot_s2funtc, METH_VARARGS, "s2funtc(fx, fy, fz, fc, n, tmin, tmax)\n\nLike s2funt, but an additional function fc (whose return value is clipped to the range [0,1]) controls the colour of the line, according to the colour index range currently set.  fc must also be a callable taking a float and returning a float."},
-    {"s2funxy", s2plot_s2funxy, METH_VARARGS, "s2funxy(fxy, nx, ny, xmin, xmax, ymin, ymax, ctl)\n\nDraw the surface described by the function fxy which must return a float given 2 floats. The function is evaluated on a nx * ny grid whose world coordinates extend from (xmin,ymin) to (xmax,ymax). The ctl argument has the following effect:\n\n        * ctl = 0: curve plotted in current window and viewport. Caller is responsible for setting the viewport and world coordinate system suitably.\n        * ctl = 1: s2env is called automatically to fit the plot in the current viewport. \n\n    Beware that these functions consume memory to store all the function evaluations prior to triangulating the surface."},
-    {"s2funxz", s2plot_s2funxz, METH_VARARGS, "s2funxz(fxz, nx, nz, xmin, xmax, zmin, zmax, ctl)\n\nDraw the surface described by the function fxz which must return a float given 2 floats. The function is evaluated on a nx * nz grid whose world coordinates extend from (xmin,zmin) to (xmax,zmax). The ctl argument has the following effect:\n\n        * ctl = 0: curve plotted in current window and viewport. Caller is responsible for setting the viewport and world coordinate system suitably.\n        * ctl = 1: s2env is called automatically to fit the plot in the current viewport. \n\n    Beware that these functions consume memory to store all the function evaluations prior to triangulating the surface."},
-    {"s2funyz", s2plot_s2funyz, METH_VARARGS, "s2funyz(fyz, ny, nz, ymin, ymax, zmin, zmax, ctl)\n\nDraw the surface described by the function fyz which must return a float given 2 floats. The function is evaluated on a ny * nz grid whose world coordinates extend from (ymin,zmin) to (ymax,zmax). The ctl argument has the following effect:\n\n        * ctl = 0: curve plotted in current window and viewport. Caller is responsible for setting the viewport and world coordinate system suitably.\n        * ctl = 1: s2env is called automatically to fit the plot in the current viewport. \n\n    Beware that these functions consume memory to store all the function evaluations prior to triangulating the surface."},
-    {"s2funxyr", s2plot_s2funxyr, METH_VARARGS, "s2funxyr(fxy, nx, ny, xmin, xmax, ymin, ymax, ctl, rmin, rmax)\n\nDraw surface as per s2funxy, but with explicit settings for the colour range mapping between rmin and rmax."},
-    {"s2funxzr", s2plot_s2funxzr, METH_VARARGS, "s2funxzr(fxz, nx, nz, xmin, xmax, zmin, zmax, ctl, rmin, rmax)\n\nDraw surface as per s2funxz, but with explicit settings for the colour range mapping between rmin and rmax."},
-    {"s2funyzr", s2plot_s2funyzr, METH_VARARGS, "s2funyzr(fyz, ny, nz, ymin, ymax, zmin, zmax, ctl, rmin, rmax)\n\nDraw surface as per s2funyz, but with explicit settings for the colour range mapping between rmin and rmax."},
-    {"s2funuv", s2plot_s2funuv, METH_VARARGS, "s2funuv(fx, fy, fz, fcol, umin, umax, uDIV, vmin, vmax, vDIV)\n\nPlot the parametric function (generally a surface) defined by { fx(u,v), fy(u,v), fz(u,v) } (each return a float given 2 floats), coloured by fcol(u,v) with fcol required to fall in the range [0,1].  fcol is then mapped to the current colormap index range (set with s2scir). The range of u and v values are specified by umin,umax and vmin, vmax, and the number of divisions by uDIV and vDIV."},
-    {"s2funuva", s2plot_s2funuva, METH_VARARGS, "s2funuva(fx, fy, fz, fcol, trans, falpha, umin, umax, uDIV, vmin, vmax, vDIV)\n\nPlot the parametric function (generally a surface) defined by { (fx(u,v), fy(u,v), fz(u,v) }, coloured by fcol(u,v) with fcol required to fall in the range [0,1]. fcol is then mapped to the current colormap index range (set with s2scir). Transparency is applied to the surface with falpha(u,v), defining the opacity in the range [0,1]. The range of u and v values are specified by umin,umax and vmin, vmax, and the number of divisions by uDIV and vDIV.\n\nFor a constant opacity, implement falpha(u,v){return const_value;}."},
+    {"s2funt", s2plot_s2funt, METH_VARARGS, "s2funt(fx, fy, fz, n, tmin, tmax, vectorised=0)\n\nDraw a curve defined by parametric equations fx(t), fy(t) and fz(t), which must all be callables taking a float and returning a float.  N points are constructed, uniformly spaced from tmin to tmax.\n\n    If vectorised is non-zero, each function is instead called once with a float32 numpy array of all N values of t, and must return an array (or sequence) of N values.\n\n    Any of the functions may instead be a native C function float f(float *t): a ctypes CFUNCTYPE(c_float, POINTER(c_float)) instance, a numba cfunc (or any object with an integer .address), or the address of the function wrapped in ctypes.c_void_p (e.g. c_void_p(int(ffi.cast('uintptr_t', f))) for cffi). A bare integer is not accepted, so that a stray number cannot be called. Native functions are called directly by s2plot without entering python."},
+    {"s2funtc", s2plot_s2funtc, METH_VARARGS, "s2funtc(fx, fy, fz, fc, n, tmin, tmax, vectorised=0)\n\nLike s2funt, but an additional function fc (whose return value is clipped to the range [0,1]) controls the colour of the line, according to the colour index range currently set.  fc must also be a callable taking a float and returning a float.\n\n    As for s2funt, pass a non-zero trailing vectorised argument to call all four functions once with a numpy array of t values.\n\n    Native C functions are accepted as for s2funt."},
+    {"s2funxy", s2plot_s2funxy, METH_VARARGS, "s2funxy(fxy, nx, ny, xmin, xmax, ymin, ymax, ctl, vectorised=0)\n\nDraw the surface described by the function fxy which must return a float given 2 floats. The function is evaluated on a nx * ny grid whose world coordinates extend from (xmin,ymin) to (xmax,ymax). The ctl argument has the following effect:\n\n        * ctl = 0: curve plotted in current window and viewport. Caller is responsible for setting the viewport and world coordinate system suitably.\n        * ctl = 1: s2env is called automatically to fit the plot in the current viewport. \n\n    Beware that these functions consume memory to store all the function evaluations prior to triangulating the surface.\n\n    If vectorised is non-zero, fxy is called once with two float32 numpy arrays of shape (nx,ny) holding the x and y coordinates of every grid node, and must return an array of the same shape.\n\n    Any of the functions may instead be a native C function float f(float *u, float *v), given as for s2funt."},
+    {"s2funxz", s2plot_s2funxz, METH_VARARGS, "s2funxz(fxz, nx, nz, xmin, xmax, zmin, zmax, ctl, vectorised=0)\n\nDraw the surface described by the function fxz which must return a float given 2 floats. The function is evaluated on a nx * nz grid whose world coordinates extend from (xmin,zmin) to (xmax,zmax). The ctl argument has the following effect:\n\n        * ctl = 0: curve plotted in current window and viewport. Caller is responsible for setting the viewport and world coordinate system suitably.\n        * ctl = 1: s2env is called automatically to fit the plot in the current viewport. \n\n    Beware that these functions consume memory to store all the function evaluations prior to triangulating the surface.\n\n    If vectorised is non-zero, fxz is called once with two float32 numpy arrays of shape (nx,nz) holding the x and z coordinates of every grid node, and must return an array of the same shape.\n\n    Native C functions are accepted as for s2funxy."},
+    {"s2funyz", s2plot_s2funyz, METH_VARARGS, "s2funyz(fyz, ny, nz, ymin, ymax, zmin, zmax, ctl, vectorised=0)\n\nDraw the surface described by the function fyz which must return a float given 2 floats. The function is evaluated on a ny * nz grid whose world coordinates extend from (ymin,zmin) to (ymax,zmax). The ctl argument has the following effect:\n\n        * ctl = 0: curve plotted in current window and viewport. Caller is responsible for setting the viewport and world coordinate system suitably.\n        * ctl = 1: s2env is called automatically to fit the plot in the current viewport. \n\n    Beware that these functions consume memory to store all the function evaluations prior to triangulating the surface.\n\n    If vectorised is non-zero, fyz is called once with two float32 numpy arrays of shape (ny,nz) holding the y and z coordinates of every grid node, and must return an array of the same shape.\n\n    Native C functions are accepted as for s2funxy."},
+    {"s2funxyr", s2plot_s2funxyr, METH_VARARGS, "s2funxyr(fxy, nx, ny, xmin, xmax, ymin, ymax, ctl, rmin, rmax, vectorised=0)\n\nDraw surface as per s2funxy, but with explicit settings for the colour range mapping between rmin and rmax. The vectorised argument is as for s2funxy."},
+    {"s2funxzr", s2plot_s2funxzr, METH_VARARGS, "s2funxzr(fxz, nx, nz, xmin, xmax, zmin, zmax, ctl, rmin, rmax, vectorised=0)\n\nDraw surface as per s2funxz, but with explicit settings for the colour range mapping between rmin and rmax. The vectorised argument is as for s2funxz."},
+    {"s2funyzr", s2plot_s2funyzr, METH_VARARGS, "s2funyzr(fyz, ny, nz, ymin, ymax, zmin, zmax, ctl, rmin, rmax, vectorised=0)\n\nDraw surface as per s2funyz, but with explicit settings for the colour range mapping between rmin and rmax. The vectorised argument is as for s2funyz."},
+    {"s2funuv", s2plot_s2funuv, METH_VARARGS, "s2funuv(fx, fy, fz, fcol, umin, umax, uDIV, vmin, vmax, vDIV, vectorised=0)\n\nPlot the parametric function (generally a surface) defined by { fx(u,v), fy(u,v), fz(u,v) } (each return a float given 2 floats), coloured by fcol(u,v) with fcol required to fall in the range [0,1].  fcol is then mapped to the current colormap index range (set with s2scir). The range of u and v values are specified by umin,umax and vmin, vmax, and the number of divisions by uDIV and vDIV.\n\n    If vectorised is non-zero, each function is called once with two float32 numpy arrays of shape (uDIV+1,vDIV+1) holding the u and v values of every grid node, and must return an array of the same shape.\n\n    Any of the functions may instead be a native C function float f(float *u, float *v), given as for s2funt."},
+    {"s2funuva", s2plot_s2funuva, METH_VARARGS, "s2funuva(fx, fy, fz, fcol, trans, falpha, umin, umax, uDIV, vmin, vmax, vDIV, vectorised=0)\n\nPlot the parametric function (generally a surface) defined by { (fx(u,v), fy(u,v), fz(u,v) }, coloured by fcol(u,v) with fcol required to fall in the range [0,1]. fcol is then mapped to the current colormap index range (set with s2scir). Transparency is applied to the surface with falpha(u,v), defining the opacity in the range [0,1]. The range of u and v values are specified by umin,umax and vmin, vmax, and the number of divisions by uDIV and vDIV.\n\nFor a constant opacity, implement falpha(u,v){return const_value;}.\n\nThe vectorised argument is as for s2funuv.\n\n    Native C functions are accepted as for s2funuv."},
     // IMAGES/SURFACES
     {"s2surp", s2plot_s2surp, METH_VARARGS,"s2surp(data, nx, ny, i1, i2, j1, j2, datamin, datamax,  tr)\n\nDraw a colour surface representation of the 2-dimensional numpy-array, data, containing nx * ny values. A sub-section only of the array is drawn, viz. data[i1:i2][j1:j2]. Data values <= datamin  are mapped to the first colour in the colour map (see s2scir), while values >= datamax are mapped to the last entry in the colour map. The mapping is linear at this stage. The final argument, tr, defines the transformation of the data cell locations to world coordinates in the X-Y space, and the transformation of data values to the Z ordinate, as follows:\n\n    x = tr[0] + tr[1] * i + tr[2] * j\n    y = tr[3] + tr[4] * i + tr[5] * j\n    z = tr[6] + tr[7] * dataval"},
     {"s2surpa", s2plot_s2surpa, METH_VARARGS,"s2surpa(data, nx, ny, i1, i2, j1, j2, datamin, datamax, tr)\n\nDraw a colour surface representation of the 2-dimensional numpy-array, data, containing nx * ny values. A sub-section only of the array is drawn, viz. data[i1:i2][j1:j2]. Data values <= datamin are mapped to the first colour in the colour map (see s2scir), while values >= datamax  are mapped to the last entry in the colour map. The mapping is linear at this stage. This function differs to the simpler s2surp in that the tranformation array provides an arbitrary transform, allowing the surface plot to be placed anywhere in the space oriented at any angle, etc. The transformation is as follows:\n\n    x = tr[0] + tr[1] * i + tr[2] * j + tr[3] * dataval\n    y = tr[4] + tr[5] * i + tr[6] * j + tr[7] * dataval\n    z = tr[8] + tr[9] * i + tr[10]* j + tr[11]* dataval"},
@@ -160,6 +160,11 @@ static PyMethodDef S2PlotMethods[] = {
     {"ns2vf3n", s2plot_ns2vf3n, METH_VARARGS, " ns2vf3n(P, N, col)\n\nDraw a 3-vertex facet with a single colour. The vertices are given by the list P, of 3 {xyz} dicts, normals are specified in the list N of 3 {xyz} dicts, and the RGB colours is col, an {rgb} dict."},
     {"ns2vf3c", s2plot_ns2vf3c, METH_VARARGS, "ns2vf3c(P, col)\n\nDraw a 3-vertex facet with a coloured vertices. The vertices are given by the list P of 3 {xyz} dicts, normals are calculated automatically, and the RGB colours for each vertex are stored in the list col, of 3 {rgb} dicts."},
     {"ns2vf3nc", s2plot_ns2vf3nc, METH_VARARGS, "ns2vf3nc(P, N, col)\n\nThe most general function for drawing a 3-vertex facet with coloured vertices. The vertices are given by the list, P, of 3 {xyz} dicts, normals are in the list, N, of 3 {xyz} dicts, and the RGB colours for vertices are in col, 3 {rgb} dicts. The other 3-vertex functions call this function."},
+    {"ns2vnf3", s2plot_ns2vnf3, METH_VARARGS, "ns2vnf3(P, N, col)\n\nDraw M 3-vertex facets in a single call. The vertices are given by P, a float32 or float64 numpy array of shape (M,3,3). Normals are given by N, an array of the same shape, or are calculated automatically if N is None. The RGB colour col is either a single {rgb} dict, an (M,3) array of per-facet colours, or an (M,3,3) array of per-vertex colours."},
+    {"ns2cmesh", s2plot_ns2cmesh, METH_VARARGS, "ns2cmesh(verts, faces, col)\n\nCreate an indexed mesh and return its id. verts holds the V shared vertex positions, as an (V,3) numpy array or a list of {xyz} dicts. faces is an integer array of shape (F,3) for triangles or (F,4) for quads, indexing into verts. col is a single {rgb} dict, or per-vertex colours as an (V,3) array or a list of {rgb} dicts. Area-weighted vertex normals are calculated when the mesh is created. The mesh keeps its own copy of the data."},
+    {"ns2umesh", s2plot_ns2umesh, METH_VARARGS, "ns2umesh(meshid, verts)\n\nReplace the vertex positions of mesh meshid with verts, which must have the same length as before, and recalculate its normals. The faces and colours are unchanged."},
+    {"ns2dmesh", s2plot_ns2dmesh, METH_VARARGS, "ns2dmesh(meshid)\n\nDraw the mesh meshid, as returned by ns2cmesh. Call it once for static geometry, or from within a dynamic callback."},
+    {"ns2fmesh", s2plot_ns2fmesh, METH_VARARGS, "ns2fmesh(meshid)\n\nFree the mesh meshid. Its id may be reused by a later call to ns2cmesh."},
     {"ns2vf4", s2plot_ns2vf4, METH_VARARGS, "ns2vf4(P, col)\n\nDraw a 4-vertex facet with a single colour. The vertices are given by the list, P, of 4 {xyz} dicts, normals are calculated automatically, and the RGB colour is col, an {rgb} dict."},
     {"ns2vf4n", s2plot_ns2vf4n, METH_VARARGS, "ns2vf4n(P, N, col)\n\nDraw a 4-vertex facet with a single colour. The vertices are given by the list P, normals are specified in the list N ( both 4-lists of {xyz} dicts), and the RGB colours is col, a {rgb} dict."},
     {"ns2vf4c", s2plot_ns2vf4c, METH_VARARGS, "ns2vf4c(P, col)\n\nDraw a 4-vertex facet with a coloured vertices. The vertices are given by the list, P, of 4 {xyz} dicts, normals are calculated automatically, and the RGB colours for each vertex are stored in the list col, of 4 {rgb} dicts."},
@@ -175,12 +180,25 @@ static PyMethodDef S2PlotMethods[] = {
     {"ds2bb", s2plot_ds2bb, METH_VARARGS, "ds2bb(x, y, z, str_x, str_y, str_z, isize, r, g, b, itextid, alpha, trans)\n\nDraw a (dynamic) billboard. This is a textured facet (4 vertex) that sits at a given location and always faces the camera. By using small, rotationally symmetric texture maps, the appearance of soft, 3d objects can be produced at low frame-rate cost. This function should only be called from a dynamic callback: billboards cannot be cached static geometry as they typically change with every refresh.\n\n    The billboard texture is at coordinates (x,y,z), and can be stretched towards the coordinates (str_x, str_y, str_z) (for no stretching, set these coordinates to 0.0). The overall scale of the billboard texture is controlled by isize.\n\n    The RGB texture colour is specified by parameters (r, g, b), and the texture to use is identified by itextid.\n\n    Transparency is controlled by the alpha channel, with value in the range [0,1] and trans:\n\n        * trans = 'o' opaque;\n        * trans = 't' transparent; and\n        * trans = 's' transparency + absorption."},
     {"ds2vbb", s2plot_ds2vbb, METH_VARARGS, "ds2vbb(iP, iStretch, isize, iC, itexid, alpha, trans)\n\nDraw a (dynamic) billboard using vector inputs. This is a textured facet (4 vertex) that sits at a given location and always faces the camera. By using small, rotationally symmetric texture maps, the appearance of soft, 3d objects can be produced at low frame-rate cost. This function should only be called from a dynamic callback: billboards cannot be cached static geometry as they typically change with every refresh.\n\n    The billboard texture is at coordinates iP, an {xyz} dict, and can be stretched towards the coordinates given by iStretch, an {xyz} dict (for no stretching, set these coordinates to 0.0). The overall scale of the billboard texture is controlled by isize.\n\n    The RGB texture colour is specified by iC, an {rgb} dict, and the texture to use is identified by itextid.\n\n    Transparency is controlled by the alpha channel, with value in the range [0,1] and trans:\n\n        * trans = 'o' opaque;\n        * trans = 't' transparent; and\n        * trans = 's' transparency + absorption."},
     {"ds2vbbr", s2plot_ds2vbbr, METH_VARARGS, "ds2vbbr(iP, iStretch, isize, ipangle, iC, itexid, alpha, trans)\n\nDraw a (dynamic) \"billboard\", with rotation ipangle (in degrees) of the texture about the view direction."},
+    {"ds2vnbb", s2plot_ds2vnbb, METH_VARARGS, "ds2vnbb(iP, iStretch, isize, iC, itexid, alpha, trans, ipangle=None, sortid=-1)\n\nDraw N (dynamic) billboards in one call. iP is an (N,3) array or a list of {xyz} dicts; iStretch and iC are either a single {xyz}/{rgb} dict shared by all billboards or one per billboard, and isize is a number or an array of N sizes. If ipangle (a number or N angles in degrees) is given the billboards are rotated as in ds2vbbr. Unless trans is 'o' the billboards are drawn back to front from the current camera; pass a handle from ss2cds as sortid to keep the order from one frame to the next, so that a smoothly moving camera is re-sorted in near-linear time. Use this function only from within a dynamic callback."},
+    {"ss2cds", s2plot_ss2cds, METH_VARARGS, "ss2cds()\n\nCreate a depth sort handle and return its id. Give it as the sortid of one batch of ds2vnbb or ns2vnpa calls drawn every frame, and that batch is sorted starting from its previous order."},
+    {"ss2fds", s2plot_ss2fds, METH_VARARGS, "ss2fds(sortid)\n\nFree a depth sort handle created by ss2cds. Its id may be reused by a later call to ss2cds."},
     {"ds2vbbp", s2plot_ds2vbbp, METH_VARARGS, "ds2vbbp(iP, offset, aspect, isize, iC, itexid, alpha, trans)\n\nDraw a (dynamic) \"billboard\", with aspect ratio width:height instead of stretch, and offset in screen coords (x,y) [offset.z ignored]"}, /* NEW */
     {"ds2tb", s2plot_ds2tb, METH_VARARGS, "ds2tb(x, y, z, x_off, y_off, text, scaletext)\n\nDraw text at position (x,y,z) that always faces the camera. Use this function only from within a dynamic callback. offset is in character units along Right and Up vectors - use this to displace labels in screen coordinates. If scaletext is true (non-zero), then text further from the camera will be made larger so that labels are equally legible for all distances.\n\n    NOTE: this function uses the S2PLOT attributes for character height (size) and colour."},
     {"ds2vtb", s2plot_ds2vtb, METH_VARARGS, "ds2vtb(iP, ioff, text, scaletext)\n\nDraw text at position iP, an {xyz} dict, that faces the camera with vector inputs. Use this function only from within a dynamic callback. The components of iOff, an {xyz} dict, are in character units along Right and Up vectors - use this to displace labels in screen coordinates. If scaletext is true (non-zero), then text further from the camera will be made larger so that labels are equally legible for all distances.\n\n    NOTE: this function uses the S2PLOT attributes for character height (size) and colour. The z component of ioff is ignored."},
     {"ds2protect", s2plot_ds2protect, METH_VARARGS, "ds2protect()\n\nProtect the dynamic goemetry.  Typically use this by setting ds2protect() at the end of your standard dynamic callback, then then call ds2unprotect() if key presses / events processed by other callbacks will result in a changed geometry state.  Use with caution ... incorrect use can result in Total Memory Consumption."},
     {"ds2unprotect", s2plot_ds2unprotect, METH_VARARGS, "ds2unprotect()\n\nUnprotect the dynamic goemetry.  Typically use this by setting ds2protect() at the end of your standard dynamic callback, then then call ds2unprotect() if key presses / events processed by other callbacks will result in a changed geometry state.  Use with caution ... incorrect use can result in Total Memory Consumption."},
     {"ds2isprotected", s2plot_ds2isprotected, METH_VARARGS, "ds2isprotected()\n\nEnquire protected state with of the dynamic geometry."},
+    {"ds2cgb", s2plot_ds2cgb, METH_VARARGS, "ds2cgb(kind, P, col, size=1, itexid=0, alpha=1, trans='o')\n\nCreate a retained geometry buffer and return its id. kind is 'p' for points, 'l' for line segments (P holds two vertices per segment) or 'b' for billboards. P is an (N,3) array or a list of {xyz} dicts, col is one {rgb} dict or one colour per vertex. size is the point size or line width in pixels, or the billboard size; itexid, alpha and trans are used by billboards only, which are depth sorted unless trans is 'o'. The buffer keeps its own copy of the data."},
+    {"ds2ugb", s2plot_ds2ugb, METH_VARARGS, "ds2ugb(bufid, P, col=None)\n\nReplace the positions (and optionally the colours) of geometry buffer bufid. P must have the same number of vertices as before; pass None to update the colours only."},
+    {"ds2dgb", s2plot_ds2dgb, METH_VARARGS, "ds2dgb(bufid)\n\nDraw geometry buffer bufid. Use this function only from within a dynamic callback."},
+    {"ds2agb", s2plot_ds2agb, METH_VARARGS, "ds2agb(bufid, on=1)\n\nRedraw geometry buffer bufid automatically in the current panel before every dynamic callback, without calling into python. A dynamic callback is not needed. Use on=0 to detach it again."},
+    {"ds2fgb", s2plot_ds2fgb, METH_VARARGS, "ds2fgb(bufid)\n\nFree geometry buffer bufid. Its id may be reused by a later call to ds2cgb."},
+    {"ds2cpc", s2plot_ds2cpc, METH_VARARGS, "ds2cpc(P, col, budget=1000000, tolerance=0)\n\nBuild a level-of-detail point cloud and return its id. P is an (N,3) array or a list of {xyz} dicts and col a single {rgb} dict or one colour per point. The points are sorted into an octree; each frame at most budget points are drawn, refining the nodes that look largest from the camera first and none smaller than tolerance (radians across)."},
+    {"ds2spc", s2plot_ds2spc, METH_VARARGS, "ds2spc(pcid, budget, tolerance=0)\n\nSet the per-frame point budget and error tolerance of point cloud pcid."},
+    {"ds2dpc", s2plot_ds2dpc, METH_VARARGS, "ds2dpc(pcid)\n\nDraw point cloud pcid at the level of detail suited to the current camera, and return the number of points drawn. Use this function only from within a dynamic callback."},
+    {"ds2apc", s2plot_ds2apc, METH_VARARGS, "ds2apc(pcid, on=1)\n\nRedraw point cloud pcid automatically in the current panel before every dynamic callback, as ds2agb does for geometry buffers. Use on=0 to detach it again."},
+    {"ds2fpc", s2plot_ds2fpc, METH_VARARGS, "ds2fpc(pcid)\n\nFree point cloud pcid. Its id may be reused by a later call to ds2cpc."},
     // CALLBACK AND HANDLE SYSTEM
     {"cs2scb", s2plot_cs2scb, METH_VARARGS,"cs2scb(cbfn)\n\nSet the dynamic geometry callback function; use None as an argument to cancel callback. The callback function must be of the form: cbfn(time, keycount) where time is the current system time and keycount records the number of times that the space bar has been pressed.  cbfn has no return value.\n\n    The callback function can be toggled on/off by pressing the z key."},
     {"cs2ecb", s2plot_cs2ecb, METH_VARARGS,"cs2ecb()\n\nEnable the previously disabled dynamic geometry callback."},
@@ -206,6 +224,8 @@ static PyMethodDef S2PlotMethods[] = {
     {"ss2sbc", s2plot_ss2sbc, METH_VARARGS, "ss2sbc(r, g, b)\n\nSet the background colour. This call should almost always be followed by calls to s2scr to set the 0th colour index to be the same as the background, and the 1st colour index to be the opposite. Some S2PLOT internals always use white to draw text, and setting the background colour to a light value might result in some text being difficult or impossible to read."},
     {"ss2sfra", s2plot_ss2sfra, METH_VARARGS, "ss2sfra(rot)\n\nSet the fisheye rotation angle (degrees). This is only functional if the projection is in use is a fisheye, and it has the effect of rotating the projection \"pole\" away from the centre of the \"screen\", towards the bottom of the screen, by rot degrees."},
     {"ss2qpt", s2plot_ss2qpt, METH_VARARGS, "ss2qpt()\n\nFetch the projection type of the device in use. Return values are:\n    * 0 = perspective\n    * 1 = orthographic\n    * 2 = fisheye"},
+    {"ss2sfb", s2plot_ss2sfb, METH_VARARGS, "ss2sfb(fps, hysteresis=0.1)\n\nHold the current panel near fps frames per second by scaling a quality factor between 0.05 and 1. When the smoothed frame period is more than a fraction hysteresis (in [0,1)) over or under budget, the factor is scaled by the ratio of budget to period and then held for a number of frames while the timings settle. The point budgets of ds2cpc clouds follow the factor; other callbacks can read it with ss2qfq and scale their own detail (e.g. isosurface resolution). fps <= 0 turns the controller off."},
+    {"ss2qfq", s2plot_ss2qfq, METH_VARARGS, "ss2qfq()\n\nReturn (quality, frame_ms, callback_ms): the quality factor set by ss2sfb (1 when off), and the smoothed frame period and time spent in the dynamic callback, in milliseconds."},
     // ADVANCED CAMERA CONTROL
     {"ss2sc", s2plot_ss2sc, METH_VARARGS, "ss2sc(position, up, vdir, worldcoords)\n\nSet the camera position, up vector and view direction (vdir); all are {xyz} dicts. If worldcoords > 0 then caller has given world coordinates, otherwise they are viewport-relative coordinates."},
     {"ss2qc", s2plot_ss2qc, METH_VARARGS, "ss2qc(worldcoords)\n\nQuery the camera position, up vector and view direction (vdir), which are returned as a tuple of {xyz} dicts. If worldcoords > 0 then return world coordinates, otherwise return viewport-relative coordinates.\n\n    Please note that this function returns camera position of LAST update. Calling it immediately after ss2sc without allowing a refresh or redraw will not return identical arguments as given to ss2sc. The return value can be checked for this possibility: if non-zero, then programmed changes to the camera are still pending."},
@@ -228,14 +248,33 @@ static PyMethodDef S2PlotMethods[] = {
     {"ss2ltt", s2plot_ss2ltt, METH_VARARGS, "ss2ltt(latex_command)\n\nCreate a texture with LaTeX commands.  The return value is a dict containing keys:\n'texture_id' - the texture handle (as used by eg. ns2vf4x etc)\n'aspect' - the x:y aspect ratio of the texture map."}, /* NEW */
     {"ns2vf3a", s2plot_ns2vf3a, METH_VARARGS, "ns2vf3a(P, col, trans, alpha)\n\nDraw a transparent 3-vertex facet with a single colour. The vertices are given by the 3-list, P, of {xyz} dicts, normals are calculated automatically, and the RGB colour is col, a {rgb} dict. Transparency is controlled by the alpha channel, with value in the range [0,1] and trans:\n\n        * trans = 'o' opaque vertex;\n        * trans = 't' addition blending - never gets dimmer; and\n        * trans = 's' standard blending - can get dimmer."},
     {"ns2vpa", s2plot_ns2vpa, METH_VARARGS, "ns2vpa(P, col, size, trans, alpha)\n\nDraw a transparent thick dot.\n* P - the location of the dot as an (x,y,z) dict.\n* col - the dot colour as an (r,g,b) dict.\n* size - the size of the dot as a float.\n* trans - 'o', 't' or 's' for opaque, additional blending, or standard blending respectively\n* alpha - the alpha in [0,1]."},
-    {"ns2cis", s2plot_ns2cis, METH_VARARGS, "ns2cis(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, trans, alpha, red, green, blue)\n\nDraw an isosurface of a data volume, at given level. The data in grid is a 3D numpy array volume; in order to be able to dynamically modify the grid, it should be of numpy dtype: numpy.float32.  grid is indexed by:\n    grid[0..(adim-1)][0..(bdim-1)][0..(cdim-1)].\n\n    The slice of data actually plotted is indexed by [a1..a2][b1..b2][c1..c2] (as for s2vect3, for example).\n\n    tr is the transformation matrix (as a numpy array) which maps indices into the grid onto the x, y and z axes of the 3d world space. The standard (non-rotated, non-skewed) transformation would have tr[2], tr[3], tr[5], tr[7], tr[9] and tr[10] all zero.\n\n    The transformation matrix is:\n       x = tr[0] + tr[1] * ia + tr[2] * ib + tr[3] * ic\n       y = tr[4] + tr[5] * ia + tr[6] * ib + tr[7] * ic\n       z = tr[8] + tr[9] * ia + tr[10]* ib + tr[11]* ic\n\n    Provide tr = NULL to use the default, unit transformation.\n\n    level gives the level at which the isosurface should be drawn. Skip every nth cell as given by resolution. If n = 1 then no skipping occurs.\n\n    Transparency of the surface is controlled by the alpha-channel parameter, alpha, between 0 and 1, and trans:\n\n        * trans = 'o' for opaque;\n        * trans = 't' for \"piling up\"; and\n        * trans = 's' for transparency that can occlude. \n\n    The RGB colour of the isosurface is provided by red, green and blue in the range [0,1]."},
-    {"ns2cisc", s2plot_ns2cisc, METH_VARARGS, "ns2cisc(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, trans, alpha, fcol)\n\nDraw an isosurface of a data volume, at given level, using a function to calculate the colour over the surface. The data in grid is a 3D numpy array volume; in order to be able to dynamically modify the grid, it should be of numpy dtype: numpy.float32.  grid is indexed by:\n    grid[0..(adim-1)][0..(bdim-1)][0..(cdim-1)].\n\n    The slice of data actually plotted is indexed by [a1..a2][b1..b2][c1..c2] (as for s2vect3, for example).\n\n    tr is the transformation matrix (a numpy array) which maps indices into the grid onto the x, y and z axes of the 3d world space. The standard (non-rotated, non-skewed) transformation would have tr[2], tr[3], tr[5], tr[7], tr[9] and tr[10] all zero.\n\n    The transformation matrix is:\n       x = tr[0] + tr[1] * ia + tr[2] * ib + tr[3] * ic\n       y = tr[4] + tr[5] * ia + tr[6] * ib + tr[7] * ic\n       z = tr[8] + tr[9] * ia + tr[10]* ib + tr[11]* ic\n\n    Provide tr = NULL to use the default, unit transformation.\n\n    level gives the level at which the isosurface should be drawn. Skip every nth cell as given by resolution. If n = 1 then no skipping occurs.\n\n    Transparency of the surface is controlled by the alpha-channel parameter, alpha, between 0 and 1, and trans:\n\n        * trans = 'o' for opaque;\n        * trans = 't' for \"piling up\"; and\n        * trans = 's' for transparency that can occlude. \n\n    The colour of the isosurface is specified by the function:\n\n       fcol(x, y, z)\n\n    which returns a colour dict with keys {rgb}."},
+    {"ns2vnpa", s2plot_ns2vnpa, METH_VARARGS, "ns2vnpa(P, col, size, trans, alpha, sortid=-1)\n\nDraw N transparent thick dots in one call. P is an (N,3) array or a list of {xyz} dicts, col a single {rgb} dict or one colour per dot, and size a number or an array of N sizes. Unless trans is 'o' the dots are drawn back to front from the current camera, which suits dots drawn each frame from a dynamic callback; sortid is as for ds2vnbb."},
+    {"ns2cis", s2plot_ns2cis, METH_VARARGS, "ns2cis(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, trans, alpha, red, green, blue, scale=1, offset=0)\n\nDraw an isosurface of a data volume, at given level. The data in grid is a 3D numpy array volume; in order to be able to dynamically modify the grid, it should be of numpy dtype: numpy.float32.  grid is indexed by:\n    grid[0..(adim-1)][0..(bdim-1)][0..(cdim-1)].\n\n    The slice of data actually plotted is indexed by [a1..a2][b1..b2][c1..c2] (as for s2vect3, for example).\n\n    tr is the transformation matrix (as a numpy array) which maps indices into the grid onto the x, y and z axes of the 3d world space. The standard (non-rotated, non-skewed) transformation would have tr[2], tr[3], tr[5], tr[7], tr[9] and tr[10] all zero.\n\n    The transformation matrix is:\n       x = tr[0] + tr[1] * ia + tr[2] * ib + tr[3] * ic\n       y = tr[4] + tr[5] * ia + tr[6] * ib + tr[7] * ic\n       z = tr[8] + tr[9] * ia + tr[10]* ib + tr[11]* ic\n\n    Provide tr = NULL to use the default, unit transformation.\n\n    level gives the level at which the isosurface should be drawn. Skip every nth cell as given by resolution. If n = 1 then no skipping occurs.\n\n    Transparency of the surface is controlled by the alpha-channel parameter, alpha, between 0 and 1, and trans:\n\n        * trans = 'o' for opaque;\n        * trans = 't' for \"piling up\"; and\n        * trans = 's' for transparency that can occlude. \n\n    The RGB colour of the isosurface is provided by red, green and blue in the range [0,1].\n\n    grid may also be a float64, uint8, int16, uint16, int32 or float16 array of either byte order, read as value*scale + offset. The library works on float32, so such a grid (or a float32 one with a scale or offset) is converted into a float32 copy in one pass; to keep it compact use ns2cxs instead."},
+    {"ns2cisc", s2plot_ns2cisc, METH_VARARGS, "ns2cisc(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, trans, alpha, fcol, vectorised=0, scale=1, offset=0)\n\nDraw an isosurface of a data volume, at given level, using a function to calculate the colour over the surface. The data in grid is a 3D numpy array volume; in order to be able to dynamically modify the grid, it should be of numpy dtype: numpy.float32.  grid is indexed by:\n    grid[0..(adim-1)][0..(bdim-1)][0..(cdim-1)].\n\n    The slice of data actually plotted is indexed by [a1..a2][b1..b2][c1..c2] (as for s2vect3, for example).\n\n    tr is the transformation matrix (a numpy array) which maps indices into the grid onto the x, y and z axes of the 3d world space. The standard (non-rotated, non-skewed) transformation would have tr[2], tr[3], tr[5], tr[7], tr[9] and tr[10] all zero.\n\n    The transformation matrix is:\n       x = tr[0] + tr[1] * ia + tr[2] * ib + tr[3] * ic\n       y = tr[4] + tr[5] * ia + tr[6] * ib + tr[7] * ic\n       z = tr[8] + tr[9] * ia + tr[10]* ib + tr[11]* ic\n\n    Provide tr = NULL to use the default, unit transformation.\n\n    level gives the level at which the isosurface should be drawn. Skip every nth cell as given by resolution. If n = 1 then no skipping occurs.\n\n    Transparency of the surface is controlled by the alpha-channel parameter, alpha, between 0 and 1, and trans:\n\n        * trans = 'o' for opaque;\n        * trans = 't' for \"piling up\"; and\n        * trans = 's' for transparency that can occlude. \n\n    The colour of the isosurface is specified by the function:\n\n       fcol(x, y, z)\n\n    which returns a colour dict with keys {rgb}.\n\n    fcol may instead be a native C function void fcol(float *x, float *y, float *z, float *r, float *g, float *b), given as a ctypes CFUNCTYPE instance, a numba cfunc or a ctypes.c_void_p address (see s2funt); it is then called directly by s2plot.\n\n    If vectorised is non-zero, fcol is instead called once per extraction with an (N,3) float32 array of vertex positions and must return an (N,3) array of colours. The surface is re-coloured when ns2sisl changes its level or ns2dis is called with force set.\n\n    grid may also be a float64, uint8, int16, uint16, int32 or float16 array of either byte order, read as value*scale + offset. As for ns2cis, it is converted into a float32 copy."},
+    {"ns2xis", s2plot_ns2xis, METH_VARARGS, "ns2xis(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, scale=1, offset=0)\n\nExtract the isosurface of grid at level, with the same arguments as ns2cis, and return it as a tuple (verts, normals, faces): (V,3) float32 arrays of vertex positions and unit normals (pointing towards lower values), and an (F,3) int32 array of triangles indexing into verts. The extraction (marching tetrahedra) runs across all OpenMP threads. The result can be drawn with ns2cmesh(verts, faces, col) or kept for analysis.\n\n    grid may also be a float64, uint8, int16, uint16, int32 or float16 array of either byte order, read as value*scale + offset. Such grids are read in place, without a float32 copy."},
+    {"ns2cxs", s2plot_ns2cxs, METH_VARARGS, "ns2cxs(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, col, background=0, scale=1, offset=0)\n\nCreate an isosurface object of grid, with the arguments of ns2cis and a single {rgb} colour, and return its id. The object keeps a reference to grid and a min/max summary of its blocks of cells, so that ns2sxsl only re-extracts the blocks whose range brackets the new level. The extraction is the same as ns2xis.\n\n    If background is non-zero the id is returned at once and the surface is built on a worker thread; it draws nothing until the build is swapped in at the start of a later frame (see ns2qxs and ns2wxs). The grid must not be modified meanwhile.\n\n    grid may also be a float64, uint8, int16, uint16, int32 or float16 array of either byte order, read as value*scale + offset. Such grids are read in place and converted a value at a time, so the object never holds a float32 copy."},
+    {"ns2sxsl", s2plot_ns2sxsl, METH_VARARGS, "ns2sxsl(xsid, level, background=0)\n\nChange the level of isosurface object xsid and re-extract it. With background non-zero the extraction runs on a worker thread and the previous surface keeps being drawn until the new one is swapped in at the start of a later frame; a newer request supersedes an older one still waiting."},
+    {"ns2qxs", s2plot_ns2qxs, METH_VARARGS, "ns2qxs(xsid)\n\nReturn True if isosurface object xsid has no background build outstanding, i.e. it shows its latest level."},
+    {"ns2wxs", s2plot_ns2wxs, METH_VARARGS, "ns2wxs(xsid)\n\nWait until every background build of isosurface object xsid has finished and been swapped in."},
+    {"ns2dxs", s2plot_ns2dxs, METH_VARARGS, "ns2dxs(xsid)\n\nDraw isosurface object xsid. Call it once for static geometry, or from within a dynamic callback."},
+    {"ns2mxs", s2plot_ns2mxs, METH_VARARGS, "ns2mxs(xsid, a1, a2, b1, b2, c1, c2)\n\nMark grid[a1..a2][b1..b2][c1..c2] of isosurface object xsid as changed after modifying the grid in place. The next ns2dxs (or ns2uxs) re-summarises just the blocks of cells touching the region and, if any actually changed, re-extracts the surface, so the cost follows the size of the change rather than the grid. While a background build of the object is in flight, ns2dxs keeps drawing the current surface and leaves the marks for a later frame."},
+    {"ns2uxs", s2plot_ns2uxs, METH_VARARGS, "ns2uxs(xsid, scan=0)\n\nApply the regions marked with ns2mxs to isosurface object xsid now, or with scan non-zero compare a checksum of every block of its grid to find the changes, and re-extract the surface if needed. Returns the number of blocks that changed."},
+    {"ns2fxs", s2plot_ns2fxs, METH_VARARGS, "ns2fxs(xsid)\n\nFree isosurface object xsid. Its id may be reused by a later call to ns2cxs."},
     {"ns2dis", s2plot_ns2dis, METH_VARARGS, "ns2dis(isid, force)\n\nDraw an isosurface object. Set force = 1 to force the surface to be recalculated, e.g. the grid or isosurface level has been changed. Using force = 0 will redisplay previously calculated version of isosurface."},
     {"ns2sisl", s2plot_ns2sisl, METH_VARARGS, "ns2sisl(isid, level)\n\nSelect the isosurface level for the isosurface identified by isid. Changes to the isosurface level will not be displayed until the next call to ns2dis with force = 1."},
     {"ns2sisa", s2plot_ns2sisa, METH_VARARGS, "ns2sisa(isid, alpha, trans)\n\nSet alpha and transparency of isosurface with id isid.  alpha is a float, and trans is a character."},
     {"ns2sisc", s2plot_ns2sisc, METH_VARARGS, "ns2sisc(isid, r, g, b)\n\nSet r, g, b colour of isosurface with id isid."},
-    {"ns2cvr", s2plot_ns2cvr, METH_VARARGS, "ns2cvr(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, trans, datamin, datamax, alphamin, alphamax)\n\nCreate a volume rendering object. To display a volume render object you must use the function ds2dvr from within a dynamic callback.\n\n    The data in grid is a 3D numpy array volume; in order to be able to dynamically modify the grid, it should be of numpy dtype: numpy.float32. grid is indexed by:\n    grid[0..(adim-1)][0..(bdim-1)][0..(cdim-1)].\n\n    The slice of data actually plotted is indexed by [a1..a2][b1..b2][c1..c2].\n\n    tr is the transformation matrix (a numpy array) which maps indices into the grid onto the x, y and z axes of the 3d world space. The standard (non-rotated, non-skewed) transformation would have tr[2], tr[3], tr[5], tr[7], tr[9] and tr[10] all zero.\n\n    The transformation matrix is:\n       x = tr[0] + tr[1] * ia + tr[2] * ib + tr[3] * ic\n       y = tr[4] + tr[5] * ia + tr[6] * ib + tr[7] * ic\n       z = tr[8] + tr[9] * ia + tr[10]* ib + tr[11]* ic\n\n    Provide tr = NULL to use the default, unit transformation.\n\n    Note that the voxels are pixel centred, so care must be taken with drawing bounding boxes (see the example code below for a solution).\n\n    datamin and datamax indicate the range of data values which are mapped to alphamin and alphamax. alpha is the transparency, with 0.0 corresponding to completely transparent (invisible) and 1.0 is opaque. Ordinarily, set datamin and datamax to bracket the signal region of your data, set alphamin to 0.0 and alphamax to something like 0.7.\n\n    There are three transparency modes, controlled by the parameter trans:\n\n        * trans = 'o' for opaque regardless of alpha settings;\n        * trans = 't' for transparency only; and\n        * trans = 's' is transparent allowing absoprtion. \n\n    The RGB colour of the isosurface is provided by red, green and blue in the range [0,1].\n\n    Set datamin > datamax to request auto-scaling.\n\n    Volume rendering works best when the render mode is set to SHADE_FLAT, and only light ambiently. See the example below."},
-    {"ds2dvr", s2plot_ds2dvr, METH_VARARGS, "ds2dvr(vrid, force)\n\nDraw a volume rendering object (dynamic only). Set force to true to make the textures reload, e.g. if you have changed the values of the grid elements."},
+    {"ns2cvr", s2plot_ns2cvr, METH_VARARGS, "ns2cvr(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, trans, datamin, datamax, alphamin, alphamax, scale=1, offset=0)\n\nCreate a volume rendering object. To display a volume render object you must use the function ds2dvr from within a dynamic callback.\n\n    The data in grid is a 3D numpy array volume; in order to be able to dynamically modify the grid, it should be of numpy dtype: numpy.float32. grid is indexed by:\n    grid[0..(adim-1)][0..(bdim-1)][0..(cdim-1)].\n\n    The slice of data actually plotted is indexed by [a1..a2][b1..b2][c1..c2].\n\n    tr is the transformation matrix (a numpy array) which maps indices into the grid onto the x, y and z axes of the 3d world space. The standard (non-rotated, non-skewed) transformation would have tr[2], tr[3], tr[5], tr[7], tr[9] and tr[10] all zero.\n\n    The transformation matrix is:\n       x = tr[0] + tr[1] * ia + tr[2] * ib + tr[3] * ic\n       y = tr[4] + tr[5] * ia + tr[6] * ib + tr[7] * ic\n       z = tr[8] + tr[9] * ia + tr[10]* ib + tr[11]* ic\n\n    Provide tr = NULL to use the default, unit transformation.\n\n    Note that the voxels are pixel centred, so care must be taken with drawing bounding boxes (see the example code below for a solution).\n\n    datamin and datamax indicate the range of data values which are mapped to alphamin and alphamax. alpha is the transparency, with 0.0 corresponding to completely transparent (invisible) and 1.0 is opaque. Ordinarily, set datamin and datamax to bracket the signal region of your data, set alphamin to 0.0 and alphamax to something like 0.7.\n\n    There are three transparency modes, controlled by the parameter trans:\n\n        * trans = 'o' for opaque regardless of alpha settings;\n        * trans = 't' for transparency only; and\n        * trans = 's' is transparent allowing absoprtion. \n\n    The RGB colour of the isosurface is provided by red, green and blue in the range [0,1].\n\n    Set datamin > datamax to request auto-scaling.\n\n    Volume rendering works best when the render mode is set to SHADE_FLAT, and only light ambiently. See the example below.\n\n    grid may also be a float64, uint8, int16, uint16, int32 or float16 array of either byte order, read as value*scale + offset. The library works on float32, so such a grid (or a float32 one with a scale or offset) is converted into a float32 copy in one pass, and later changes to grid are not seen."},
+    {"ds2dvr", s2plot_ds2dvr, METH_VARARGS, "ds2dvr(vrid, force)\n\nDraw a volume rendering object (dynamic only). Set force to true to make the textures reload, e.g. if you have changed the values of the grid elements.\n\n    Set force to -1 to reload them only if the grid has changed since the last such call: if blocks were marked with ns2mvr only those are checked, otherwise a checksum of every block of the grid is compared. This needs a float32 grid, which is read in place; other grids are always reloaded."},
+    {"ss2mfits", s2plot_ss2mfits, METH_VARARGS, "ss2mfits(filename)\n\nMemory-map the primary HDU of a FITS file holding a data cube and return (grid, scale, offset): a read-only numpy array over the file, indexed grid[NAXIS3][NAXIS2][NAXIS1] and keeping its big-endian storage type, and BSCALE and BZERO. Pass scale and offset on to ns2cvr, ns2cis, ns2xis or ns2cxs. Nothing is read until it is used: ns2xis and ns2cxs read and byte-swap the elements they visit, so only the pages under the chosen [a1..a2][b1..b2][c1..c2] are ever loaded, while ns2cvr and ns2cis convert the cube into a float32 copy in one pass."},
+    {"ss2mraw", s2plot_ss2mraw, METH_VARARGS, "ss2mraw(filename, adim, bdim, cdim, dtype, offset=0)\n\nMemory-map a raw binary cube and return it as a read-only numpy array indexed grid[0..adim-1][0..bdim-1][0..cdim-1], with c varying fastest in the file. dtype is any numpy dtype, e.g. '>u2' for big-endian uint16, and offset the number of header bytes to skip. See ss2mfits."},
+    {"ss2cts", s2plot_ss2cts, METH_VARARGS, "ss2cts(files, ring=4, dtype=None, adim=0, bdim=0, cdim=0, skip=0, scale=1, offset=0)\n\nCreate a time series of cubes, one file per frame, and return its id. With dtype None the files are FITS, laid out as for ss2mfits and each scaled by its own BSCALE and BZERO; otherwise they are raw cubes of that numpy dtype (any byte order), adim x bdim x cdim with c fastest after skip header bytes, read as value*scale + offset.\n\n    A background thread decodes the frames following the current one, in the direction of play, into a ring of ring float32 cubes, so playback runs at the speed of the disk rather than stalling at each step. Show the series with ns2cvrts and step it with ss2sts. Series are never freed."},
+    {"ss2sts", s2plot_ss2sts, METH_VARARGS, "ss2sts(tsid, frame)\n\nMake frame the current frame of time series tsid, waiting for it to be decoded if the prefetch thread has not got to it yet, and point its volume render at it. Returns True if the frame on show changed, in which case reload the textures with ds2dvr(vrid, 1). Raises IOError if the frame's file cannot be read as a cube of the series' shape; the file is read again the next time the frame is asked for."},
+    {"ss2qts", s2plot_ss2qts, METH_VARARGS, "ss2qts(tsid)\n\nReturn (frame, nframes, ready) for time series tsid: the current frame, the number of frames, and how many of the frames following the current one are already decoded."},
+    {"ns2cvrts", s2plot_ns2cvrts, METH_VARARGS, "ns2cvrts(tsid, a1, a2, b1, b2, c1, c2, tr, trans, datamin, datamax, alphamin, alphamax)\n\nCreate a volume rendering object showing the current frame of time series tsid, with the arguments of ns2cvr, and return its id. ss2sts switches the frame it shows."},
+    {"ns2cvrp", s2plot_ns2cvrp, METH_VARARGS, "ns2cvrp(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, trans, datamin, datamax, alphamin, alphamax, budget=16777216, pixels=1024)\n\nCreate a multi-resolution volume rendering object, with the arguments of ns2cvr, and return its id. Draw it with ds2dvrp from within a dynamic callback.\n\n    The region is split into bricks 64 voxels across that share their faces with their neighbours. The grid is read in place (as for ns2cxs), and each brick's full-resolution copy and its 2x, 4x, ... box-filtered copies, all covering the same space, are only converted to float when first wanted. Each frame, every brick is shown at the coarsest level at which a voxel still covers about one pixel of a screen pixels high, seen from the camera; if that would draw more than budget voxels, all bricks are coarsened together. Moving the camera only switches between levels already made; while it is still, a few bricks per frame are refined, nearest first, until they reach the wanted level.\n\n    Set datamin > datamax to scale to the range of the region (scaling per brick would not match). The pyramid and its volume renders are never freed."},
+    {"ds2dvrp", s2plot_ds2dvrp, METH_VARARGS, "ds2dvrp(vrpid)\n\nDraw multi-resolution volume rendering object vrpid (dynamic only), choosing each brick's level for the current camera. Returns the number of voxels drawn."},
+    {"ns2mvr", s2plot_ns2mvr, METH_VARARGS, "ns2mvr(vrid, a1, a2, b1, b2, c1, c2)\n\nMark grid[a1..a2][b1..b2][c1..c2] of volume rendering object vrid as changed, so that the next ds2dvr(vrid, -1) checks only the marked blocks instead of scanning the whole grid."},
     {"ns2svrl", s2plot_ns2svrl, METH_VARARGS, "ns2svrl(vrid, datamin, datamax, alphamin, alphamax)\n\nChange the volume rendering data and alpha range (\"level\") for vol rendering object with id, vrid.  After changing, be sure to call ds2dvr with force=1.  No protection is provided against datamin > datamax!"},
     {"ss2ct", s2plot_ss2ct, METH_VARARGS, "ss2ct(width, height)\n\nCreate a texture for the user to fill in as they see fit. Typical use is to call this function, then ss2gt and ss2pt to modify the texture as desired. Function returns the ID of the newly created texture."},
     {"ss2ctt", s2plot_ss2ctt, METH_VARARGS, "ss2ctt(width, height)\n\nCreate a texture as per ss2ct, but texture is for \"transient\" use: this means the texture is much faster to create, but multi-resolution versions are not constructed/used."},
@@ -290,10 +329,314 @@ static PyMethodDef S2PlotMethods[] = {
 };
 
 // helper functions
+
+// double -> float conversion kernels. The vector versions are compiled for
+// their instruction set with target attributes and chosen at import time,
+// so the module still loads on machines without AVX.
+static void convert_d2f_scalar(const double *src, float *dst, npy_intp n){
+    npy_intp i;
+
+    for(i = 0; i < n; i++){
+        dst[i] = (float) src[i];
+    }
+}
+#ifdef S2PY_X86_SIMD
+__attribute__((target("avx2")))
+static void convert_d2f_avx2(const double *src, float *dst, npy_intp n){
+    npy_intp i;
+
+    for(i = 0; i + 4 <= n; i += 4){
+        _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(src + i)));
+    }
+    for(; i < n; i++){
+        dst[i] = (float) src[i];
+    }
+}
+__attribute__((target("avx512f")))
+static void convert_d2f_avx512(const double *src, float *dst, npy_intp n){
+    npy_intp i;
+
+    for(i = 0; i + 8 <= n; i += 8){
+        _mm256_storeu_ps(dst + i, _mm512_cvtpd_ps(_mm512_loadu_pd(src + i)));
+    }
+    for(; i < n; i++){
+        dst[i] = (float) src[i];
+    }
+}
+#endif
+static void (*convert_d2f_kernel)(const double *, float *, npy_intp) = convert_d2f_scalar;
+
+void double_to_float(const double *src, float *dst, npy_intp n){
+    // convert a contiguous run, splitting it across threads when large
+    long c, nchunks;
+
+    if(n < S2PY_OMP_THRESHOLD){
+        convert_d2f_kernel(src, dst, n);
+        return;
+    }
+    nchunks = (long) ((n + S2PY_OMP_CHUNK - 1)/S2PY_OMP_CHUNK);
+    #pragma omp parallel for schedule(static)
+    for(c = 0; c < nchunks; c++){
+        npy_intp lo = (npy_intp) c*S2PY_OMP_CHUNK;
+        npy_intp len = (n - lo < S2PY_OMP_CHUNK) ? n - lo : S2PY_OMP_CHUNK;
+        convert_d2f_kernel(src + lo, dst + lo, len);
+    }
+}
+// strided gathers into contiguous buffers. gather32 moves raw 32-bit words,
+// so it serves float32 and int32 input alike. The AVX2 versions need the
+// byte offsets of a block of 8 (or 4) elements to fit in an int.
+static void gather32_scalar(const char *src, npy_intp stride, void *dst, npy_intp n){
+    npy_intp i;
+    int *out = (int *) dst;
+
+    for(i = 0; i < n; i++){
+        out[i] = *((const int *) (src + i*stride));
+    }
+}
+static void gather_d2f_scalar(const char *src, npy_intp stride, float *dst, npy_intp n){
+    npy_intp i;
+
+    for(i = 0; i < n; i++){
+        dst[i] = (float) *((const double *) (src + i*stride));
+    }
+}
+#ifdef S2PY_X86_SIMD
+__attribute__((target("avx2")))
+static void gather32_avx2(const char *src, npy_intp stride, void *dst, npy_intp n){
+    npy_intp i;
+    int *out = (int *) dst;
+    __m256i offsets;
+
+    if(stride > 0x0fffffff/8 || stride < -0x0fffffff/8){
+        gather32_scalar(src, stride, dst, n);
+        return;
+    }
+    offsets = _mm256_mullo_epi32(_mm256_set1_epi32((int) stride), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for(i = 0; i + 8 <= n; i += 8){
+        _mm256_storeu_si256((__m256i *) (out + i), _mm256_i32gather_epi32((const int *) (src + i*stride), offsets, 1));
+    }
+    for(; i < n; i++){
+        out[i] = *((const int *) (src + i*stride));
+    }
+}
+__attribute__((target("avx2")))
+static void gather_d2f_avx2(const char *src, npy_intp stride, float *dst, npy_intp n){
+    npy_intp i;
+    __m128i offsets;
+
+    if(stride > 0x0fffffff/4 || stride < -0x0fffffff/4){
+        gather_d2f_scalar(src, stride, dst, n);
+        return;
+    }
+    offsets = _mm_mullo_epi32(_mm_set1_epi32((int) stride), _mm_setr_epi32(0, 1, 2, 3));
+    for(i = 0; i + 4 <= n; i += 4){
+        _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_i32gather_pd((const double *) (src + i*stride), offsets, 1)));
+    }
+    for(; i < n; i++){
+        dst[i] = (float) *((const double *) (src + i*stride));
+    }
+}
+#endif
+static void (*gather32_kernel)(const char *, npy_intp, void *, npy_intp) = gather32_scalar;
+static void (*gather_d2f_kernel)(const char *, npy_intp, float *, npy_intp) = gather_d2f_scalar;
+
+void gather32(const char *src, npy_intp stride, void *dst, npy_intp n){
+    // copy n 32-bit elements spaced stride bytes apart into dst
+    long c, nchunks;
+
+    if(n < S2PY_OMP_THRESHOLD){
+        gather32_kernel(src, stride, dst, n);
+        return;
+    }
+    nchunks = (long) ((n + S2PY_OMP_CHUNK - 1)/S2PY_OMP_CHUNK);
+    #pragma omp parallel for schedule(static)
+    for(c = 0; c < nchunks; c++){
+        npy_intp lo = (npy_intp) c*S2PY_OMP_CHUNK;
+        npy_intp len = (n - lo < S2PY_OMP_CHUNK) ? n - lo : S2PY_OMP_CHUNK;
+        gather32_kernel(src + lo*stride, stride, (int *) dst + lo, len);
+    }
+}
+void gather_double_to_float(const char *src, npy_intp stride, float *dst, npy_intp n){
+    // as double_to_float, for doubles spaced stride bytes apart
+    long c, nchunks;
+
+    if(stride == (npy_intp) sizeof(double)){
+        double_to_float((const double *) src, dst, n);
+        return;
+    }
+    if(n < S2PY_OMP_THRESHOLD){
+        gather_d2f_kernel(src, stride, dst, n);
+        return;
+    }
+    nchunks = (long) ((n + S2PY_OMP_CHUNK - 1)/S2PY_OMP_CHUNK);
+    #pragma omp parallel for schedule(static)
+    for(c = 0; c < nchunks; c++){
+        npy_intp lo = (npy_intp) c*S2PY_OMP_CHUNK;
+        npy_intp len = (n - lo < S2PY_OMP_CHUNK) ? n - lo : S2PY_OMP_CHUNK;
+        gather_d2f_kernel(src + lo*stride, stride, dst + lo, len);
+    }
+}
+static void double_row_to_float(const char *src, npy_intp stride, float *dst, npy_intp n){
+    // convert one row of doubles, which need not be contiguous
+    if(stride == (npy_intp) sizeof(double)){
+        convert_d2f_kernel((const double *) src, dst, n);
+    } else {
+        gather_d2f_kernel(src, stride, dst, n);
+    }
+}
+static float half_to_float(unsigned short h){
+    // IEEE binary16 to float; subnormals are scaled, inf/nan keep their bits
+    unsigned int sign = (unsigned int) (h & 0x8000) << 16, e = (h >> 10) & 0x1f, mant = h & 0x3ff, bits;
+    float f;
+
+    if(e == 0){
+        f = mant*5.9604645e-8f;
+        return sign ? -f : f;
+    }
+    bits = sign | (e == 31 ? 0x7f800000u : (e + 112) << 23) | mant << 13;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+static int element_size(int type){
+    switch(type){
+        case PyArray_UBYTE:  return 1;
+        case PyArray_SHORT:
+        case PyArray_USHORT:
+        case PyArray_HALF:   return 2;
+        case PyArray_DOUBLE: return 8;
+        default:             return 4;
+    }
+}
+static float element_to_float(const char *p, int type){
+    // one native-order element of a grid type as a float
+    switch(type){
+        case PyArray_UBYTE:  return *(const unsigned char *) p;
+        case PyArray_SHORT:  return *(const short *) p;
+        case PyArray_USHORT: return *(const unsigned short *) p;
+        case PyArray_INT:    return (float) *(const int *) p;
+        case PyArray_HALF:   return half_to_float(*(const unsigned short *) p);
+        case PyArray_DOUBLE: return (float) *(const double *) p;
+        default:             return *(const float *) p;
+    }
+}
+static float swapped_to_float(const char *p, int type){
+    // the same for an element stored in the other byte order
+    char b[8];
+    int k, size = element_size(type);
+
+    for(k = 0; k < size; k++) b[k] = p[size - 1 - k];
+    return element_to_float(b, type);
+}
+static void scaled_row_to_float(const char *src, npy_intp stride, int type, int swap, float scale, float offset, float *dst, npy_intp n){
+    // convert one row of a float32/float64/uint8/int16/uint16/int32/float16
+    // array, in either byte order, to value*scale + offset
+    npy_intp i;
+
+    if(swap){
+        for(i = 0; i < n; i++) dst[i] = swapped_to_float(src + i*stride, type)*scale + offset;
+        return;
+    }
+    switch(type){
+        case PyArray_UBYTE:
+            for(i = 0; i < n; i++) dst[i] = *(const unsigned char *) (src + i*stride)*scale + offset;
+            break;
+        case PyArray_SHORT:
+            for(i = 0; i < n; i++) dst[i] = *(const short *) (src + i*stride)*scale + offset;
+            break;
+        case PyArray_USHORT:
+            for(i = 0; i < n; i++) dst[i] = *(const unsigned short *) (src + i*stride)*scale + offset;
+            break;
+        case PyArray_INT:
+            for(i = 0; i < n; i++) dst[i] = (float) (*(const int *) (src + i*stride)*(double) scale + offset);
+            break;
+        case PyArray_HALF:
+            for(i = 0; i < n; i++) dst[i] = half_to_float(*(const unsigned short *) (src + i*stride))*scale + offset;
+            break;
+        case PyArray_DOUBLE:
+            for(i = 0; i < n; i++) dst[i] = (float) (*(const double *) (src + i*stride)*scale + offset);
+            break;
+        default:
+            for(i = 0; i < n; i++) dst[i] = *(const float *) (src + i*stride)*scale + offset;
+    }
+}
+void double_to_float_init(void){
+    // pick the widest conversion kernel this cpu supports
+#ifdef S2PY_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")){
+        convert_d2f_kernel = convert_d2f_avx512;
+    } else if(__builtin_cpu_supports("avx2")){
+        convert_d2f_kernel = convert_d2f_avx2;
+    }
+    if(__builtin_cpu_supports("avx2")){
+        gather32_kernel = gather32_avx2;
+        gather_d2f_kernel = gather_d2f_avx2;
+    }
+#endif
+}
+// scratch buffers for converted 1D arrays. Per-frame calls (s2pt, s2line,
+// ... from a callback) tend to ask for the same sizes every time, so a few
+// buffers are kept and handed out again instead of going back to malloc.
+// Only touched with the GIL held.
+static struct {
+    void  *ptr;
+    size_t size;
+    int    inuse;
+} scratchPool[S2PY_POOL_SLOTS];
+
+void *scratch_acquire(size_t bytes){
+    int i, best = -1, spare = -1;
+    void *ptr;
+
+    if(bytes == 0) bytes = 1;
+    if(bytes <= S2PY_POOL_MAX_BYTES){
+        for(i = 0; i < S2PY_POOL_SLOTS; i++){
+            if(scratchPool[i].inuse) continue;
+            if(scratchPool[i].size >= bytes){
+                if(best < 0 || scratchPool[i].size < scratchPool[best].size) best = i;
+            } else if(spare < 0){
+                spare = i;
+            }
+        }
+        if(best < 0 && spare >= 0){
+            // grow a free slot to the new size
+            free(scratchPool[spare].ptr);
+            scratchPool[spare].ptr = NULL;
+            scratchPool[spare].size = 0;
+            if(posix_memalign(&scratchPool[spare].ptr, S2PY_ALIGN, bytes)){
+                scratchPool[spare].ptr = NULL;
+                return NULL;
+            }
+            scratchPool[spare].size = bytes;
+            best = spare;
+        }
+        if(best >= 0){
+            scratchPool[best].inuse = 1;
+            return scratchPool[best].ptr;
+        }
+    }
+    // too big to keep, or every slot busy
+    if(posix_memalign(&ptr, S2PY_ALIGN, bytes)) return NULL;
+    return ptr;
+}
+int scratch_release(void *ptr){
+    // hand a buffer back to the pool: returns 0 if it did not come from it
+    int i;
+
+    if(ptr == NULL) return 0;
+    for(i = 0; i < S2PY_POOL_SLOTS; i++){
+        if(scratchPool[i].ptr == ptr && scratchPool[i].inuse){
+            scratchPool[i].inuse = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
 float   *numpy1D_to_float(PyArrayObject *numpyArray){
     // convert the numpy arrays into C arrays
-    int n, i;
+    npy_intp n, stride;
     float *result;
+    char *data;
 
     if (PyArray_NDIM(numpyArray) != 1) {
         PyErr_SetString(PyExc_ValueError,
@@ -301,21 +644,29 @@ float   *numpy1D_to_float(PyArrayObject *numpyArray){
         return NULL;
     }
     n = PyArray_DIM(numpyArray, 0);
+    stride = PyArray_STRIDE(numpyArray, 0);
+    data = PyArray_DATA(numpyArray);
 
-    if (PyArray_TYPE(numpyArray) == PyArray_FLOAT){
-      result = (float *) PyArray_DATA(numpyArray);
+    if (PyArray_TYPE(numpyArray) == PyArray_FLOAT && stride == (npy_intp) sizeof(float)){
+        result = (float *) data;
 
         // add a python reference to the numpy array in case the user dels their ref to it
         Py_XINCREF(numpyArray);
         return result;
+    } else if (PyArray_TYPE(numpyArray) == PyArray_FLOAT){
+        // a view such as arr[::2] or xyz[:,0]: gather the elements
+        if(!(result = (float *) scratch_acquire((size_t) n*sizeof(float)))){
+            PyErr_NoMemory();
+            return NULL;
+        }
+        gather32(data, stride, result, n);
+        return result;
     } else if (PyArray_TYPE(numpyArray) == PyArray_DOUBLE){
-        double *_result;
-
-        _result = (double *) PyArray_DATA(numpyArray);
-        result = (float *) malloc((size_t) (n*sizeof(float)));
-        for(i = 0; i < n; i++){
-            result[i] = (float) _result[i];
+        if(!(result = (float *) scratch_acquire((size_t) n*sizeof(float)))){
+            PyErr_NoMemory();
+            return NULL;
         }
+        gather_double_to_float(data, stride, result, n);
         return result;
     } else {
         PyErr_SetString(PyExc_ValueError,
@@ -325,8 +676,9 @@ float   *numpy1D_to_float(PyArrayObject *numpyArray){
 }
 int     *numpy1D_to_int(PyArrayObject *numpyArray){
     // convert the numpy arrays into C arrays
-    int n, i;
+    npy_intp n, i, stride;
     int *result;
+    char *data;
 
     if (PyArray_NDIM(numpyArray) != 1) {
         PyErr_SetString(PyExc_ValueError,
@@ -334,30 +686,39 @@ int     *numpy1D_to_int(PyArrayObject *numpyArray){
         return NULL;
     }
     n = PyArray_DIM(numpyArray, 0);
+    stride = PyArray_STRIDE(numpyArray, 0);
+    data = PyArray_DATA(numpyArray);
 
-    if (PyArray_TYPE(numpyArray) == PyArray_INT){
-        result = (int *) PyArray_DATA(numpyArray);
+    if (PyArray_TYPE(numpyArray) == PyArray_INT && stride == (npy_intp) sizeof(int)){
+        result = (int *) data;
 
         // add a python reference to the numpy array in case the user dels their ref to it
         Py_XINCREF(numpyArray);
         return result;
+    } else if (PyArray_TYPE(numpyArray) == PyArray_INT){
+        if(!(result = (int *) scratch_acquire((size_t) n*sizeof(int)))){
+            PyErr_NoMemory();
+            return NULL;
+        }
+        gather32(data, stride, result, n);
+        return result;
     } else if (PyArray_TYPE(numpyArray) == PyArray_LONG){
-        long *_result;
-
-        _result = (long *) PyArray_DATA(numpyArray);
-        result = (int *) malloc((size_t) (n*sizeof(int)));
+        if(!(result = (int *) scratch_acquire((size_t) n*sizeof(int)))){
+            PyErr_NoMemory();
+            return NULL;
+        }
         for(i = 0; i < n; i++){
-            result[i] = (int) _result[i];
+            result[i] = (int) *((long *) (data + i*stride));
         }
         return result;
     } else {
         PyErr_SetString(PyExc_ValueError,
-            "In numpy1D_to_float: array must be of type Float or Double.");
+            "In numpy1D_to_int: array must be of type Int or Long.");
         return NULL;
     }
 }
 float  **numpy2D_to_float(PyArrayObject *numpyArray){
-    int n, m, i, j, strides[2];
+    npy_intp n, m, i, strides[2];
     float **result;
     
     if(PyArray_NDIM(numpyArray) != 2){
@@ -367,13 +728,16 @@ float  **numpy2D_to_float(PyArrayObject *numpyArray){
     }
     n = PyArray_DIM(numpyArray, 0);
     m = PyArray_DIM(numpyArray, 1);
-    strides[0] = (int) PyArray_STRIDE(numpyArray, 0);
-    strides[1] = (int) PyArray_STRIDE(numpyArray, 1);
+    strides[0] = PyArray_STRIDE(numpyArray, 0);
+    strides[1] = PyArray_STRIDE(numpyArray, 1);
 
     if (PyArray_TYPE(numpyArray) == PyArray_FLOAT){
         char *_ro;
         
-        result = (float **) malloc((size_t) (n*sizeof(float*)));
+        if(!(result = (float **) malloc((size_t) n*sizeof(float*)))){
+            PyErr_NoMemory();
+            return NULL;
+        }
         _ro = PyArray_DATA(numpyArray);
         for (i = 0; i < n; i++) {
             result[i] = (float *) (_ro + i*strides[0]);
@@ -383,15 +747,27 @@ float  **numpy2D_to_float(PyArrayObject *numpyArray){
         return result;
     } else if (PyArray_TYPE(numpyArray) == PyArray_DOUBLE)  {
         char *_ro;
-        double *ptr;
+        float *slab;
+        size_t indexBytes;
         
-        result = (float **) malloc((size_t) (n*sizeof(float*)));
+        // row pointers and converted data share one aligned block, as in
+        // numpy3D_to_float
+        indexBytes = ((size_t) n*sizeof(float*) + S2PY_ALIGN - 1) & ~((size_t) S2PY_ALIGN - 1);
+        if(posix_memalign((void **) &result, S2PY_ALIGN, indexBytes + (size_t) n*m*sizeof(float))){
+            PyErr_NoMemory();
+            return NULL;
+        }
+        slab = (float *) ((char *) result + indexBytes);
         _ro = PyArray_DATA(numpyArray);
         for (i = 0; i < n; i++) {
-            result[i] = (float *) malloc((size_t) (m*sizeof(float)));
-            for(j = 0; j < m; j++){
-                ptr = (double *) (_ro + i*strides[0] + j*strides[1]);
-                result[i][j] = (float) *ptr;
+            result[i] = slab + (size_t) i*m;
+        }
+        if(strides[1] == (npy_intp) sizeof(double) && strides[0] == m*strides[1]){
+            double_to_float((double *) _ro, slab, n*m);
+        } else {
+            #pragma omp parallel for schedule(static) if(n*m >= S2PY_OMP_THRESHOLD)
+            for (i = 0; i < n; i++) {
+                double_row_to_float(_ro + i*strides[0], strides[1], result[i], m);
             }
         }
         return result;
@@ -402,9 +778,18 @@ float  **numpy2D_to_float(PyArrayObject *numpyArray){
     }
 }
 float ***numpy3D_to_float(PyArrayObject *numpyArray){
-    // convert the numpy matrices into C arrays
-    int n,m,l, i,j,k, strides[3];
+    return numpy3D_to_float_scaled(numpyArray, 1., 0.);
+}
+float ***numpy3D_to_float_scaled(PyArrayObject *numpyArray, float scale, float offset){
+    // convert the numpy matrices into C arrays of value*scale + offset. An
+    // unscaled native float32 array with contiguous rows is used in place;
+    // anything else is copied.
+    npy_intp n,m,l, i,j, strides[3];
+    int type = PyArray_TYPE(numpyArray);
+    int swap = !PyArray_ISNOTSWAPPED(numpyArray), unscaled = scale == 1. && offset == 0. && !swap;
+    size_t indexBytes;
     float ***result;
+    float **rows;
 
     if (PyArray_NDIM(numpyArray) != 3){
         PyErr_SetString(PyExc_ValueError,
@@ -414,17 +799,25 @@ float ***numpy3D_to_float(PyArrayObject *numpyArray){
     n = PyArray_DIM(numpyArray, 0);
     m = PyArray_DIM(numpyArray, 1);
     l = PyArray_DIM(numpyArray, 2);
-    strides[0] = (int) PyArray_STRIDE(numpyArray, 0);
-    strides[1] = (int) PyArray_STRIDE(numpyArray, 1);
-    strides[2] = (int) PyArray_STRIDE(numpyArray, 2);
+    strides[0] = PyArray_STRIDE(numpyArray, 0);
+    strides[1] = PyArray_STRIDE(numpyArray, 1);
+    strides[2] = PyArray_STRIDE(numpyArray, 2);
 
-    if (PyArray_TYPE(numpyArray) == PyArray_FLOAT)  {
+    // the pointer index is a single block: n plane pointers followed by
+    // n*m row pointers, so the whole thing goes back with one free()
+    indexBytes = (size_t) n*sizeof(float**) + (size_t) n*m*sizeof(float*);
+
+    if (type == PyArray_FLOAT && unscaled && strides[2] == (npy_intp) sizeof(float))  {
         char *dataPtr;
         
-        result = (float ***) malloc((size_t) (n*sizeof(float**)));
+        if(!(result = (float ***) malloc(indexBytes))){
+            PyErr_NoMemory();
+            return NULL;
+        }
+        rows = (float **) (result + n);
         dataPtr = PyArray_DATA(numpyArray);
         for (i = 0; i < n; i++) {
-            result[i] = (float **) malloc((size_t) (m*sizeof(float*)));
+            result[i] = rows + (size_t) i*m;
             for(j = 0; j < m; j++){
                 result[i][j] = (float *) (dataPtr + i*strides[0] + j*strides[1]);
             }
@@ -432,33 +825,55 @@ float ***numpy3D_to_float(PyArrayObject *numpyArray){
         // add a python reference to the numpy array in case the user deletes it
         Py_XINCREF(numpyArray);
         return result;
-    } else if(PyArray_TYPE(numpyArray) == PyArray_DOUBLE){
+    } else if(type == PyArray_FLOAT || type == PyArray_DOUBLE || type == PyArray_UBYTE || type == PyArray_SHORT || type == PyArray_USHORT || type == PyArray_INT || type == PyArray_HALF){
         char *dataPtr;
-        double *doublePtr;
+        float *slab;
         
-        result = (float ***) malloc((size_t) (n*sizeof(float**)));
+        // the converted data follows the index in the same allocation,
+        // starting on an aligned boundary, and is filled in one pass
+        indexBytes = (indexBytes + S2PY_ALIGN - 1) & ~((size_t) S2PY_ALIGN - 1);
+        if(posix_memalign((void **) &result, S2PY_ALIGN, indexBytes + (size_t) n*m*l*sizeof(float))){
+            PyErr_NoMemory();
+            return NULL;
+        }
+        rows = (float **) (result + n);
+        slab = (float *) ((char *) result + indexBytes);
         dataPtr = PyArray_DATA(numpyArray);
         for (i = 0; i < n; i++) {
-            result[i] = (float **) malloc((size_t) (m*sizeof(float*)));
+            result[i] = rows + (size_t) i*m;
             for(j = 0; j < m; j++){
-                result[i][j] = (float *) malloc((size_t) (l*sizeof(float)));
-                for(k = 0; k < l; k++){
-                    doublePtr = (double *) (dataPtr +i*strides[0] + j*strides[1] + k*strides[2]);
-                    result[i][j][k] = (float) *doublePtr;
+                result[i][j] = slab + ((size_t) i*m + j)*l;
+            }
+        }
+        if(type == PyArray_DOUBLE && unscaled && strides[2] == (npy_intp) sizeof(double) && strides[1] == l*strides[2] && strides[0] == m*strides[1]){
+            double_to_float((double *) dataPtr, slab, n*m*l);
+        } else if(type == PyArray_DOUBLE && unscaled){
+            #pragma omp parallel for private(j) schedule(static) if(n*m*l >= S2PY_OMP_THRESHOLD)
+            for (i = 0; i < n; i++) {
+                for(j = 0; j < m; j++){
+                    double_row_to_float(dataPtr + i*strides[0] + j*strides[1], strides[2], result[i][j], l);
+                }
+            }
+        } else {
+            #pragma omp parallel for private(j) schedule(static) if(n*m*l >= S2PY_OMP_THRESHOLD)
+            for (i = 0; i < n; i++) {
+                for(j = 0; j < m; j++){
+                    scaled_row_to_float(dataPtr + i*strides[0] + j*strides[1], strides[2], type, swap, scale, offset, result[i][j], l);
                 }
             }
         }
         return result;
     } else {
         PyErr_SetString(PyExc_ValueError,
-            "In numpy3D_to_float: array must be of type Float or Double.");
+            "In numpy3D_to_float: array must be of type Float, Double, UInt8, Int16, UInt16, Int32 or Float16.");
         return NULL;
     }
 }
 void numpy_free(PyArrayObject *numpyArray, void *data){
     // just checks before freeing whether the memory is in use by a particular numpy object
-    // if so, do nothing
-  if(PyArray_DATA(numpyArray) != data){
+    // if so, do nothing. Pooled scratch buffers go back to the pool.
+    if(data == NULL) return;
+    if(PyArray_DATA(numpyArray) != data && !scratch_release(data)){
         free(data);
     }
 }
@@ -480,6 +895,114 @@ COLOUR Dict_to_COLOUR(PyObject *dict){
 
     return out;
 }
+static float *array_to_float3(PyArrayObject *arr, const char *what){
+    // view or convert a float32/float64 array whose last dimension is 3 as
+    // packed (x,y,z) or (r,g,b) triples. A native, aligned, C-contiguous
+    // float32 array is used in place; anything else is converted into a
+    // scratch buffer.
+    PyArrayObject *tmp;
+    float *out;
+    npy_intp len;
+
+    if(PyArray_TYPE(arr) != PyArray_FLOAT && PyArray_TYPE(arr) != PyArray_DOUBLE){
+        PyErr_Format(PyExc_ValueError, "%s must be an array of type Float or Double", what);
+        return NULL;
+    }
+    if(PyArray_TYPE(arr) == PyArray_FLOAT && PyArray_ISCONTIGUOUS(arr) && PyArray_ISNOTSWAPPED(arr) && PyArray_ISALIGNED(arr)){
+        return (float *) PyArray_DATA(arr);
+    }
+    len = PyArray_SIZE(arr);
+    if(!(out = (float *) scratch_acquire((size_t) len*sizeof(float)))){
+        PyErr_NoMemory();
+        return NULL;
+    }
+    if(PyArray_TYPE(arr) == PyArray_DOUBLE && PyArray_ISCONTIGUOUS(arr) && PyArray_ISNOTSWAPPED(arr) && PyArray_ISALIGNED(arr)){
+        double_to_float((double *) PyArray_DATA(arr), out, len);
+    } else {
+        // strided, byte-swapped or unaligned arrays are rare here: let numpy
+        // make them native and contiguous first
+        if(!(tmp = (PyArrayObject *) PyArray_ContiguousFromObject((PyObject *) arr, PyArray_FLOAT, 0, 0))){
+            if(!scratch_release(out)) free(out);
+            return NULL;
+        }
+        memcpy(out, PyArray_DATA(tmp), (size_t) len*sizeof(float));
+        Py_DECREF(tmp);
+    }
+    return out;
+}
+static float *sequence_to_float3(PyObject *in, int *n, const char *keys, const char *what){
+    // fill *n (x,y,z) or (r,g,b) triples from either a list of dicts keyed by
+    // the characters in keys, or an (n,3) numpy array (see array_to_float3).
+    // If *n < 0 any length is accepted and *n is set to it.
+    PyArrayObject *arr;
+    PyObject *seq, *item, *val;
+    float *out;
+    char key[2] = {0, 0};
+    npy_intp len, i;
+    int k;
+
+    if(PyArray_Check(in)){
+        arr = (PyArrayObject *) in;
+        if(PyArray_NDIM(arr) != 2 || PyArray_DIM(arr, 1) != 3){
+            PyErr_Format(PyExc_ValueError, "%s must be an array of shape (n,3)", what);
+            return NULL;
+        }
+        if(*n >= 0 && PyArray_DIM(arr, 0) != *n){
+            PyErr_Format(PyExc_ValueError, "%s must be an array of shape (%d,3)", what, *n);
+            return NULL;
+        }
+        if(!(out = array_to_float3(arr, what))){
+            return NULL;
+        }
+        *n = (int) PyArray_DIM(arr, 0);
+        return out;
+    }
+
+    if(!(seq = PySequence_Fast(in, "expected a list of dictionaries or an (n,3) array"))){
+        return NULL;
+    }
+    len = PySequence_Fast_GET_SIZE(seq);
+    if(*n >= 0 && len != *n){
+        PyErr_Format(PyExc_IndexError, "%s must be a list of %d dictionaries", what, *n);
+        Py_DECREF(seq);
+        return NULL;
+    }
+    if(!(out = (float *) scratch_acquire((size_t) (3*len)*sizeof(float)))){
+        Py_DECREF(seq);
+        PyErr_NoMemory();
+        return NULL;
+    }
+    for(i = 0; i < len; i++){
+        item = PySequence_Fast_GET_ITEM(seq, i);
+        for(k = 0; k < 3; k++){
+            key[0] = keys[k];
+            if(!PyDict_Check(item) || !(val = PyDict_GetItemString(item, key))){
+                PyErr_Format(PyExc_ValueError, "%s must be dictionaries of {%s}", what, keys);
+                if(!scratch_release(out)) free(out);
+                Py_DECREF(seq);
+                return NULL;
+            }
+            out[3*i + k] = (float) PyFloat_AsDouble(val);
+        }
+    }
+    Py_DECREF(seq);
+    *n = (int) len;
+    return out;
+}
+XYZ *List_to_XYZ(PyObject *in, int *n, const char *what){
+    return (XYZ *) sequence_to_float3(in, n, "xyz", what);
+}
+COLOUR *List_to_COLOUR(PyObject *in, int *n, const char *what){
+    return (COLOUR *) sequence_to_float3(in, n, "rgb", what);
+}
+void List_free(PyObject *in, void *data){
+    // release a buffer from List_to_XYZ/List_to_COLOUR, unless it is the array's own data
+    if(data == NULL) return;
+    if(PyArray_Check(in) && PyArray_DATA((PyArrayObject *) in) == data) return;
+    if(!scratch_release(data)){
+        free(data);
+    }
+}
 PyObject *XYZ_to_Dict(XYZ xyz){
     PyObject *out;
     
@@ -504,12 +1027,91 @@ PyObject *COLOUR_to_Dict(COLOUR colour){
     
     return out;
 }
+static int native_callback(PyObject *obj, void **fn){
+    // recognise a native C function given in place of a python callable: a
+    // ctypes CFUNCTYPE instance, an object with an integer .address (numba
+    // cfunc) or an address wrapped in ctypes.c_void_p. Plain numbers are not
+    // addresses. Returns 1 and sets *fn, 0 if obj is not a native function,
+    // or -1 with the python error set.
+    static PyObject *ctypesFuncPtr = NULL, *ctypesCast, *ctypesVoidP;
+    PyObject *ctypes, *ptr, *addr = NULL;
+    int isptr;
+
+    if(PyInt_Check(obj) || PyLong_Check(obj) || PyFloat_Check(obj)){
+        return 0;
+    } else if(PyObject_HasAttrString(obj, "address")){
+        if(!(addr = PyObject_GetAttrString(obj, "address"))) return -1;
+    } else {
+        if(ctypesFuncPtr == NULL){
+            if(!(ctypes = PyImport_ImportModule("ctypes"))){
+                // no ctypes: nothing else can be a native function
+                PyErr_Clear();
+                return 0;
+            }
+            ctypesFuncPtr = PyObject_GetAttrString(ctypes, "_CFuncPtr");
+            ctypesCast = PyObject_GetAttrString(ctypes, "cast");
+            ctypesVoidP = PyObject_GetAttrString(ctypes, "c_void_p");
+            Py_DECREF(ctypes);
+            if(!ctypesFuncPtr || !ctypesCast || !ctypesVoidP){
+                Py_CLEAR(ctypesFuncPtr);
+                return -1;
+            }
+        }
+        if((isptr = PyObject_IsInstance(obj, ctypesVoidP)) < 0) return -1;
+        if(isptr){
+            Py_INCREF(obj);
+            ptr = obj;
+        } else {
+            if((isptr = PyObject_IsInstance(obj, ctypesFuncPtr)) <= 0) return isptr;
+            // ctypes.cast(obj, c_void_p)
+            if(!(ptr = PyObject_CallFunctionObjArgs(ctypesCast, obj, ctypesVoidP, NULL))) return -1;
+        }
+        addr = PyObject_GetAttrString(ptr, "value");
+        Py_DECREF(ptr);
+        if(addr == NULL) return -1;
+    }
+
+    if(PyBool_Check(addr) || (!PyInt_Check(addr) && !PyLong_Check(addr) && addr != Py_None)){
+        Py_DECREF(addr);
+        return 0;
+    }
+    // c_void_p(None).value is None
+    *fn = addr == Py_None ? NULL : PyLong_AsVoidPtr(addr);
+    Py_DECREF(addr);
+    if(PyErr_Occurred()) return -1;
+    if(*fn == NULL){
+        PyErr_SetString(PyExc_ValueError, "native function pointer is NULL");
+        return -1;
+    }
+    return 1;
+}
+static int native_callbacks(PyObject **objs, void **fns, int n){
+    // sort each of objs into a native function (fns[i] set) or a python
+    // callable (fns[i] = NULL). Returns 0 with an error set for anything else.
+    int i, native;
+
+    for(i = 0; i < n; i++){
+        fns[i] = NULL;
+        if((native = native_callback(objs[i], &fns[i])) < 0) return 0;
+        if(!native && !PyCallable_Check(objs[i])){
+            PyErr_SetString(PyExc_TypeError, "parameters must be callable or native function pointers");
+            return 0;
+        }
+    }
+    return 1;
+}
 
 // init the module definition...
 PyMODINIT_FUNC init_s2plot(void){
-    (void) Py_InitModule3("_s2plot", S2PlotMethods,"A literal implementation of the s2plot library.");
+    (void) Py_InitModule3("_s2plot", S2PlotMethods,"A literal implementation of the s2plot library.\n\nWherever a list of {xyz} or {rgb} dicts is taken, an (n,3) float32 or float64 numpy array may be given instead; native-order, aligned, C-contiguous float32 arrays are used without copying.");
     // the following line necessary for numpy
     import_array();
+    // callbacks re-acquire the GIL, as s2disp and s2show run without it.
+    // Every other call into s2plot keeps the GIL, which is all that stops
+    // two threads using the library's global state at once.
+    PyEval_InitThreads();
+    // choose the conversion kernels for this cpu
+    double_to_float_init();
 }
 
 // OPENING, CLOSING AND SELECTING DEVICES
@@ -589,7 +1191,9 @@ static PyObject *s2plot_s2show(PyObject *self, PyObject *args){
         return NULL;
     }
     
+    Py_BEGIN_ALLOW_THREADS
     s2show(interactive);
+    Py_END_ALLOW_THREADS
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -601,7 +1205,9 @@ static PyObject *s2plot_s2disp(PyObject *self, PyObject *args){
         return NULL;
     }
     
+    Py_BEGIN_ALLOW_THREADS
     s2disp(idelay,irestorecamera);
+    Py_END_ALLOW_THREADS
     
     Py_INCREF(Py_None);
     
@@ -910,6 +1516,7 @@ static PyObject *s2plot_s2pnts(PyObject *self, PyObject *args){
     numpy_free(xIn, xPts);
     numpy_free(yIn, yPts);
     numpy_free(zIn, zPts);
+    numpy_free(symbolsIn, symbols);
 
     Py_INCREF(Py_None);
     return Py_None;
@@ -1371,7 +1978,149 @@ static PyObject *pyParametric_fz = NULL;
 static PyObject *pyParametric_fc = NULL;
 static PyObject *pyParametric_fa = NULL;
 
+// opt-in vectorised sampling for s2funt/s2funtc: each callable is called once
+// with a numpy array of every t value, and s2plot is then fed the samples
+static struct {
+    float tmin, dt;
+    int n;
+    float *f[4];    // samples of fx, fy, fz, fc
+} parametricCache = {0., 0., 0, {NULL, NULL, NULL, NULL}};
+
+static float *vector_call(PyObject *func, PyObject *arg, npy_intp n){
+    // call func with the argument tuple and return its result as n floats
+    // (malloc'd), or NULL with the python error set
+    PyObject *pyResult;
+    PyArrayObject *arr;
+    float *out = NULL;
+
+    if(!(pyResult = PyEval_CallObject(func, arg))) return NULL;
+    arr = (PyArrayObject *) PyArray_ContiguousFromObject(pyResult, PyArray_FLOAT, 0, 0);
+    Py_DECREF(pyResult);
+    if(arr == NULL) return NULL;
+
+    if(PyArray_SIZE(arr) != n){
+        PyErr_Format(PyExc_ValueError, "vectorised function returned %ld values, expected %ld",
+            (long) PyArray_SIZE(arr), (long) n);
+    } else if(!(out = (float *) malloc((size_t) n*sizeof(float)))){
+        PyErr_NoMemory();
+    } else {
+        memcpy(out, PyArray_DATA(arr), (size_t) n*sizeof(float));
+    }
+    Py_DECREF(arr);
+    return out;
+}
+static void parametric_clear(void){
+    int k;
+
+    for(k = 0; k < 4; k++){
+        free(parametricCache.f[k]);
+        parametricCache.f[k] = NULL;
+    }
+    parametricCache.n = 0;
+}
+static int parametric_fill(PyObject **funcs, int nfuncs, int N, float tmin, float tmax){
+    // sample every function at the N values of t s2funt uses
+    PyObject *arg;
+    PyArrayObject *tArr;
+    npy_intp n = N;
+    float *t;
+    int i, k;
+
+    parametric_clear();
+    if(N < 1){
+        return 1;
+    }
+    if(!(tArr = (PyArrayObject *) PyArray_SimpleNew(1, &n, PyArray_FLOAT))){
+        return 0;
+    }
+    parametricCache.tmin = tmin;
+    parametricCache.dt = (N > 1) ? (tmax - tmin) / (float) (N - 1) : 0.;
+    parametricCache.n = N;
+    t = (float *) PyArray_DATA(tArr);
+    for(i = 0; i < N; i++){
+        t[i] = tmin + (float) i * parametricCache.dt;
+    }
+
+    arg = Py_BuildValue("(O)", tArr);
+    Py_DECREF(tArr);
+    for(k = 0; k < nfuncs; k++){
+        // NULL marks a native function, which is called directly
+        if(funcs[k] == NULL) continue;
+        if(!(parametricCache.f[k] = vector_call(funcs[k], arg, n))){
+            Py_DECREF(arg);
+            parametric_clear();
+            return 0;
+        }
+    }
+    Py_DECREF(arg);
+    return 1;
+}
+static int cache_index(float t, float t0, float dt, int n){
+    // index of the cached sample at t, or -1 if t is not one of them
+    float s;
+    int i;
+
+    if(dt != 0.){
+        s = (t - t0) / dt;
+    } else {
+        s = (t == t0) ? 0. : -1.;
+    }
+    i = (int) floorf(s + 0.5f);
+    if(i >= 0 && i < n && fabsf(s - (float) i) < 1.e-3){
+        return i;
+    }
+    return -1;
+}
+static float parametric_lookup(int k, PyObject *func, float t){
+    // serve a precomputed sample; anything else is evaluated on its own
+    PyGILState_STATE gstate;
+    PyObject *arg;
+    PyArrayObject *tArr;
+    npy_intp one = 1;
+    float result, *value;
+    int i;
+
+    if(parametricCache.f[k] != NULL &&
+            (i = cache_index(t, parametricCache.tmin, parametricCache.dt, parametricCache.n)) >= 0){
+        return parametricCache.f[k][i];
+    }
+
+    // only the fallback needs python
+    gstate = PyGILState_Ensure();
+    if(!(tArr = (PyArrayObject *) PyArray_SimpleNew(1, &one, PyArray_FLOAT))){
+        PyGILState_Release(gstate);
+        return 0;
+    }
+    *((float *) PyArray_DATA(tArr)) = t;
+    arg = Py_BuildValue("(O)", tArr);
+    Py_DECREF(tArr);
+    value = vector_call(func, arg, 1);
+    Py_DECREF(arg);
+    PyGILState_Release(gstate);
+
+    // errors?
+    if(value == NULL){
+        return 0;
+    }
+    result = value[0];
+    free(value);
+
+    return result;
+}
+float cParametricVector_fx(float *t){
+    return parametric_lookup(0, pyParametric_fx, *t);
+}
+float cParametricVector_fy(float *t){
+    return parametric_lookup(1, pyParametric_fy, *t);
+}
+float cParametricVector_fz(float *t){
+    return parametric_lookup(2, pyParametric_fz, *t);
+}
+float cParametricVector_fc(float *t){
+    return parametric_lookup(3, pyParametric_fc, *t);
+}
 float cParametricFunctions_fx(float *t){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1381,14 +2130,17 @@ float cParametricFunctions_fx(float *t){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 float cParametricFunctions_fy(float *t){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1399,14 +2151,17 @@ float cParametricFunctions_fy(float *t){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
         
+    PyGILState_Release(gstate);
     return result;
 }
 float cParametricFunctions_fz(float *t){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1417,14 +2172,17 @@ float cParametricFunctions_fz(float *t){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 float cParametricFunctions_fc(float *t){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1435,24 +2193,31 @@ float cParametricFunctions_fc(float *t){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 static PyObject *s2plot_s2funt(PyObject *self, PyObject *args){
-    int N;
+    int N, vectorised = 0;
     float tmin, tmax;
     PyObject *tempX, *tempY, *tempZ;
+    S2PY_TFUNC fx, fy, fz;
+    void *fn[3];
     
-    if(!PyArg_ParseTuple(args, "OOOiff:s2funt", &tempX, &tempY, &tempZ, &N, &tmin, &tmax)) {
+    if(!PyArg_ParseTuple(args, "OOOiff|i:s2funt", &tempX, &tempY, &tempZ, &N, &tmin, &tmax, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempX) || !PyCallable_Check(tempY) || !PyCallable_Check(tempZ)) {
-        PyErr_SetString(PyExc_TypeError, "parameters must be callable");
-        return NULL;
+    {
+        PyObject *temps[3] = {tempX, tempY, tempZ};
+
+        if(!native_callbacks(temps, fn, 3)){
+            return NULL;
+        }
     }
     
     // store a reference to the new callback
@@ -1467,22 +2232,41 @@ static PyObject *s2plot_s2funt(PyObject *self, PyObject *args){
     pyParametric_fy = tempY;
     pyParametric_fz = tempZ;
 
-    s2funt(cParametricFunctions_fx, cParametricFunctions_fy, cParametricFunctions_fz, N, tmin, tmax);        
+    // native functions go straight to s2plot
+    fx = fn[0] ? (S2PY_TFUNC) fn[0] : (vectorised ? cParametricVector_fx : cParametricFunctions_fx);
+    fy = fn[1] ? (S2PY_TFUNC) fn[1] : (vectorised ? cParametricVector_fy : cParametricFunctions_fy);
+    fz = fn[2] ? (S2PY_TFUNC) fn[2] : (vectorised ? cParametricVector_fz : cParametricFunctions_fz);
+
+    if(vectorised){
+        PyObject *funcs[3] = {fn[0] ? NULL : pyParametric_fx, fn[1] ? NULL : pyParametric_fy,
+                              fn[2] ? NULL : pyParametric_fz};
+
+        if(!parametric_fill(funcs, 3, N, tmin, tmax)){
+            return NULL;
+        }
+    }
+    s2funt(fx, fy, fz, N, tmin, tmax);
+    parametric_clear();
 
     Py_INCREF(Py_None);
     return Py_None; 
 }
 static PyObject *s2plot_s2funtc(PyObject *self, PyObject *args){
-    int N;
+    int N, vectorised = 0;
     float tmin, tmax;
     PyObject *tempX, *tempY, *tempZ, *tempC;
+    S2PY_TFUNC fx, fy, fz, fc;
+    void *fn[4];
     
-    if(!PyArg_ParseTuple(args, "OOOOiff:s2funtc", &tempX, &tempY, &tempZ, &tempC, &N, &tmin, &tmax)) {
+    if(!PyArg_ParseTuple(args, "OOOOiff|i:s2funtc", &tempX, &tempY, &tempZ, &tempC, &N, &tmin, &tmax, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempX) || !PyCallable_Check(tempY) || !PyCallable_Check(tempZ) || !PyCallable_Check(tempC)) {
-        PyErr_SetString(PyExc_TypeError, "parameters must be callable");
-        return NULL;
+    {
+        PyObject *temps[4] = {tempX, tempY, tempZ, tempC};
+
+        if(!native_callbacks(temps, fn, 4)){
+            return NULL;
+        }
     }
     
     // store a reference to the new callback
@@ -1500,13 +2284,158 @@ static PyObject *s2plot_s2funtc(PyObject *self, PyObject *args){
     pyParametric_fz = tempZ;
     pyParametric_fc = tempC;
 
-    s2funtc(cParametricFunctions_fx, cParametricFunctions_fy, cParametricFunctions_fz, cParametricFunctions_fc, N, tmin, tmax);
+    // native functions go straight to s2plot
+    fx = fn[0] ? (S2PY_TFUNC) fn[0] : (vectorised ? cParametricVector_fx : cParametricFunctions_fx);
+    fy = fn[1] ? (S2PY_TFUNC) fn[1] : (vectorised ? cParametricVector_fy : cParametricFunctions_fy);
+    fz = fn[2] ? (S2PY_TFUNC) fn[2] : (vectorised ? cParametricVector_fz : cParametricFunctions_fz);
+    fc = fn[3] ? (S2PY_TFUNC) fn[3] : (vectorised ? cParametricVector_fc : cParametricFunctions_fc);
+
+    if(vectorised){
+        PyObject *funcs[4] = {fn[0] ? NULL : pyParametric_fx, fn[1] ? NULL : pyParametric_fy,
+                              fn[2] ? NULL : pyParametric_fz, fn[3] ? NULL : pyParametric_fc};
+
+        if(!parametric_fill(funcs, 4, N, tmin, tmax)){
+            return NULL;
+        }
+    }
+    s2funtc(fx, fy, fz, fc, N, tmin, tmax);
+    parametric_clear();
 
     Py_INCREF(Py_None);
     return Py_None;
 }
 static PyObject *pyParametricSurface = NULL;
+// opt-in vectorised sampling for the surface functions: each callable is
+// called once with the full (nu,nv) meshgrid of u and v values
+static struct {
+    float u0, du, v0, dv;
+    int nu, nv;
+    float *f[5];    // samples of fxy (or fx), fy, fz, fc, fa
+} surfaceCache = {0., 0., 0., 0., 0, 0, {NULL, NULL, NULL, NULL, NULL}};
+
+static void surface_clear(void){
+    int k;
+
+    for(k = 0; k < 5; k++){
+        free(surfaceCache.f[k]);
+        surfaceCache.f[k] = NULL;
+    }
+    surfaceCache.nu = surfaceCache.nv = 0;
+}
+static int surface_fill(PyObject **funcs, int nfuncs, int nu, float umin, float umax, int nv, float vmin, float vmax){
+    // sample every function on the nu x nv grid of nodes spanning
+    // [umin,umax] x [vmin,vmax], u varying along the first axis
+    PyObject *arg;
+    PyArrayObject *uArr, *vArr;
+    npy_intp dims[2];
+    float *u, *v;
+    int i, j, k;
+
+    surface_clear();
+    if(nu < 1 || nv < 1){
+        return 1;
+    }
+    dims[0] = nu;
+    dims[1] = nv;
+    uArr = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_FLOAT);
+    vArr = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_FLOAT);
+    if(!uArr || !vArr){
+        Py_XDECREF(uArr);
+        Py_XDECREF(vArr);
+        return 0;
+    }
+    surfaceCache.u0 = umin;
+    surfaceCache.du = (nu > 1) ? (umax - umin) / (float) (nu - 1) : 0.;
+    surfaceCache.nu = nu;
+    surfaceCache.v0 = vmin;
+    surfaceCache.dv = (nv > 1) ? (vmax - vmin) / (float) (nv - 1) : 0.;
+    surfaceCache.nv = nv;
+    u = (float *) PyArray_DATA(uArr);
+    v = (float *) PyArray_DATA(vArr);
+    for(i = 0; i < nu; i++){
+        for(j = 0; j < nv; j++){
+            u[i*nv + j] = umin + (float) i * surfaceCache.du;
+            v[i*nv + j] = vmin + (float) j * surfaceCache.dv;
+        }
+    }
+
+    arg = Py_BuildValue("(OO)", uArr, vArr);
+    Py_DECREF(uArr);
+    Py_DECREF(vArr);
+    for(k = 0; k < nfuncs; k++){
+        if(funcs[k] == NULL) continue;
+        if(!(surfaceCache.f[k] = vector_call(funcs[k], arg, (npy_intp) nu*nv))){
+            Py_DECREF(arg);
+            surface_clear();
+            return 0;
+        }
+    }
+    Py_DECREF(arg);
+    return 1;
+}
+static float surface_lookup(int k, PyObject *func, float u, float v){
+    // serve a precomputed node; anything else is evaluated on its own
+    PyGILState_STATE gstate;
+    PyObject *arg;
+    PyArrayObject *uArr, *vArr;
+    npy_intp one = 1;
+    float result, *value;
+    int i, j;
+
+    if(surfaceCache.f[k] != NULL &&
+            (i = cache_index(u, surfaceCache.u0, surfaceCache.du, surfaceCache.nu)) >= 0 &&
+            (j = cache_index(v, surfaceCache.v0, surfaceCache.dv, surfaceCache.nv)) >= 0){
+        return surfaceCache.f[k][i*surfaceCache.nv + j];
+    }
+
+    // only the fallback needs python
+    gstate = PyGILState_Ensure();
+    uArr = (PyArrayObject *) PyArray_SimpleNew(1, &one, PyArray_FLOAT);
+    vArr = (PyArrayObject *) PyArray_SimpleNew(1, &one, PyArray_FLOAT);
+    if(!uArr || !vArr){
+        Py_XDECREF(uArr);
+        Py_XDECREF(vArr);
+        PyGILState_Release(gstate);
+        return 0;
+    }
+    *((float *) PyArray_DATA(uArr)) = u;
+    *((float *) PyArray_DATA(vArr)) = v;
+    arg = Py_BuildValue("(OO)", uArr, vArr);
+    Py_DECREF(uArr);
+    Py_DECREF(vArr);
+    value = vector_call(func, arg, 1);
+    Py_DECREF(arg);
+    PyGILState_Release(gstate);
+
+    // errors?
+    if(value == NULL){
+        return 0;
+    }
+    result = value[0];
+    free(value);
+
+    return result;
+}
+float cSurfaceVector(float *u, float *v){
+    return surface_lookup(0, pyParametricSurface, *u, *v);
+}
+float cSurfaceVector_fx(float *u, float *v){
+    return surface_lookup(0, pyParametric_fx, *u, *v);
+}
+float cSurfaceVector_fy(float *u, float *v){
+    return surface_lookup(1, pyParametric_fy, *u, *v);
+}
+float cSurfaceVector_fz(float *u, float *v){
+    return surface_lookup(2, pyParametric_fz, *u, *v);
+}
+float cSurfaceVector_fc(float *u, float *v){
+    return surface_lookup(3, pyParametric_fc, *u, *v);
+}
+float cSurfaceVector_fa(float *u, float *v){
+    return surface_lookup(4, pyParametric_fa, *u, *v);
+}
 float cParametricSurface(float *u, float *v){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1516,23 +2445,25 @@ float cParametricSurface(float *u, float *v){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 static PyObject *s2plot_s2funxy(PyObject *self, PyObject *args){
-    int nx, ny, ctl;
+    int nx, ny, ctl, vectorised = 0;
     float xmin, xmax, ymin, ymax;
     PyObject *tempXY;
+    void *fn;
     
-    if(!PyArg_ParseTuple(args, "Oiiffffi:s2funxy", &tempXY, &nx, &ny, &xmin, &xmax, &ymin, &ymax, &ctl)) {
+    if(!PyArg_ParseTuple(args, "Oiiffffi|i:s2funxy", &tempXY, &nx, &ny, &xmin, &xmax, &ymin, &ymax, &ctl, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempXY)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempXY, &fn, 1)){
         return NULL;
     }
     
@@ -1542,21 +2473,32 @@ static PyObject *s2plot_s2funxy(PyObject *self, PyObject *args){
     
     pyParametricSurface = tempXY;
 
-    s2funxy(cParametricSurface, nx, ny, xmin, xmax, ymin, ymax, ctl);
+    if(fn != NULL){
+        // a native function needs no python in the loop
+        s2funxy((S2PY_UVFUNC) fn, nx, ny, xmin, xmax, ymin, ymax, ctl);
+    } else if(vectorised){
+        if(!surface_fill(&pyParametricSurface, 1, nx, xmin, xmax, ny, ymin, ymax)){
+            return NULL;
+        }
+        s2funxy(cSurfaceVector, nx, ny, xmin, xmax, ymin, ymax, ctl);
+        surface_clear();
+    } else {
+        s2funxy(cParametricSurface, nx, ny, xmin, xmax, ymin, ymax, ctl);
+    }
 
     Py_INCREF(Py_None);
     return Py_None; 
 }
 static PyObject *s2plot_s2funxz(PyObject *self, PyObject *args){
-    int nx, nz, ctl;
+    int nx, nz, ctl, vectorised = 0;
     float xmin, xmax, zmin, zmax;
     PyObject *tempXZ;
+    void *fn;
     
-    if(!PyArg_ParseTuple(args, "Oiiffffi:s2funxz", &tempXZ, &nx, &nz, &xmin, &xmax, &zmin, &zmax, &ctl)) {
+    if(!PyArg_ParseTuple(args, "Oiiffffi|i:s2funxz", &tempXZ, &nx, &nz, &xmin, &xmax, &zmin, &zmax, &ctl, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempXZ)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempXZ, &fn, 1)){
         return NULL;
     }
     
@@ -1566,21 +2508,32 @@ static PyObject *s2plot_s2funxz(PyObject *self, PyObject *args){
     
     pyParametricSurface = tempXZ;
 
-    s2funxz(cParametricSurface, nx, nz, xmin, xmax, zmin, zmax, ctl);
+    if(fn != NULL){
+        // a native function needs no python in the loop
+        s2funxz((S2PY_UVFUNC) fn, nx, nz, xmin, xmax, zmin, zmax, ctl);
+    } else if(vectorised){
+        if(!surface_fill(&pyParametricSurface, 1, nx, xmin, xmax, nz, zmin, zmax)){
+            return NULL;
+        }
+        s2funxz(cSurfaceVector, nx, nz, xmin, xmax, zmin, zmax, ctl);
+        surface_clear();
+    } else {
+        s2funxz(cParametricSurface, nx, nz, xmin, xmax, zmin, zmax, ctl);
+    }
 
     Py_INCREF(Py_None);
     return Py_None; 
 }
 static PyObject *s2plot_s2funyz(PyObject *self, PyObject *args){
-    int ny, nz, ctl;
+    int ny, nz, ctl, vectorised = 0;
     float ymin, ymax, zmin, zmax;
     PyObject *tempYZ;
+    void *fn;
     
-    if(!PyArg_ParseTuple(args, "Oiiffffi:s2funyz", &tempYZ, &ny, &nz, &ymin, &ymax, &zmin, &zmax, &ctl)) {
+    if(!PyArg_ParseTuple(args, "Oiiffffi|i:s2funyz", &tempYZ, &ny, &nz, &ymin, &ymax, &zmin, &zmax, &ctl, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempYZ)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempYZ, &fn, 1)){
         return NULL;
     }
     
@@ -1590,22 +2543,33 @@ static PyObject *s2plot_s2funyz(PyObject *self, PyObject *args){
     
     pyParametricSurface = tempYZ;
 
-    s2funyz(cParametricSurface, ny, nz, ymin, ymax, zmin, zmax, ctl);
+    if(fn != NULL){
+        // a native function needs no python in the loop
+        s2funyz((S2PY_UVFUNC) fn, ny, nz, ymin, ymax, zmin, zmax, ctl);
+    } else if(vectorised){
+        if(!surface_fill(&pyParametricSurface, 1, ny, ymin, ymax, nz, zmin, zmax)){
+            return NULL;
+        }
+        s2funyz(cSurfaceVector, ny, nz, ymin, ymax, zmin, zmax, ctl);
+        surface_clear();
+    } else {
+        s2funyz(cParametricSurface, ny, nz, ymin, ymax, zmin, zmax, ctl);
+    }
 
     Py_INCREF(Py_None);
     return Py_None; 
     
 }
 static PyObject *s2plot_s2funxyr(PyObject *self, PyObject *args){
-    int nx, ny, ctl;
+    int nx, ny, ctl, vectorised = 0;
     float xmin, xmax, ymin, ymax, rmin, rmax;
     PyObject *tempXY;
+    void *fn;
     
-    if(!PyArg_ParseTuple(args, "Oiiffffiff:s2funxyr", &tempXY, &nx, &ny, &xmin, &xmax, &ymin, &ymax, &ctl, &rmin, &rmax)) {
+    if(!PyArg_ParseTuple(args, "Oiiffffiff|i:s2funxyr", &tempXY, &nx, &ny, &xmin, &xmax, &ymin, &ymax, &ctl, &rmin, &rmax, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempXY)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempXY, &fn, 1)){
         return NULL;
     }
     
@@ -1615,21 +2579,32 @@ static PyObject *s2plot_s2funxyr(PyObject *self, PyObject *args){
     
     pyParametricSurface = tempXY;
 
-    s2funxyr(cParametricSurface, nx, ny, xmin, xmax, ymin, ymax, ctl, rmin, rmax);
+    if(fn != NULL){
+        // a native function needs no python in the loop
+        s2funxyr((S2PY_UVFUNC) fn, nx, ny, xmin, xmax, ymin, ymax, ctl, rmin, rmax);
+    } else if(vectorised){
+        if(!surface_fill(&pyParametricSurface, 1, nx, xmin, xmax, ny, ymin, ymax)){
+            return NULL;
+        }
+        s2funxyr(cSurfaceVector, nx, ny, xmin, xmax, ymin, ymax, ctl, rmin, rmax);
+        surface_clear();
+    } else {
+        s2funxyr(cParametricSurface, nx, ny, xmin, xmax, ymin, ymax, ctl, rmin, rmax);
+    }
 
     Py_INCREF(Py_None);
     return Py_None; 
 }
 static PyObject *s2plot_s2funxzr(PyObject *self, PyObject *args){
-    int nx, nz, ctl;
+    int nx, nz, ctl, vectorised = 0;
     float xmin, xmax, zmin, zmax, rmin, rmax;
     PyObject *tempXZ;
+    void *fn;
     
-    if(!PyArg_ParseTuple(args, "Oiiffffiff:s2funxzr", &tempXZ, &nx, &nz, &xmin, &xmax, &zmin, &zmax, &ctl, &rmin, &rmax)) {
+    if(!PyArg_ParseTuple(args, "Oiiffffiff|i:s2funxzr", &tempXZ, &nx, &nz, &xmin, &xmax, &zmin, &zmax, &ctl, &rmin, &rmax, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempXZ)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempXZ, &fn, 1)){
         return NULL;
     }
     
@@ -1639,21 +2614,32 @@ static PyObject *s2plot_s2funxzr(PyObject *self, PyObject *args){
     
     pyParametricSurface = tempXZ;
 
-    s2funxzr(cParametricSurface, nx, nz, xmin, xmax, zmin, zmax, ctl, rmin, rmax);
+    if(fn != NULL){
+        // a native function needs no python in the loop
+        s2funxzr((S2PY_UVFUNC) fn, nx, nz, xmin, xmax, zmin, zmax, ctl, rmin, rmax);
+    } else if(vectorised){
+        if(!surface_fill(&pyParametricSurface, 1, nx, xmin, xmax, nz, zmin, zmax)){
+            return NULL;
+        }
+        s2funxzr(cSurfaceVector, nx, nz, xmin, xmax, zmin, zmax, ctl, rmin, rmax);
+        surface_clear();
+    } else {
+        s2funxzr(cParametricSurface, nx, nz, xmin, xmax, zmin, zmax, ctl, rmin, rmax);
+    }
 
     Py_INCREF(Py_None);
     return Py_None; 
 }
 static PyObject *s2plot_s2funyzr(PyObject *self, PyObject *args){
-    int ny, nz, ctl;
+    int ny, nz, ctl, vectorised = 0;
     float ymin, ymax, zmin, zmax, rmin, rmax;
     PyObject *tempYZ;
+    void *fn;
     
-    if(!PyArg_ParseTuple(args, "Oiiffffi:s2funyzr", &tempYZ, &ny, &nz, &ymin, &ymax, &zmin, &zmax, &ctl, &rmin, &rmax)) {
+    if(!PyArg_ParseTuple(args, "Oiiffffiff|i:s2funyzr", &tempYZ, &ny, &nz, &ymin, &ymax, &zmin, &zmax, &ctl, &rmin, &rmax, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempYZ)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempYZ, &fn, 1)){
         return NULL;
     }
     
@@ -1663,13 +2649,25 @@ static PyObject *s2plot_s2funyzr(PyObject *self, PyObject *args){
     
     pyParametricSurface = tempYZ;
 
-    s2funyzr(cParametricSurface, ny, nz, ymin, ymax, zmin, zmax, ctl, rmin, rmax);
+    if(fn != NULL){
+        // a native function needs no python in the loop
+        s2funyzr((S2PY_UVFUNC) fn, ny, nz, ymin, ymax, zmin, zmax, ctl, rmin, rmax);
+    } else if(vectorised){
+        if(!surface_fill(&pyParametricSurface, 1, ny, ymin, ymax, nz, zmin, zmax)){
+            return NULL;
+        }
+        s2funyzr(cSurfaceVector, ny, nz, ymin, ymax, zmin, zmax, ctl, rmin, rmax);
+        surface_clear();
+    } else {
+        s2funyzr(cParametricSurface, ny, nz, ymin, ymax, zmin, zmax, ctl, rmin, rmax);
+    }
 
     Py_INCREF(Py_None);
     return Py_None; 
     
 }
 float cParametricSurface_fx(float *u, float *v){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1680,14 +2678,17 @@ float cParametricSurface_fx(float *u, float *v){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 float cParametricSurface_fy(float *u, float *v){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1698,14 +2699,17 @@ float cParametricSurface_fy(float *u, float *v){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 float cParametricSurface_fz(float *u, float *v){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1716,14 +2720,17 @@ float cParametricSurface_fz(float *u, float *v){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 float cParametricSurface_fc(float *u, float *v){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
     
@@ -1734,24 +2741,31 @@ float cParametricSurface_fc(float *u, float *v){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
     
+    PyGILState_Release(gstate);
     return result;
 }
 static PyObject *s2plot_s2funuv(PyObject *self, PyObject *args){
-    int uDIV, vDIV;
+    int uDIV, vDIV, vectorised = 0;
     float umin, umax, vmin, vmax;
     PyObject *tempX, *tempY, *tempZ, *tempC;
+    S2PY_UVFUNC fx, fy, fz, fc;
+    void *fn[4];
     
-    if(!PyArg_ParseTuple(args, "OOOOffiffi:s2funuv", &tempX, &tempY, &tempZ, &tempC, &umin, &umax, &uDIV, &vmin, &vmax, &vDIV)) {
+    if(!PyArg_ParseTuple(args, "OOOOffiffi|i:s2funuv", &tempX, &tempY, &tempZ, &tempC, &umin, &umax, &uDIV, &vmin, &vmax, &vDIV, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempX) || !PyCallable_Check(tempY) || !PyCallable_Check(tempZ) || !PyCallable_Check(tempC)) {
-        PyErr_SetString(PyExc_TypeError, "parameters must be callable");
-        return NULL;
+    {
+        PyObject *temps[4] = {tempX, tempY, tempZ, tempC};
+
+        if(!native_callbacks(temps, fn, 4)){
+            return NULL;
+        }
     }
     
     // store a reference to the new callback
@@ -1769,13 +2783,30 @@ static PyObject *s2plot_s2funuv(PyObject *self, PyObject *args){
     pyParametric_fz = tempZ;
     pyParametric_fc = tempC;
 
-    s2funuv(cParametricSurface_fx, cParametricSurface_fy, cParametricSurface_fz, cParametricSurface_fc, umin, umax, uDIV, vmin, vmax, vDIV);
+    // native functions go straight to s2plot
+    fx = fn[0] ? (S2PY_UVFUNC) fn[0] : (vectorised ? cSurfaceVector_fx : cParametricSurface_fx);
+    fy = fn[1] ? (S2PY_UVFUNC) fn[1] : (vectorised ? cSurfaceVector_fy : cParametricSurface_fy);
+    fz = fn[2] ? (S2PY_UVFUNC) fn[2] : (vectorised ? cSurfaceVector_fz : cParametricSurface_fz);
+    fc = fn[3] ? (S2PY_UVFUNC) fn[3] : (vectorised ? cSurfaceVector_fc : cParametricSurface_fc);
+
+    if(vectorised){
+        PyObject *funcs[4] = {fn[0] ? NULL : pyParametric_fx, fn[1] ? NULL : pyParametric_fy,
+                              fn[2] ? NULL : pyParametric_fz, fn[3] ? NULL : pyParametric_fc};
+
+        // uDIV divisions of u give uDIV+1 nodes, likewise for v
+        if(!surface_fill(funcs, 4, uDIV + 1, umin, umax, vDIV + 1, vmin, vmax)){
+            return NULL;
+        }
+    }
+    s2funuv(fx, fy, fz, fc, umin, umax, uDIV, vmin, vmax, vDIV);
+    surface_clear();
 
     Py_INCREF(Py_None);
     return Py_None;
 }
 
 float cParametricSurface_fa(float *u, float *v){
+    PyGILState_STATE gstate = PyGILState_Ensure();
     float result;
     PyObject *arg, *pyResult;
 
@@ -1786,28 +2817,34 @@ float cParametricSurface_fa(float *u, float *v){
 
     // errors?
     if(pyResult == NULL){
+        PyGILState_Release(gstate);
         return 0;
     }
     result = (float) PyFloat_AsDouble(pyResult);
     Py_XDECREF(pyResult);
 
+    PyGILState_Release(gstate);
     return result;
 }
 
 static PyObject *s2plot_s2funuva(PyObject *self, PyObject *args){
-    int uDIV, vDIV;
+    int uDIV, vDIV, vectorised = 0;
     float umin, umax, vmin, vmax;
     PyObject *tempX, *tempY, *tempZ, *tempC, *tempA;
     char *trans;
+    S2PY_UVFUNC fx, fy, fz, fc, fa;
+    void *fn[5];
 
-    if(!PyArg_ParseTuple(args, "OOOOsOffiffi:s2funuva", &tempX, &tempY, &tempZ, &tempC, &trans, &tempA,
-                         &umin, &umax, &uDIV, &vmin, &vmax, &vDIV)) {
+    if(!PyArg_ParseTuple(args, "OOOOsOffiffi|i:s2funuva", &tempX, &tempY, &tempZ, &tempC, &trans, &tempA,
+                         &umin, &umax, &uDIV, &vmin, &vmax, &vDIV, &vectorised)) {
         return NULL;
     }
-    if (!PyCallable_Check(tempX) || !PyCallable_Check(tempY) || !PyCallable_Check(tempZ) || !PyCallable_Check(tempC)
-        || !PyCallable_Check(tempA)) {
-        PyErr_SetString(PyExc_TypeError, "parameters must be callable");
-        return NULL;
+    {
+        PyObject *temps[5] = {tempX, tempY, tempZ, tempC, tempA};
+
+        if(!native_callbacks(temps, fn, 5)){
+            return NULL;
+        }
     }
 
     // store a reference to the new callback
@@ -1828,8 +2865,24 @@ static PyObject *s2plot_s2funuva(PyObject *self, PyObject *args){
     pyParametric_fc = tempC;
     pyParametric_fa = tempA;
 
-    s2funuva(cParametricSurface_fx, cParametricSurface_fy, cParametricSurface_fz, cParametricSurface_fc, trans[0],
-             cParametricSurface_fa, umin, umax, uDIV, vmin, vmax, vDIV);
+    // native functions go straight to s2plot
+    fx = fn[0] ? (S2PY_UVFUNC) fn[0] : (vectorised ? cSurfaceVector_fx : cParametricSurface_fx);
+    fy = fn[1] ? (S2PY_UVFUNC) fn[1] : (vectorised ? cSurfaceVector_fy : cParametricSurface_fy);
+    fz = fn[2] ? (S2PY_UVFUNC) fn[2] : (vectorised ? cSurfaceVector_fz : cParametricSurface_fz);
+    fc = fn[3] ? (S2PY_UVFUNC) fn[3] : (vectorised ? cSurfaceVector_fc : cParametricSurface_fc);
+    fa = fn[4] ? (S2PY_UVFUNC) fn[4] : (vectorised ? cSurfaceVector_fa : cParametricSurface_fa);
+
+    if(vectorised){
+        PyObject *funcs[5] = {fn[0] ? NULL : pyParametric_fx, fn[1] ? NULL : pyParametric_fy,
+                              fn[2] ? NULL : pyParametric_fz, fn[3] ? NULL : pyParametric_fc,
+                              fn[4] ? NULL : pyParametric_fa};
+
+        if(!surface_fill(funcs, 5, uDIV + 1, umin, umax, vDIV + 1, vmin, vmax)){
+            return NULL;
+        }
+    }
+    s2funuva(fx, fy, fz, fc, trans[0], fa, umin, umax, uDIV, vmin, vmax, vDIV);
+    surface_clear();
 
     Py_INCREF(Py_None);
     return Py_None;
@@ -2262,27 +3315,21 @@ static PyObject *s2plot_ns2vpoint(PyObject *self, PyObject *args){
 static PyObject *s2plot_ns2vnpoint(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR col;
-    int n, i;
+    int n;
     PyObject *PIn, *colIn;
     
     if(!PyArg_ParseTuple(args, "OOi:ns2vpoint", &PIn, &colIn, &n) || NULL == PIn || NULL == colIn){
         return NULL;
     }
     
-    if((int) PyList_Size(PIn) != n){
-        PyErr_SetString(PyExc_IndexError, "the list of positions must have length n");
+    if(!(P = List_to_XYZ(PIn, &n, "the list of positions"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(n, sizeof(XYZ));
-    for(i = 0; i < n; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-    }
-
+    col = Dict_to_COLOUR(colIn);
     
     ns2vnpoint(P, col, n);
     
-    free(P);
+    List_free(PIn, P);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2503,25 +3550,19 @@ static PyObject *s2plot_ns2vf3(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR col;
     PyObject *PIn, *colIn;
-    int i;
+    int n = 3;
 
     if(!PyArg_ParseTuple(args, "OO:ns2vf3", &PIn, &colIn) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 3){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 3 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(3, sizeof(XYZ));
-    for(i = 0; i < 3; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-    }
     col = Dict_to_COLOUR(colIn);
     
     ns2vf3(P, col);
     
-    free(P);
+    List_free(PIn, P);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2530,28 +3571,24 @@ static PyObject *s2plot_ns2vf3n(PyObject *self, PyObject *args){
     XYZ *P, *N;
     COLOUR col;
     PyObject *PIn, *NIn, *colIn;
-    int i;
+    int n = 3;
 
     if(!PyArg_ParseTuple(args, "OOO:ns2vf3n", &PIn, &NIn, &colIn) || NULL == PIn || NULL == NIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 3 || PyList_Size(NIn) != 3){
-        PyErr_SetString(PyExc_IndexError, "vertices and normals must be lists of 3 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(3, sizeof(XYZ));
-    N = (XYZ *) calloc(3, sizeof(XYZ));    
-    for(i = 0; i < 3; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-        N[i] = Dict_to_XYZ(PyList_GetItem(NIn, i));        
+    if(!(N = List_to_XYZ(NIn, &n, "normals"))){
+        List_free(PIn, P);
+        return NULL;
     }
     col = Dict_to_COLOUR(colIn);
     
     ns2vf3n(P, N, col);
-
-    free(P);
-    free(N);
+    
+    List_free(PIn, P);
+    List_free(NIn, N);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2560,27 +3597,23 @@ static PyObject *s2plot_ns2vf3c(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR *col;
     PyObject *PIn, *colIn;
-    int i;
+    int n = 3;
 
     if(!PyArg_ParseTuple(args, "OO:ns2vf3c", &PIn, &colIn) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 3 || PyList_Size(colIn) != 3){
-        PyErr_SetString(PyExc_IndexError, "vertices and colours must be lists of 3 dictionaries");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(3, sizeof(XYZ));
-    col = (COLOUR *) calloc(3, sizeof(COLOUR));    
-    for(i = 0; i < 3; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-        col[i] = Dict_to_COLOUR(PyList_GetItem(colIn, i));        
+    if(!(col = List_to_COLOUR(colIn, &n, "colours"))){
+        List_free(PIn, P);
+        return NULL;
     }
     
     ns2vf3c(P, col);
     
-    free(P);
-    free(col);
+    List_free(PIn, P);
+    List_free(colIn, col);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2589,58 +3622,373 @@ static PyObject *s2plot_ns2vf3nc(PyObject *self, PyObject *args){
     XYZ *P, *N;
     COLOUR *col;
     PyObject *PIn, *NIn, *colIn;
-    int i;
+    int n = 3;
 
     if(!PyArg_ParseTuple(args, "OOO:ns2vf3nc", &PIn, &NIn, &colIn) || NULL == PIn || NULL == NIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 3 || PyList_Size(NIn) != 3 || PyList_Size(colIn) != 3){
-        PyErr_SetString(PyExc_IndexError, "vertices, normals and colours must be lists of 3 dictionaries");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(3, sizeof(XYZ));
-    N = (XYZ *) calloc(3, sizeof(XYZ));   
-    col = (COLOUR *) calloc(3, sizeof(COLOUR)); 
-    for(i = 0; i < 3; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-        N[i] = Dict_to_XYZ(PyList_GetItem(NIn, i));
-        col[i] = Dict_to_COLOUR(PyList_GetItem(colIn, i));
+    if(!(N = List_to_XYZ(NIn, &n, "normals"))){
+        List_free(PIn, P);
+        return NULL;
+    }
+    if(!(col = List_to_COLOUR(colIn, &n, "colours"))){
+        List_free(PIn, P);
+        List_free(NIn, N);
+        return NULL;
     }
     
     ns2vf3nc(P, N, col);
     
-    free(P);
-    free(N);
-    free(col);
+    List_free(PIn, P);
+    List_free(NIn, N);
+    List_free(colIn, col);
     
     Py_INCREF(Py_None);
     return Py_None;
 }
+static PyObject *s2plot_ns2vnf3(PyObject *self, PyObject *args){
+    // draw M 3-vertex facets in one call: P (and N) are (M,3,3) arrays and
+    // col is an {rgb} dict, an (M,3) array of facet colours or an (M,3,3)
+    // array of vertex colours
+    XYZ *P, *N = NULL;
+    COLOUR *col = NULL, one, fcol[3];
+    PyArrayObject *PIn;
+    PyObject *NIn, *colIn;
+    npy_intp M, i;
+    int perVertex = 0;
+
+    if(!PyArg_ParseTuple(args, "O!OO:ns2vnf3", &PyArray_Type, &PIn, &NIn, &colIn) || NULL == PIn || NULL == NIn || NULL == colIn){
+        return NULL;
+    }
+    if(PyArray_NDIM(PIn) != 3 || PyArray_DIM(PIn, 1) != 3 || PyArray_DIM(PIn, 2) != 3){
+        PyErr_SetString(PyExc_ValueError, "vertices must be an array of shape (M,3,3)");
+        return NULL;
+    }
+    M = PyArray_DIM(PIn, 0);
+    if(NIn != Py_None && (!PyArray_Check(NIn) || PyArray_NDIM((PyArrayObject *) NIn) != 3 ||
+            PyArray_DIM((PyArrayObject *) NIn, 0) != M || PyArray_DIM((PyArrayObject *) NIn, 1) != 3 ||
+            PyArray_DIM((PyArrayObject *) NIn, 2) != 3)){
+        PyErr_SetString(PyExc_ValueError, "normals must be None or an array of shape (M,3,3)");
+        return NULL;
+    }
+    if(PyArray_Check(colIn)){
+        if(PyArray_NDIM((PyArrayObject *) colIn) == 3 && PyArray_DIM((PyArrayObject *) colIn, 0) == M &&
+                PyArray_DIM((PyArrayObject *) colIn, 1) == 3 && PyArray_DIM((PyArrayObject *) colIn, 2) == 3){
+            perVertex = 1;
+        } else if(PyArray_NDIM((PyArrayObject *) colIn) != 2 || PyArray_DIM((PyArrayObject *) colIn, 0) != M ||
+                PyArray_DIM((PyArrayObject *) colIn, 1) != 3){
+            PyErr_SetString(PyExc_ValueError, "colours must be an {rgb} dict or an array of shape (M,3) or (M,3,3)");
+            return NULL;
+        }
+    } else if(!PyDict_Check(colIn)){
+        PyErr_SetString(PyExc_ValueError, "colours must be an {rgb} dict or an array of shape (M,3) or (M,3,3)");
+        return NULL;
+    }
+
+    if(!(P = (XYZ *) array_to_float3(PIn, "vertices"))){
+        return NULL;
+    }
+    if(NIn != Py_None && !(N = (XYZ *) array_to_float3((PyArrayObject *) NIn, "normals"))){
+        List_free((PyObject *) PIn, P);
+        return NULL;
+    }
+    if(PyArray_Check(colIn)){
+        if(!(col = (COLOUR *) array_to_float3((PyArrayObject *) colIn, "colours"))){
+            List_free((PyObject *) PIn, P);
+            List_free(NIn, N);
+            return NULL;
+        }
+    } else {
+        one = Dict_to_COLOUR(colIn);
+    }
+
+    // facets are submitted straight from the packed arrays, so there is no
+    // per-facet allocation
+    for(i = 0; i < M; i++){
+        if(col == NULL){
+            if(N) ns2vf3n(P + 3*i, N + 3*i, one);
+            else  ns2vf3(P + 3*i, one);
+        } else if(perVertex){
+            if(N) ns2vf3nc(P + 3*i, N + 3*i, col + 3*i);
+            else  ns2vf3c(P + 3*i, col + 3*i);
+        } else {
+            fcol[0] = fcol[1] = fcol[2] = col[i];
+            if(N) ns2vf3nc(P + 3*i, N + 3*i, fcol);
+            else  ns2vf3c(P + 3*i, fcol);
+        }
+    }
+
+    List_free((PyObject *) PIn, P);
+    List_free(NIn, N);
+    List_free(colIn, col);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+// indexed meshes: vertices are shared between faces and the vertex normals
+// are generated here, so the caller only supplies positions and faces
+typedef struct {
+    int nverts, nfaces, nside;  // nside is 3 or 4 vertices per face
+    XYZ *verts, *norms;
+    COLOUR *cols;               // per-vertex colours, or NULL to use col
+    COLOUR col;
+    int *faces;                 // nfaces*nside vertex indices
+} S2PY_MESH;
+static S2PY_MESH *meshList = NULL;
+static int nMeshes = 0;
+
+static S2PY_MESH *mesh_lookup(int id){
+    if(id < 0 || id >= nMeshes || meshList[id].faces == NULL){
+        PyErr_Format(PyExc_IndexError, "no mesh with id %d", id);
+        return NULL;
+    }
+    return &meshList[id];
+}
+static void mesh_normals(S2PY_MESH *mesh){
+    // area-weighted vertex normals: each face adds its unnormalised normal
+    // (length twice its area) to every vertex it uses
+    int i, j, *f;
+    XYZ *v = mesh->verts, *nm = mesh->norms, a, b, c;
+    float len;
+
+    memset(nm, 0, (size_t) mesh->nverts*sizeof(XYZ));
+    #pragma omp parallel for private(j, f, a, b, c) schedule(static) if(mesh->nfaces >= S2PY_OMP_CHUNK)
+    for(i = 0; i < mesh->nfaces; i++){
+        f = mesh->faces + (size_t) i*mesh->nside;
+        if(mesh->nside == 3){
+            a.x = v[f[1]].x - v[f[0]].x; a.y = v[f[1]].y - v[f[0]].y; a.z = v[f[1]].z - v[f[0]].z;
+            b.x = v[f[2]].x - v[f[0]].x; b.y = v[f[2]].y - v[f[0]].y; b.z = v[f[2]].z - v[f[0]].z;
+        } else {
+            // the diagonals of a quad give its normal and twice its area
+            a.x = v[f[2]].x - v[f[0]].x; a.y = v[f[2]].y - v[f[0]].y; a.z = v[f[2]].z - v[f[0]].z;
+            b.x = v[f[3]].x - v[f[1]].x; b.y = v[f[3]].y - v[f[1]].y; b.z = v[f[3]].z - v[f[1]].z;
+        }
+        c.x = a.y*b.z - a.z*b.y;
+        c.y = a.z*b.x - a.x*b.z;
+        c.z = a.x*b.y - a.y*b.x;
+        for(j = 0; j < mesh->nside; j++){
+            #pragma omp atomic
+            nm[f[j]].x += c.x;
+            #pragma omp atomic
+            nm[f[j]].y += c.y;
+            #pragma omp atomic
+            nm[f[j]].z += c.z;
+        }
+    }
+    #pragma omp parallel for private(len) schedule(static) if(mesh->nverts >= S2PY_OMP_CHUNK)
+    for(i = 0; i < mesh->nverts; i++){
+        len = sqrtf(nm[i].x*nm[i].x + nm[i].y*nm[i].y + nm[i].z*nm[i].z);
+        if(len > 0.){
+            nm[i].x /= len;
+            nm[i].y /= len;
+            nm[i].z /= len;
+        }
+    }
+}
+static void mesh_free(S2PY_MESH *mesh){
+    free(mesh->verts);
+    free(mesh->norms);
+    free(mesh->cols);
+    free(mesh->faces);
+    memset(mesh, 0, sizeof(S2PY_MESH));
+}
+static PyObject *s2plot_ns2cmesh(PyObject *self, PyObject *args){
+    S2PY_MESH mesh, *grown;
+    PyObject *vertsIn, *facesIn, *colIn;
+    PyArrayObject *faces;
+    XYZ *verts;
+    COLOUR *cols;
+    npy_intp nindex, i;
+    int n = -1, id;
+
+    if(!PyArg_ParseTuple(args, "OOO:ns2cmesh", &vertsIn, &facesIn, &colIn) || NULL == vertsIn || NULL == facesIn || NULL == colIn){
+        return NULL;
+    }
+    memset(&mesh, 0, sizeof(S2PY_MESH));
+
+    if(!(faces = (PyArrayObject *) PyArray_ContiguousFromObject(facesIn, PyArray_INT, 2, 2))){
+        return NULL;
+    }
+    if(PyArray_DIM(faces, 1) != 3 && PyArray_DIM(faces, 1) != 4){
+        PyErr_SetString(PyExc_ValueError, "faces must be an array of shape (F,3) or (F,4)");
+        Py_DECREF(faces);
+        return NULL;
+    }
+    if(!(verts = List_to_XYZ(vertsIn, &n, "vertices"))){
+        Py_DECREF(faces);
+        return NULL;
+    }
+    if(PyArray_DIM(faces, 0) > INT_MAX){
+        PyErr_SetString(PyExc_ValueError, "too many faces");
+        Py_DECREF(faces);
+        return NULL;
+    }
+    mesh.nverts = n;
+    mesh.nfaces = (int) PyArray_DIM(faces, 0);
+    mesh.nside = (int) PyArray_DIM(faces, 1);
+    if(mesh.nverts == 0 || mesh.nfaces == 0){
+        PyErr_SetString(PyExc_ValueError, "a mesh needs at least one vertex and one face");
+        List_free(vertsIn, verts);
+        Py_DECREF(faces);
+        return NULL;
+    }
+
+    // the mesh keeps its own copies, so the caller's arrays may be reused
+    nindex = (npy_intp) mesh.nfaces*mesh.nside;
+    mesh.verts = (XYZ *) malloc((size_t) mesh.nverts*sizeof(XYZ));
+    mesh.norms = (XYZ *) malloc((size_t) mesh.nverts*sizeof(XYZ));
+    mesh.faces = (int *) malloc((size_t) nindex*sizeof(int));
+    if(!mesh.verts || !mesh.norms || !mesh.faces){
+        List_free(vertsIn, verts);
+        Py_DECREF(faces);
+        mesh_free(&mesh);
+        return PyErr_NoMemory();
+    }
+    memcpy(mesh.verts, verts, (size_t) mesh.nverts*sizeof(XYZ));
+    memcpy(mesh.faces, PyArray_DATA(faces), (size_t) nindex*sizeof(int));
+    List_free(vertsIn, verts);
+    Py_DECREF(faces);
+
+    for(i = 0; i < nindex; i++){
+        if(mesh.faces[i] < 0 || mesh.faces[i] >= mesh.nverts){
+            PyErr_Format(PyExc_IndexError, "face vertex index %d out of range", mesh.faces[i]);
+            mesh_free(&mesh);
+            return NULL;
+        }
+    }
+
+    if(PyDict_Check(colIn)){
+        mesh.col = Dict_to_COLOUR(colIn);
+    } else {
+        n = mesh.nverts;
+        if(!(cols = List_to_COLOUR(colIn, &n, "colours"))){
+            mesh_free(&mesh);
+            return NULL;
+        }
+        if(!(mesh.cols = (COLOUR *) malloc((size_t) mesh.nverts*sizeof(COLOUR)))){
+            List_free(colIn, cols);
+            mesh_free(&mesh);
+            return PyErr_NoMemory();
+        }
+        memcpy(mesh.cols, cols, (size_t) mesh.nverts*sizeof(COLOUR));
+        List_free(colIn, cols);
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    mesh_normals(&mesh);
+    Py_END_ALLOW_THREADS
+
+    // reuse a freed slot if there is one
+    for(id = 0; id < nMeshes && meshList[id].faces != NULL; id++);
+    if(id == nMeshes){
+        if(!(grown = (S2PY_MESH *) realloc(meshList, (size_t) (nMeshes + 1)*sizeof(S2PY_MESH)))){
+            mesh_free(&mesh);
+            return PyErr_NoMemory();
+        }
+        meshList = grown;
+        nMeshes++;
+    }
+    meshList[id] = mesh;
+
+    return PyInt_FromLong((long) id);
+}
+static PyObject *s2plot_ns2umesh(PyObject *self, PyObject *args){
+    S2PY_MESH *mesh;
+    PyObject *vertsIn;
+    XYZ *verts;
+    int id, n;
+
+    if(!PyArg_ParseTuple(args, "iO:ns2umesh", &id, &vertsIn) || NULL == vertsIn){
+        return NULL;
+    }
+    if(!(mesh = mesh_lookup(id))){
+        return NULL;
+    }
+    n = mesh->nverts;
+    if(!(verts = List_to_XYZ(vertsIn, &n, "vertices"))){
+        return NULL;
+    }
+    memcpy(mesh->verts, verts, (size_t) n*sizeof(XYZ));
+    List_free(vertsIn, verts);
+    // the GIL is kept: the mesh lives in meshList, which other threads may
+    // draw from or grow
+    mesh_normals(mesh);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static void mesh_draw(const S2PY_MESH *mesh){
+    XYZ P[4], N[4];
+    COLOUR col[4];
+    int i, j, *f;
+
+    for(j = 0; j < 4; j++){
+        col[j] = mesh->col;
+    }
+    for(i = 0; i < mesh->nfaces; i++){
+        f = mesh->faces + (size_t) i*mesh->nside;
+        for(j = 0; j < mesh->nside; j++){
+            P[j] = mesh->verts[f[j]];
+            N[j] = mesh->norms[f[j]];
+            if(mesh->cols) col[j] = mesh->cols[f[j]];
+        }
+        if(mesh->nside == 3) ns2vf3nc(P, N, col);
+        else                 ns2vf4nc(P, N, col);
+    }
+}
+static PyObject *s2plot_ns2dmesh(PyObject *self, PyObject *args){
+    S2PY_MESH *mesh;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ns2dmesh", &id)){
+        return NULL;
+    }
+    if(!(mesh = mesh_lookup(id))){
+        return NULL;
+    }
+    // the GIL is kept so no other thread can update, free or move the mesh
+    // while it is drawn
+    mesh_draw(mesh);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ns2fmesh(PyObject *self, PyObject *args){
+    S2PY_MESH *mesh;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ns2fmesh", &id)){
+        return NULL;
+    }
+    if(!(mesh = mesh_lookup(id))){
+        return NULL;
+    }
+    mesh_free(mesh);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
 static PyObject *s2plot_ns2vf4(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR col;
     PyObject *PIn, *colIn;
-    int i;
+    int n = 4;
 
     if(!PyArg_ParseTuple(args, "OO:ns2vf4", &PIn, &colIn) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 4){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    for(i = 0; i < 4; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-    }
     col = Dict_to_COLOUR(colIn);
-
+    
     ns2vf4(P, col);
-
-    free(P);
-
+    
+    List_free(PIn, P);
+    
     Py_INCREF(Py_None);
     return Py_None;
 }
@@ -2648,29 +3996,25 @@ static PyObject *s2plot_ns2vf4n(PyObject *self, PyObject *args){
     XYZ *P, *N;
     COLOUR col;
     PyObject *PIn, *NIn, *colIn;
-    int i;
+    int n = 4;
 
     if(!PyArg_ParseTuple(args, "OOO:ns2vf4n", &PIn, &NIn, &colIn) || NULL == PIn || NULL == NIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 3 || PyList_Size(NIn) != 3){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    N = (XYZ *) calloc(4, sizeof(XYZ));
-    for(i = 0; i < 4; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-        N[i] = Dict_to_XYZ(PyList_GetItem(NIn, i));
+    if(!(N = List_to_XYZ(NIn, &n, "normals"))){
+        List_free(PIn, P);
+        return NULL;
     }
     col = Dict_to_COLOUR(colIn);
-
+    
     ns2vf4n(P, N, col);
-
-    free(P);
-    free(N);
-
+    
+    List_free(PIn, P);
+    List_free(NIn, N);
+    
     Py_INCREF(Py_None);
     return Py_None;
 }
@@ -2678,27 +4022,23 @@ static PyObject *s2plot_ns2vf4c(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR *col;
     PyObject *PIn, *colIn;
-    int i;
+    int n = 4;
 
     if(!PyArg_ParseTuple(args, "OO:ns2vf4c", &PIn, &colIn) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 4 || PyList_Size(colIn) != 4){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    col = (COLOUR *) calloc(4, sizeof(COLOUR));
-    for(i = 0; i < 3; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-        col[i] = Dict_to_COLOUR(PyList_GetItem(colIn, i));
+    if(!(col = List_to_COLOUR(colIn, &n, "colours"))){
+        List_free(PIn, P);
+        return NULL;
     }
     
     ns2vf4c(P, col);
     
-    free(P);
-    free(col);
+    List_free(PIn, P);
+    List_free(colIn, col);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2707,30 +4047,29 @@ static PyObject *s2plot_ns2vf4nc(PyObject *self, PyObject *args){
     XYZ *P, *N;
     COLOUR *col;
     PyObject *PIn, *NIn, *colIn;
-    int i;
+    int n = 4;
 
-    if(!PyArg_ParseTuple(args, "OOO:ns2vf4nc", &PIn, &NIn, &colIn) || NULL == PIn || NULL == NIn ||NULL == colIn){
+    if(!PyArg_ParseTuple(args, "OOO:ns2vf4nc", &PIn, &NIn, &colIn) || NULL == PIn || NULL == NIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 4 || PyList_Size(NIn) != 4 || PyList_Size(colIn) != 4){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    N = (XYZ *) calloc(4, sizeof(XYZ));
-    col = (COLOUR *) calloc(4, sizeof(COLOUR));
-    for(i = 0; i < 4; i++){ 
-       P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-        N[i] = Dict_to_XYZ(PyList_GetItem(NIn, i));
-        col[i] = Dict_to_COLOUR(PyList_GetItem(colIn, i));
+    if(!(N = List_to_XYZ(NIn, &n, "normals"))){
+        List_free(PIn, P);
+        return NULL;
+    }
+    if(!(col = List_to_COLOUR(colIn, &n, "colours"))){
+        List_free(PIn, P);
+        List_free(NIn, N);
+        return NULL;
     }
     
     ns2vf4nc(P, N, col);
     
-    free(P);
-    free(N);
-    free(col);
+    List_free(PIn, P);
+    List_free(NIn, N);
+    List_free(colIn, col);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2739,27 +4078,21 @@ static PyObject *s2plot_ns2vf4t(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR col;
     PyObject *PIn, *colIn;
+    int n = 4;
     float scale;
     char *texturefn, *trans;
-    int i;
 
     if(!PyArg_ParseTuple(args, "OOsfs:ns2vf4t", &PIn, &colIn, &texturefn, &scale, &trans) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 4){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    for(i = 0; i < 4; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-    }
     col = Dict_to_COLOUR(colIn);
     
     ns2vf4t(P, col, texturefn, scale, trans[0]);
     
-    free(P);
+    List_free(PIn, P);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2768,28 +4101,22 @@ static PyObject *s2plot_ns2vf4x(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR col;
     PyObject *PIn, *colIn;
+    int n = 4;
     unsigned int textureid;
     float scale;
     char *trans;
-    int i;
 
     if(!PyArg_ParseTuple(args, "OOIfs:ns2vf4x", &PIn, &colIn, &textureid, &scale, &trans) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 4){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    for(i = 0; i < 4; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-    }
     col = Dict_to_COLOUR(colIn);
     
     ns2vf4x(P, col, textureid, scale, trans[0]);
     
-    free(P);
+    List_free(PIn, P);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2798,28 +4125,22 @@ static PyObject *s2plot_ns2vf4xt(PyObject *self, PyObject *args){
     XYZ *P;
     COLOUR col;
     PyObject *PIn, *colIn;
+    int n = 4;
     unsigned int textureid;
     float iscale, ialpha;
     char *itrans;
-    int i;
 
     if(!PyArg_ParseTuple(args, "OOIfsf:ns2vf4xt", &PIn, &colIn, &textureid, &iscale, &itrans, &ialpha) || NULL == PIn || NULL == colIn){
         return NULL;
     }
-    if(PyList_Size(PIn) != 4){
-        PyErr_SetString(PyExc_IndexError, "vertices must be a list of 4 dictionaries of {x,y,z}");
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
         return NULL;
     }
-    
-    P = (XYZ *) calloc(4, sizeof(XYZ));
-    for(i = 0; i < 4; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn, i));
-    }
     col = Dict_to_COLOUR(colIn);
     
     ns2vf4xt(P, col, textureid, iscale, itrans[0], ialpha);
     
-    free(P);
+    List_free(PIn, P);
     
     Py_INCREF(Py_None);
     return Py_None;
@@ -2943,6 +4264,309 @@ static PyObject *s2plot_ds2vbbr(PyObject *self, PyObject *args){
     Py_INCREF(Py_None);
     return Py_None;
 }
+// DEPTH SORTING
+// translucent batches are drawn back to front. The order from the previous
+// frame is kept and refined by insertion sort, which is near linear while the
+// camera moves smoothly; a parallel LSD radix sort on the depth keys takes
+// over when that runs past its budget.
+typedef struct {
+    unsigned int *perm;     // back-to-front order of the last sort
+    int n;
+} S2PY_DEPTHSORT;
+
+static unsigned int depth_key(XYZ p, XYZ eye, XYZ vdir){
+    // unsigned keys that increase from far to near
+    union {float f; unsigned int u;} d;
+
+    d.f = (p.x - eye.x)*vdir.x + (p.y - eye.y)*vdir.y + (p.z - eye.z)*vdir.z;
+    d.u ^= (d.u & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+    return ~d.u;
+}
+static int coherent_sort(unsigned int *key, unsigned int *perm, int n, long budget){
+    // insertion sort of nearly sorted keys; gives up (leaving a valid but
+    // partly sorted order) once more than budget elements have been moved
+    int i, j;
+    unsigned int k, p;
+    long moves = 0;
+
+    for(i = 1; i < n; i++){
+        k = key[i];
+        p = perm[i];
+        for(j = i; j > 0 && key[j-1] > k; j--){
+            key[j] = key[j-1];
+            perm[j] = perm[j-1];
+        }
+        key[j] = k;
+        perm[j] = p;
+        if((moves += i - j) > budget) return 0;
+    }
+    return 1;
+}
+static int radix_sort(unsigned int *key, unsigned int *perm, int n){
+    // stable 4 x 8-bit LSD sort of key, carrying perm along. Each chunk of
+    // S2PY_OMP_CHUNK elements gets its own histogram so the counting and
+    // scattering can run on separate threads.
+    unsigned int *key2, *perm2, *swap;
+    int *hist, *h, nchunks, shift, c, d, i, lo, hi, sum, t, swapped = 0;
+
+    nchunks = (n + S2PY_OMP_CHUNK - 1)/S2PY_OMP_CHUNK;
+    key2 = (unsigned int *) malloc((size_t) n*sizeof(unsigned int));
+    perm2 = (unsigned int *) malloc((size_t) n*sizeof(unsigned int));
+    hist = (int *) malloc((size_t) nchunks*256*sizeof(int));
+    if(!key2 || !perm2 || !hist){
+        free(key2);
+        free(perm2);
+        free(hist);
+        return 0;
+    }
+    for(shift = 0; shift < 32; shift += 8){
+        #pragma omp parallel for private(h, i, lo, hi) schedule(static) if(n >= S2PY_OMP_THRESHOLD)
+        for(c = 0; c < nchunks; c++){
+            h = hist + c*256;
+            lo = c*S2PY_OMP_CHUNK;
+            hi = (n - lo < S2PY_OMP_CHUNK) ? n : lo + S2PY_OMP_CHUNK;
+            memset(h, 0, 256*sizeof(int));
+            for(i = lo; i < hi; i++) h[(key[i] >> shift) & 255]++;
+        }
+        // nothing to do if every key has the same digit
+        d = (key[0] >> shift) & 255;
+        for(sum = 0, c = 0; c < nchunks; c++) sum += hist[c*256 + d];
+        if(sum == n) continue;
+        // offsets in (digit, chunk) order keep the sort stable
+        for(sum = 0, d = 0; d < 256; d++){
+            for(c = 0; c < nchunks; c++){
+                t = hist[c*256 + d];
+                hist[c*256 + d] = sum;
+                sum += t;
+            }
+        }
+        #pragma omp parallel for private(h, i, lo, hi, d) schedule(static) if(n >= S2PY_OMP_THRESHOLD)
+        for(c = 0; c < nchunks; c++){
+            h = hist + c*256;
+            lo = c*S2PY_OMP_CHUNK;
+            hi = (n - lo < S2PY_OMP_CHUNK) ? n : lo + S2PY_OMP_CHUNK;
+            for(i = lo; i < hi; i++){
+                d = h[(key[i] >> shift) & 255]++;
+                key2[d] = key[i];
+                perm2[d] = perm[i];
+            }
+        }
+        swap = key; key = key2; key2 = swap;
+        swap = perm; perm = perm2; perm2 = swap;
+        swapped = !swapped;
+    }
+    if(swapped){
+        // the result is in the scratch buffers: copy it back
+        memcpy(key2, key, (size_t) n*sizeof(unsigned int));
+        memcpy(perm2, perm, (size_t) n*sizeof(unsigned int));
+        free(key);
+        free(perm);
+    } else {
+        free(key2);
+        free(perm2);
+    }
+    free(hist);
+    return 1;
+}
+static unsigned int *depth_sort(S2PY_DEPTHSORT *state, const XYZ *P, int n, XYZ eye, XYZ vdir){
+    // the back-to-front drawing order of P for a camera at eye looking along
+    // vdir (from ss2qc), or NULL if out of memory. Touches neither python
+    // nor the library, so can run without the GIL on a state no other
+    // thread can see.
+    unsigned int *key;
+    int i, fresh = 0;
+
+    if(state->n != n || state->perm == NULL){
+        free(state->perm);
+        state->n = 0;
+        if(!(state->perm = (unsigned int *) malloc((size_t) n*sizeof(unsigned int)))){
+            return NULL;
+        }
+        for(i = 0; i < n; i++) state->perm[i] = (unsigned int) i;
+        state->n = n;
+        fresh = 1;
+    }
+    if(!(key = (unsigned int *) malloc((size_t) n*sizeof(unsigned int)))){
+        return NULL;
+    }
+    #pragma omp parallel for schedule(static) if(n >= S2PY_OMP_THRESHOLD)
+    for(i = 0; i < n; i++){
+        key[i] = depth_key(P[state->perm[i]], eye, vdir);
+    }
+    if(fresh || !coherent_sort(key, state->perm, n, (long) n*S2PY_SORT_MOVES)){
+        if(!radix_sort(key, state->perm, n)){
+            free(key);
+            return NULL;
+        }
+    }
+    free(key);
+    return state->perm;
+}
+static void depth_sort_free(S2PY_DEPTHSORT *state){
+    free(state->perm);
+    state->perm = NULL;
+    state->n = 0;
+}
+// sort handles from ss2cds, so a batch drawn every frame keeps its order
+// from the previous one. Only touched with the GIL held.
+static S2PY_DEPTHSORT **sortList = NULL;   // NULL marks a free slot
+static int nSorts = 0;
+
+static S2PY_DEPTHSORT *depth_sort_lookup(int id){
+    // the state of handle id, or NULL (with the python error set unless id
+    // is -1, meaning none)
+    if(id == -1) return NULL;
+    if(id < 0 || id >= nSorts || sortList[id] == NULL){
+        PyErr_Format(PyExc_IndexError, "no depth sort handle with id %d", id);
+        return NULL;
+    }
+    return sortList[id];
+}
+static PyObject *s2plot_ss2cds(PyObject *self, PyObject *args){
+    S2PY_DEPTHSORT *state, **grown;
+    int id;
+
+    if(!PyArg_ParseTuple(args, ":ss2cds")){
+        return NULL;
+    }
+    if(!(state = (S2PY_DEPTHSORT *) calloc(1, sizeof(S2PY_DEPTHSORT)))){
+        return PyErr_NoMemory();
+    }
+    // reuse a freed slot if there is one
+    for(id = 0; id < nSorts && sortList[id] != NULL; id++);
+    if(id == nSorts){
+        if(!(grown = (S2PY_DEPTHSORT **) realloc(sortList, (size_t) (nSorts + 1)*sizeof(S2PY_DEPTHSORT *)))){
+            free(state);
+            return PyErr_NoMemory();
+        }
+        sortList = grown;
+        nSorts++;
+    }
+    sortList[id] = state;
+
+    return PyInt_FromLong((long) id);
+}
+static PyObject *s2plot_ss2fds(PyObject *self, PyObject *args){
+    S2PY_DEPTHSORT *state;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ss2fds", &id)){
+        return NULL;
+    }
+    if(!(state = depth_sort_lookup(id))){
+        if(!PyErr_Occurred()) PyErr_Format(PyExc_IndexError, "no depth sort handle with id %d", id);
+        return NULL;
+    }
+    depth_sort_free(state);
+    free(state);
+    sortList[id] = NULL;
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyArrayObject *per_item_float(PyObject *in, int n, float *scalar, const char *what){
+    // either a number, which is stored in scalar and NULL returned with no
+    // error set, or a new contiguous array of n floats
+    PyArrayObject *arr;
+
+    if(PyNumber_Check(in) && !PyArray_Check(in)){
+        *scalar = (float) PyFloat_AsDouble(in);
+        return NULL;
+    }
+    if(!(arr = (PyArrayObject *) PyArray_ContiguousFromObject(in, PyArray_FLOAT, 1, 1))){
+        return NULL;
+    }
+    if(PyArray_DIM(arr, 0) != n){
+        PyErr_Format(PyExc_ValueError, "%s must be a number or have %d elements", what, n);
+        Py_DECREF(arr);
+        return NULL;
+    }
+    return arr;
+}
+static PyObject *s2plot_ds2vnbb(PyObject *self, PyObject *args){
+    XYZ *iP, *iStretch = NULL, stretch = {0., 0., 0.}, eye, up, vdir;
+    COLOUR *iC = NULL, col = {1., 1., 1.};
+    PyArrayObject *sizeArr = NULL, *angleArr = NULL;
+    float *isize = NULL, *ipangle = NULL, size = 1., angle = 0., alpha;
+    unsigned int itextid;
+    char *trans;
+    PyObject *iPIn, *iStretchIn, *sizeIn, *iCIn, *angleIn = Py_None;
+    unsigned int *order = NULL;
+    S2PY_DEPTHSORT sort = {NULL, 0}, *state = NULL;
+    int n = -1, m, i, k, ok = 1, sortid = -1;
+
+    if(!PyArg_ParseTuple(args, "OOOOIfs|Oi:ds2vnbb", &iPIn, &iStretchIn, &sizeIn, &iCIn, &itextid, &alpha, &trans, &angleIn, &sortid) || NULL == iPIn || NULL == iStretchIn || NULL == sizeIn || NULL == iCIn){
+        return NULL;
+    }
+    if(!(iP = List_to_XYZ(iPIn, &n, "the list of positions"))){
+        return NULL;
+    }
+    // each per-billboard argument may instead be given once for all of them
+    if(PyDict_Check(iStretchIn)){
+        stretch = Dict_to_XYZ(iStretchIn);
+    } else {
+        m = n;
+        ok = (iStretch = List_to_XYZ(iStretchIn, &m, "the list of stretches")) != NULL;
+    }
+    if(ok && PyDict_Check(iCIn)){
+        col = Dict_to_COLOUR(iCIn);
+    } else if(ok){
+        m = n;
+        ok = (iC = List_to_COLOUR(iCIn, &m, "the list of colours")) != NULL;
+    }
+    if(ok){
+        sizeArr = per_item_float(sizeIn, n, &size, "isize");
+        ok = sizeArr != NULL || !PyErr_Occurred();
+    }
+    if(ok && angleIn != Py_None){
+        angleArr = per_item_float(angleIn, n, &angle, "ipangle");
+        ok = angleArr != NULL || !PyErr_Occurred();
+    }
+    if(ok && sortid != -1){
+        ok = (state = depth_sort_lookup(sortid)) != NULL;
+    }
+
+    if(ok){
+        if(sizeArr) isize = (float *) PyArray_DATA(sizeArr);
+        if(angleArr) ipangle = (float *) PyArray_DATA(angleArr);
+        // translucent billboards go back to front; unsorted if out of memory.
+        // A handle carries the order over from the last frame and is shared
+        // state, so it is sorted with the GIL held; a one-off sort is local
+        // and is the only thing here that runs without it.
+        if(trans[0] != 'o' && n > 1){
+            ss2qc(&eye, &up, &vdir, 1);
+            if(state){
+                order = depth_sort(state, iP, n, eye, vdir);
+            } else {
+                Py_BEGIN_ALLOW_THREADS
+                order = depth_sort(&sort, iP, n, eye, vdir);
+                Py_END_ALLOW_THREADS
+            }
+        }
+        for(k = 0; k < n; k++){
+            i = order ? (int) order[k] : k;
+            if(iStretch) stretch = iStretch[i];
+            if(iC) col = iC[i];
+            if(isize) size = isize[i];
+            if(ipangle) angle = ipangle[i];
+            if(angleIn != Py_None) ds2vbbr(iP[i], stretch, size, angle, col, itextid, alpha, trans[0]);
+            else                   ds2vbb(iP[i], stretch, size, col, itextid, alpha, trans[0]);
+        }
+        depth_sort_free(&sort);
+    }
+
+    List_free(iPIn, iP);
+    if(iStretch) List_free(iStretchIn, iStretch);
+    if(iC) List_free(iCIn, iC);
+    Py_XDECREF(sizeArr);
+    Py_XDECREF(angleArr);
+    if(!ok){
+        return NULL;
+    }
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
 static PyObject *s2plot_ds2vbbp(PyObject *self, PyObject *args){ /* NEW */
     XYZ iP, offset;
     float aspect, isize, alpha;
@@ -3022,333 +4646,1177 @@ static PyObject *s2plot_ds2isprotected(PyObject *self, PyObject *args){
     return pyResult;
 
 }
-// CALLBACK AND HANDLE SYSTEM
-static PyObject *pyCallbackDict = NULL;
-void   cCallBackFunction(double *time, int *keycount){
-    PyObject *arg;
-    PyObject *currentCallback, *callable, *callData;
-    PyObject *pyResult;
+// RETAINED GEOMETRY BUFFERS
+// points, lines and billboards copied from numpy once and replayed from C,
+// either by ds2dgb inside a callback or automatically before each frame
+// callback of the panel they are attached to
+typedef struct {
+    char kind;              // 'p' points, 'l' line segments, 'b' billboards; 0 if free
+    int n;                  // vertices (twice the number of segments for lines)
+    XYZ *P;
+    COLOUR *cols;           // per-vertex colours, or NULL to use col
+    COLOUR col;
+    float size;             // point size or line width in pixels, or billboard size
+    unsigned int texid;
+    float alpha;
+    char trans;
+    int panel;              // panel it is redrawn in automatically, or -1
+    S2PY_DEPTHSORT sort;    // drawing order of translucent billboards
+} S2PY_GBUF;
+static S2PY_GBUF *gbufList = NULL;
+static int nGbufs = 0;
 
-    if(pyCallbackDict == NULL){
-        // cannot set exception - in callback
-        return;
+void cCallBackFunction(double *time, int *keycount);
+static void jobs_collect(void);
+
+static S2PY_GBUF *gbuf_lookup(int id){
+    if(id < 0 || id >= nGbufs || gbufList[id].kind == 0){
+        PyErr_Format(PyExc_IndexError, "no geometry buffer with id %d", id);
+        return NULL;
     }
-    currentCallback = PyDict_GetItem(pyCallbackDict, PyInt_FromLong((long) xs2qsp()));
-    if(currentCallback == NULL || (PyTuple_Check(currentCallback) && PyTuple_Size(currentCallback) != 2) || (!PyTuple_Check(currentCallback) && !PyCallable_Check(currentCallback))){
-        // cannot set exception - in callback
-        return;
+    return &gbufList[id];
+}
+static void gbuf_free(S2PY_GBUF *buf){
+    free(buf->P);
+    free(buf->cols);
+    depth_sort_free(&buf->sort);
+    memset(buf, 0, sizeof(S2PY_GBUF));
+    buf->panel = -1;
+}
+static int gbuf_set_colours(S2PY_GBUF *buf, PyObject *colIn){
+    // a single {rgb} dict, or one colour per vertex
+    COLOUR *cols;
+    int n = buf->n;
+
+    if(PyDict_Check(colIn)){
+        free(buf->cols);
+        buf->cols = NULL;
+        buf->col = Dict_to_COLOUR(colIn);
+        return 1;
     }
-    if(PyTuple_Check(currentCallback) && PyTuple_Size(currentCallback) == 2){
-        callable = PyTuple_GetItem(currentCallback, 0);
-        callData = PyTuple_GetItem(currentCallback, 1);
-        if(callData == Py_None){
-            arg = Py_BuildValue("di", *time, *keycount);
-        } else {
-            arg = Py_BuildValue("diO", *time, *keycount, callData);
+    if(!(cols = List_to_COLOUR(colIn, &n, "colours"))){
+        return 0;
+    }
+    if(buf->cols == NULL && !(buf->cols = (COLOUR *) malloc((size_t) (buf->n ? buf->n : 1)*sizeof(COLOUR)))){
+        List_free(colIn, cols);
+        PyErr_NoMemory();
+        return 0;
+    }
+    memcpy(buf->cols, cols, (size_t) buf->n*sizeof(COLOUR));
+    List_free(colIn, cols);
+    return 1;
+}
+static void gbuf_draw(S2PY_GBUF *buf){
+    // no python objects are touched here
+    XYZ zero = {0., 0., 0.}, eye, up, vdir;
+    unsigned int *order = NULL;
+    int i, k;
+
+    switch(buf->kind){
+    case 'p':
+        for(i = 0; i < buf->n; i++){
+            ns2vthpoint(buf->P[i], buf->cols ? buf->cols[i] : buf->col, buf->size);
         }
-    } else {
-        callable = currentCallback;
-        arg = Py_BuildValue("di", *time, *keycount);
+        break;
+    case 'l':
+        for(i = 0; i + 1 < buf->n; i += 2){
+            if(buf->cols) ns2vthcline(buf->P[i], buf->P[i+1], buf->cols[i], buf->cols[i+1], buf->size);
+            else          ns2vthline(buf->P[i], buf->P[i+1], buf->col, buf->size);
+        }
+        break;
+    case 'b':
+        if(buf->trans != 'o' && buf->n > 1){
+            ss2qc(&eye, &up, &vdir, 1);
+            order = depth_sort(&buf->sort, buf->P, buf->n, eye, vdir);
+        }
+        for(k = 0; k < buf->n; k++){
+            i = order ? (int) order[k] : k;
+            ds2vbb(buf->P[i], zero, buf->size, buf->cols ? buf->cols[i] : buf->col, buf->texid, buf->alpha, buf->trans);
+        }
+        break;
     }
-    pyResult = PyEval_CallObject(callable, arg);
-    Py_DECREF(arg);
+}
+static int gbuf_attached(int panel){
+    int id;
 
-    if (pyResult != NULL){
-        Py_DECREF(pyResult);
+    for(id = 0; id < nGbufs; id++){
+        if(gbufList[id].kind != 0 && gbufList[id].panel == panel) return 1;
     }
+    return 0;
 }
-static PyObject *s2plot_cs2scb(PyObject *self, PyObject *args){
-    PyObject *result = NULL;
-    PyObject *temp;
-    if (PyArg_ParseTuple(args, "O:cs2scb", &temp)) {
-        if (!PyCallable_Check(temp)) {
-            if(temp == Py_None){
-                cs2scb(NULL);
-                Py_RETURN_NONE;
-            } else {
-                PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-                return NULL;
-            }
+static int gbuf_draw_panel(int panel){
+    // draw the buffers attached to panel; returns how many there are
+    int id, count = 0;
+
+    for(id = 0; id < nGbufs; id++){
+        if(gbufList[id].kind != 0 && gbufList[id].panel == panel){
+            gbuf_draw(&gbufList[id]);
+            count++;
         }
-        
-        // store a reference to the new callback in the global dict:
-        /// the key will be the id of this panel
-        if(pyCallbackDict == NULL){
-            pyCallbackDict = PyDict_New();
-            Py_XINCREF(pyCallbackDict);
+    }
+    return count;
+}
+static PyObject *s2plot_ds2cgb(PyObject *self, PyObject *args){
+    S2PY_GBUF buf, *grown;
+    PyObject *PIn, *colIn;
+    XYZ *P;
+    char *kind, *trans = "o";
+    int n = -1, id;
+
+    memset(&buf, 0, sizeof(S2PY_GBUF));
+    buf.panel = -1;
+    buf.size = 1.;
+    buf.alpha = 1.;
+    if(!PyArg_ParseTuple(args, "sOO|fIfs:ds2cgb", &kind, &PIn, &colIn, &buf.size, &buf.texid, &buf.alpha, &trans) || NULL == PIn || NULL == colIn){
+        return NULL;
+    }
+    if(kind[0] != 'p' && kind[0] != 'l' && kind[0] != 'b'){
+        PyErr_SetString(PyExc_ValueError, "kind must be one of 'p' (points), 'l' (lines) or 'b' (billboards)");
+        return NULL;
+    }
+    buf.kind = kind[0];
+    buf.trans = trans[0];
+
+    if(!(P = List_to_XYZ(PIn, &n, "the list of positions"))){
+        return NULL;
+    }
+    if(buf.kind == 'l' && n % 2 != 0){
+        PyErr_SetString(PyExc_ValueError, "lines need an even number of vertices, two per segment");
+        List_free(PIn, P);
+        return NULL;
+    }
+    buf.n = n;
+    if(n > 0){
+        // the buffer keeps its own copy, so the caller's array may be reused
+        if(!(buf.P = (XYZ *) malloc((size_t) n*sizeof(XYZ)))){
+            List_free(PIn, P);
+            return PyErr_NoMemory();
         }
-        Py_XINCREF(temp);
-        
-        PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-        // decref the current callback if it exists
-        PyObject *currentCallback = PyDict_GetItem(pyCallbackDict, pyKey);
-        if(currentCallback != NULL){
-            Py_XDECREF(currentCallback);
-        }
-        // set the new callback for this pane
-        PyDict_SetItem(pyCallbackDict, pyKey, temp);
-        
-        cs2scb(&cCallBackFunction);
+        memcpy(buf.P, P, (size_t) n*sizeof(XYZ));
+    }
+    List_free(PIn, P);
+    if(!gbuf_set_colours(&buf, colIn)){
+        gbuf_free(&buf);
+        return NULL;
+    }
 
-        Py_INCREF(Py_None); 
-        result = Py_None; 
-    } 
-    return result;
+    // reuse a freed slot if there is one
+    for(id = 0; id < nGbufs && gbufList[id].kind != 0; id++);
+    if(id == nGbufs){
+        if(!(grown = (S2PY_GBUF *) realloc(gbufList, (size_t) (nGbufs + 1)*sizeof(S2PY_GBUF)))){
+            gbuf_free(&buf);
+            return PyErr_NoMemory();
+        }
+        gbufList = grown;
+        nGbufs++;
+    }
+    gbufList[id] = buf;
+
+    return PyInt_FromLong((long) id);
 }
-static PyObject *s2plot_cs2ecb(PyObject *dummy, PyObject *args){
+static PyObject *s2plot_ds2ugb(PyObject *self, PyObject *args){
+    S2PY_GBUF *buf;
+    PyObject *PIn, *colIn = NULL;
+    XYZ *P;
+    int id, n;
 
-    cs2ecb();
+    if(!PyArg_ParseTuple(args, "iO|O:ds2ugb", &id, &PIn, &colIn) || NULL == PIn){
+        return NULL;
+    }
+    if(!(buf = gbuf_lookup(id))){
+        return NULL;
+    }
+    if(PIn != Py_None){
+        n = buf->n;
+        if(!(P = List_to_XYZ(PIn, &n, "the list of positions"))){
+            return NULL;
+        }
+        memcpy(buf->P, P, (size_t) n*sizeof(XYZ));
+        List_free(PIn, P);
+    }
+    if(colIn != NULL && colIn != Py_None && !gbuf_set_colours(buf, colIn)){
+        return NULL;
+    }
 
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_cs2dcb(PyObject *dummy, PyObject *args){
+static PyObject *s2plot_ds2dgb(PyObject *self, PyObject *args){
+    S2PY_GBUF *buf;
+    int id;
 
-    cs2dcb();
+    if(!PyArg_ParseTuple(args, "i:ds2dgb", &id)){
+        return NULL;
+    }
+    if(!(buf = gbuf_lookup(id))){
+        return NULL;
+    }
+    // the GIL is kept so no other thread can update or free the buffer
+    // while it is drawn
+    gbuf_draw(buf);
 
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_cs2tcb(PyObject *dummy, PyObject *args){
+static PyObject *s2plot_ds2agb(PyObject *self, PyObject *args){
+    S2PY_GBUF *buf;
+    int id, on = 1, panel = xs2qsp();
 
-    cs2tcb();
+    if(!PyArg_ParseTuple(args, "i|i:ds2agb", &id, &on)){
+        return NULL;
+    }
+    if(!(buf = gbuf_lookup(id))){
+        return NULL;
+    }
+    if(!on){
+        buf->panel = -1;
+        Py_RETURN_NONE;
+    }
+    if(panel < 0){
+        PyErr_SetString(PyExc_RuntimeError, "no panel is selected");
+        return NULL;
+    }
+    buf->panel = panel;
+    // the frame trampoline draws attached buffers even without a python callback
+    cs2scb(&cCallBackFunction);
 
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *pyKCallbackDict = NULL;
-int    cKCallBackFunction(unsigned char *key){
-    PyObject *argList = NULL;
-    PyObject *currentCallback = NULL;
-    PyObject *result = NULL;
-    PyObject *keyString = NULL;
-    int cResult = 0;
-    
-    // build a unit length string
-    keyString = PyString_FromStringAndSize((const char *)key, 1);
-        
-    // get the callback for the current pane
-    if(pyKCallbackDict == NULL){
-        // cannot set an error - in a callback
-        return 0;
-    }
-    currentCallback = PyDict_GetItem(pyKCallbackDict, PyInt_FromLong((long) xs2qsp()));
-    if(currentCallback == NULL){
-        // cannot set an error - in a callback
-        return 0;
+static PyObject *s2plot_ds2fgb(PyObject *self, PyObject *args){
+    S2PY_GBUF *buf;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ds2fgb", &id)){
+        return NULL;
     }
-    argList = Py_BuildValue("(S)", keyString);
-    result = PyEval_CallObject(currentCallback, argList);
-    Py_DECREF(argList);
-    
-    if (result != NULL){
-        cResult = (int) PyInt_AsLong(result);
-        Py_DECREF(result);
+    if(!(buf = gbuf_lookup(id))){
+        return NULL;
     }
-    
-    return cResult;
+    gbuf_free(buf);
+
+    Py_INCREF(Py_None);
+    return Py_None;
 }
-static PyObject *s2plot_cs2skcb(PyObject *self, PyObject *args){
-    PyObject *result = NULL;
-    PyObject *temp;
-    if (PyArg_ParseTuple(args, "O:cs2skcb", &temp)) {
-        if (!PyCallable_Check(temp)) {
-            if(temp == Py_None){
-                cs2skcb(NULL);
-                Py_RETURN_NONE;
-            } else {
-                PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-                return NULL;
-            }
+// FRAME BUDGET
+// the frame trampoline times the frames of one panel and scales a quality
+// factor in [S2PY_FB_QMIN, 1] to hold the frame period near a target. Once
+// the smoothed period leaves the hysteresis band the factor is scaled by
+// target/period, then held for S2PY_FB_HOLD frames.
+static struct {
+    double target;          // seconds per frame, 0 when off
+    double hysteresis;      // fractional band around target, in [0,1)
+    double quality;
+    double period, work;    // smoothed frame period and callback time
+    double last, pending;   // start of the last frame, callback time so far
+    int panel;              // panel whose frames are timed
+    int hold;               // frames left before the factor may change again
+} frameBudget = {0., 0.1, 1., 0., 0., -1., 0., -1, 0};
+
+static double monotonic_seconds(void){
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + 1e-9*(double) ts.tv_nsec;
+}
+static void frame_budget_tick(double now){
+    // a new frame of the timed panel has started
+    double dt, quality;
+
+    if(frameBudget.last >= 0.){
+        dt = now - frameBudget.last;
+        if(frameBudget.period == 0.){
+            frameBudget.period = dt;
+            frameBudget.work = frameBudget.pending;
+        } else {
+            frameBudget.period += S2PY_FB_SMOOTH*(dt - frameBudget.period);
+            frameBudget.work += S2PY_FB_SMOOTH*(frameBudget.pending - frameBudget.work);
         }
-        
-        // store a reference to the new callback in the global dict:
-        /// the key will be the id of this panel
-        if(pyKCallbackDict == NULL){
-            pyKCallbackDict = PyDict_New();
-            Py_XINCREF(pyKCallbackDict);
+        if(frameBudget.hold > 0){
+            frameBudget.hold--;
+        } else if(frameBudget.target > 0. && frameBudget.period > 0. &&
+                  (frameBudget.period > frameBudget.target*(1. + frameBudget.hysteresis) ||
+                   (frameBudget.period < frameBudget.target*(1. - frameBudget.hysteresis) && frameBudget.quality < 1.))){
+            quality = frameBudget.quality*frameBudget.target/frameBudget.period;
+            if(quality < S2PY_FB_QMIN) quality = S2PY_FB_QMIN;
+            if(quality > 1.) quality = 1.;
+            if(quality != frameBudget.quality){
+                frameBudget.quality = quality;
+                frameBudget.hold = S2PY_FB_HOLD;
+            }
         }
-        Py_XINCREF(temp);
-        
-        PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-        // decref the current callback if it exists
-        PyObject *currentCallback = PyDict_GetItem(pyKCallbackDict, pyKey);
-        if(currentCallback != NULL){
-            Py_XDECREF(currentCallback);
-        }
-        // set the new callback for this pane
-        PyDict_SetItem(pyKCallbackDict, pyKey, temp);
-        
-        cs2skcb(&cKCallBackFunction);
-        
-        Py_INCREF(Py_None); 
-        result = Py_None; 
-    } 
-    return result;
+    }
+    frameBudget.last = now;
+    frameBudget.pending = 0.;
 }
-static PyObject *pyNCallbackDict = NULL;
-void   cNCallBackFunction(int *N){
-    PyObject *argList;
-    PyObject *currentCallback;
-    PyObject *result;
-    
-    if(pyNCallbackDict == NULL){
-        // cannot set an error - in a callback
-        return;
+static PyObject *s2plot_ss2sfb(PyObject *self, PyObject *args){
+    float fps, hysteresis = 0.1;
+
+    if(!PyArg_ParseTuple(args, "f|f:ss2sfb", &fps, &hysteresis)){
+        return NULL;
     }
-    currentCallback = PyDict_GetItem(pyNCallbackDict, PyInt_FromLong((long) xs2qsp()));
-    if(currentCallback == NULL){
-        // cannot set an error - in a callback
-        return;
+    if(fps > 0. && (hysteresis < 0. || hysteresis >= 1.)){
+        PyErr_SetString(PyExc_ValueError, "hysteresis must lie in [0,1)");
+        return NULL;
     }
-    argList = Py_BuildValue("(i)", *N);
-    result = PyEval_CallObject(currentCallback, argList);
-    Py_DECREF(argList);
-    
-    if (result != NULL){
-        Py_DECREF(result);
+    frameBudget.quality = 1.;
+    frameBudget.period = frameBudget.work = 0.;
+    frameBudget.last = -1.;
+    frameBudget.hold = 0;
+    if(fps <= 0.){
+        frameBudget.target = 0.;
+        Py_RETURN_NONE;
     }
-}
-static PyObject *s2plot_cs2sncb(PyObject *self, PyObject *args){
-    
-    PyObject *result = NULL;
-    PyObject *temp;
-    if (PyArg_ParseTuple(args, "O:cs2sncb", &temp)) {
-        if (!PyCallable_Check(temp)) {
-            if(temp == Py_None){
-                cs2sncb(NULL);
-                Py_RETURN_NONE;
-            } else {
-                PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-                return NULL;
-            }
-        }
-        
-        // store a reference to the new callback in the global dict:
-        /// the key will be the id of this panel
-        if(pyNCallbackDict == NULL){
-            pyNCallbackDict = PyDict_New();
-            Py_XINCREF(pyNCallbackDict);
-        }
-        Py_XINCREF(temp);
-        
-        PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-        PyObject *currentCallback = PyDict_GetItem(pyNCallbackDict, pyKey);
-        if(currentCallback != NULL){
-            Py_XDECREF(currentCallback);
-        }
-        
-        PyDict_SetItem(pyNCallbackDict, pyKey, temp);
-        
-        cs2sncb(&cNCallBackFunction);
-        
-        Py_INCREF(Py_None); 
-        result = Py_None; 
-    } 
-    return result;
-}
-static PyObject *s2plot_ds2ah(PyObject *self, PyObject *args){
-    PyObject *_iP, *_icol, *_ihilite;
-    float size;
-    XYZ iP;
-    COLOUR icol, ihilite;
-    unsigned int iid;
-    int iselected;
-
-    if(!PyArg_ParseTuple(args,"OfOOIi:ds2ah",&_iP, &size, &_icol,&_ihilite,&iid, &iselected) || NULL == _iP || NULL == _icol || NULL == _ihilite){
+    if((frameBudget.panel = xs2qsp()) < 0){
+        PyErr_SetString(PyExc_RuntimeError, "no panel is selected");
         return NULL;
     }
+    frameBudget.target = 1./fps;
+    frameBudget.hysteresis = hysteresis;
+    // frames are timed by the trampoline, which needs no python callback
+    cs2scb(&cCallBackFunction);
 
-    // unpack lists into structs; XYZ struct...
-    iP = Dict_to_XYZ(_iP);
-    // COLOUR structs...
-    icol = Dict_to_COLOUR(_icol);
-    ihilite = Dict_to_COLOUR(_ihilite);
-    
-    ds2ah(iP, size, icol, ihilite, iid, iselected);
-    
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *pyHCallbackDict = NULL;
-void   cHCallBackFunction(int *id){
-    PyObject *argList;
-    PyObject * currentCallback;
-    PyObject *result;
-    
-    if(pyHCallbackDict == NULL){
-        // cannot set an error - in a callback
-        return;
+static PyObject *s2plot_ss2qfq(PyObject *self, PyObject *args){
+
+    return Py_BuildValue("(ddd)", frameBudget.quality, frameBudget.period*1000., frameBudget.work*1000.);
+}
+// POINT CLOUD LEVEL OF DETAIL
+// the points are sorted along a Morton curve so that every octree node owns
+// a contiguous run of them. Leaves (at most S2PY_PC_SAMPLE points) draw their
+// run; inner nodes draw an evenly spread sample of an eighth of their run, up
+// to S2PY_PC_SAMPLE points, kept separately. Each frame the octree is refined
+// from the root, largest angular size first, until the point budget or the
+// error tolerance is met.
+typedef struct {
+    int start, count;       // run of sorted points
+    int sample;             // start of the node's sample, or -1 for a leaf
+    int nsample;            // points drawn for the node (its run for a leaf)
+    int child[8];           // node indices, -1 where empty
+    XYZ centre;
+    float size;             // edge length of the node's cube
+} S2PY_PCNODE;
+typedef struct {
+    int n, nnodes, nsamples;
+    XYZ *P, *samplesP;      // points in Morton order, and inner node samples
+    COLOUR *cols, *samplesC;// matching colours, or NULL to use col
+    COLOUR col;
+    S2PY_PCNODE *nodes;
+    int budget;             // most points drawn per frame at full quality
+    float tolerance;        // nodes smaller than this (radians) are not refined
+    int panel;              // panel it is redrawn in automatically, or -1
+    int *heap, *drawn;      // per-frame work space, nnodes each
+    float *error;
+} S2PY_PCLOUD;
+static S2PY_PCLOUD *pcloudList = NULL;
+static int nPclouds = 0;
+
+static S2PY_PCLOUD *pcloud_lookup(int id){
+    if(id < 0 || id >= nPclouds || pcloudList[id].nodes == NULL){
+        PyErr_Format(PyExc_IndexError, "no point cloud with id %d", id);
+        return NULL;
+    }
+    return &pcloudList[id];
+}
+static void pcloud_free(S2PY_PCLOUD *pc){
+    free(pc->P);
+    free(pc->cols);
+    free(pc->samplesP);
+    free(pc->samplesC);
+    free(pc->nodes);
+    free(pc->heap);
+    free(pc->drawn);
+    free(pc->error);
+    memset(pc, 0, sizeof(S2PY_PCLOUD));
+    pc->panel = -1;
+}
+static unsigned int morton_spread(unsigned int v){
+    // 10 bits spread out to every third bit
+    v &= 0x3FF;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v <<  8)) & 0x0300F00F;
+    v = (v | (v <<  4)) & 0x030C30C3;
+    v = (v | (v <<  2)) & 0x09249249;
+    return v;
+}
+static int pcloud_node(S2PY_PCLOUD *pc, const unsigned int *code, int lo, int hi, int level, XYZ corner, float size, int *cap){
+    // add the node for sorted points [lo,hi) and its descendants; returns
+    // its index or -1 if out of memory
+    S2PY_PCNODE *node, *grown;
+    XYZ c;
+    int id, k, a, b, m, mid, shift = 3*(S2PY_PC_LEVELS - 1 - level), child;
+    unsigned int octant;
+
+    if(pc->nnodes == *cap){
+        if(!(grown = (S2PY_PCNODE *) realloc(pc->nodes, (size_t) 2*(*cap)*sizeof(S2PY_PCNODE)))){
+            return -1;
+        }
+        pc->nodes = grown;
+        *cap *= 2;
+    }
+    id = pc->nnodes++;
+    node = &pc->nodes[id];
+    node->start = lo;
+    node->count = hi - lo;
+    node->size = size;
+    node->centre.x = corner.x + 0.5*size;
+    node->centre.y = corner.y + 0.5*size;
+    node->centre.z = corner.z + 0.5*size;
+    for(k = 0; k < 8; k++) node->child[k] = -1;
+    if(hi - lo <= S2PY_PC_SAMPLE || level == S2PY_PC_LEVELS){
+        node->sample = -1;
+        node->nsample = hi - lo;
+        return id;
+    }
+    node->sample = pc->nsamples;
+    node->nsample = (hi - lo)/8 < S2PY_PC_SAMPLE ? (hi - lo)/8 : S2PY_PC_SAMPLE;
+    pc->nsamples += node->nsample;
+
+    // the children's runs follow one another in octant order
+    for(a = lo, k = 0; k < 8; k++){
+        for(b = a, m = hi; b < m; ){
+            mid = b + (m - b)/2;
+            octant = (code[mid] >> shift) & 7;
+            if(octant <= (unsigned int) k) b = mid + 1;
+            else                           m = mid;
+        }
+        if(b > a){
+            c.x = corner.x + ((k & 4) ? 0.5*size : 0.);
+            c.y = corner.y + ((k & 2) ? 0.5*size : 0.);
+            c.z = corner.z + ((k & 1) ? 0.5*size : 0.);
+            if((child = pcloud_node(pc, code, a, b, level + 1, c, 0.5*size, cap)) < 0){
+                return -1;
+            }
+            pc->nodes[id].child[k] = child;
+        }
+        a = b;
     }
-    currentCallback = PyDict_GetItem(pyHCallbackDict, PyInt_FromLong((long) xs2qsp()));
-    if(currentCallback == NULL){
-        // cannot set an error - in a callback
-        return;
+    return id;
+}
+typedef struct {
+    XYZ P;
+    COLOUR col;
+} S2PY_PCPOINT;
+static int colour_equal(COLOUR a, COLOUR b){
+    return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+static int pcpoint_compare(const void *a, const void *b){
+    const COLOUR *u = &((const S2PY_PCPOINT *) a)->col, *v = &((const S2PY_PCPOINT *) b)->col;
+    if(u->r != v->r) return u->r < v->r ? -1 : 1;
+    if(u->g != v->g) return u->g < v->g ? -1 : 1;
+    if(u->b != v->b) return u->b < v->b ? -1 : 1;
+    return 0;
+}
+static int pcloud_sort_colours(XYZ *P, COLOUR *cols, int n){
+    // order n points by colour, so that equal colours are drawn together
+    S2PY_PCPOINT *tmp;
+    int k;
+
+    if(n < 2) return 1;
+    if(!(tmp = (S2PY_PCPOINT *) malloc((size_t) n*sizeof(S2PY_PCPOINT)))) return 0;
+    for(k = 0; k < n; k++){
+        tmp[k].P = P[k];
+        tmp[k].col = cols[k];
+    }
+    qsort(tmp, (size_t) n, sizeof(S2PY_PCPOINT), pcpoint_compare);
+    for(k = 0; k < n; k++){
+        P[k] = tmp[k].P;
+        cols[k] = tmp[k].col;
+    }
+    free(tmp);
+    return 1;
+}
+static int pcloud_build(S2PY_PCLOUD *pc, const XYZ *P, const COLOUR *cols){
+    // sort copies of P (and cols) into Morton order and build the octree
+    XYZ lo, hi;
+    unsigned int *code, *perm;
+    float side, scale, x0, y0, z0, x1, y1, z1;
+    int i, k, cap = 64, ok;
+
+    x0 = x1 = P[0].x;
+    y0 = y1 = P[0].y;
+    z0 = z1 = P[0].z;
+    #pragma omp parallel for reduction(min:x0,y0,z0) reduction(max:x1,y1,z1) schedule(static) if(pc->n >= S2PY_OMP_THRESHOLD)
+    for(i = 1; i < pc->n; i++){
+        if(P[i].x < x0) x0 = P[i].x;
+        if(P[i].x > x1) x1 = P[i].x;
+        if(P[i].y < y0) y0 = P[i].y;
+        if(P[i].y > y1) y1 = P[i].y;
+        if(P[i].z < z0) z0 = P[i].z;
+        if(P[i].z > z1) z1 = P[i].z;
+    }
+    lo.x = x0; lo.y = y0; lo.z = z0;
+    hi.x = x1; hi.y = y1; hi.z = z1;
+    side = hi.x - lo.x;
+    if(hi.y - lo.y > side) side = hi.y - lo.y;
+    if(hi.z - lo.z > side) side = hi.z - lo.z;
+    if(side <= 0.) side = 1.;
+    scale = (float) (1 << S2PY_PC_LEVELS)/side;
+
+    code = (unsigned int *) malloc((size_t) pc->n*sizeof(unsigned int));
+    perm = (unsigned int *) malloc((size_t) pc->n*sizeof(unsigned int));
+    pc->P = (XYZ *) malloc((size_t) pc->n*sizeof(XYZ));
+    if(cols) pc->cols = (COLOUR *) malloc((size_t) pc->n*sizeof(COLOUR));
+    pc->nodes = (S2PY_PCNODE *) malloc((size_t) cap*sizeof(S2PY_PCNODE));
+    if(!code || !perm || !pc->P || (cols && !pc->cols) || !pc->nodes){
+        free(code);
+        free(perm);
+        return 0;
     }
-    argList = Py_BuildValue("(i)", *id);
-    result = PyEval_CallObject(currentCallback, argList);
-    Py_DECREF(argList);
-    
-    if (result != NULL){
-        Py_DECREF(result);
+    #pragma omp parallel for private(k) schedule(static) if(pc->n >= S2PY_OMP_THRESHOLD)
+    for(i = 0; i < pc->n; i++){
+        unsigned int q[3];
+        float f[3] = {(P[i].x - lo.x)*scale, (P[i].y - lo.y)*scale, (P[i].z - lo.z)*scale};
+        for(k = 0; k < 3; k++){
+            q[k] = f[k] >= (float) ((1 << S2PY_PC_LEVELS) - 1) ? (1 << S2PY_PC_LEVELS) - 1 : (unsigned int) f[k];
+        }
+        code[i] = (morton_spread(q[0]) << 2) | (morton_spread(q[1]) << 1) | morton_spread(q[2]);
+        perm[i] = (unsigned int) i;
+    }
+    ok = radix_sort(code, perm, pc->n);
+    if(ok){
+        #pragma omp parallel for schedule(static) if(pc->n >= S2PY_OMP_THRESHOLD)
+        for(i = 0; i < pc->n; i++){
+            pc->P[i] = P[perm[i]];
+            if(cols) pc->cols[i] = cols[perm[i]];
+        }
+        pc->nnodes = pc->nsamples = 0;
+        ok = pcloud_node(pc, code, 0, pc->n, 0, lo, side, &cap) == 0;
+    }
+    free(code);
+    free(perm);
+    if(!ok) return 0;
+
+    pc->samplesP = (XYZ *) malloc((size_t) (pc->nsamples ? pc->nsamples : 1)*sizeof(XYZ));
+    if(cols) pc->samplesC = (COLOUR *) malloc((size_t) (pc->nsamples ? pc->nsamples : 1)*sizeof(COLOUR));
+    pc->heap = (int *) malloc((size_t) pc->nnodes*sizeof(int));
+    pc->drawn = (int *) malloc((size_t) pc->nnodes*sizeof(int));
+    pc->error = (float *) malloc((size_t) pc->nnodes*sizeof(float));
+    if(!pc->samplesP || (cols && !pc->samplesC) || !pc->heap || !pc->drawn || !pc->error){
+        return 0;
     }
-}
-static PyObject *s2plot_cs2shcb(PyObject *self, PyObject *args){
-    
-    PyObject *result = NULL;
-    PyObject *temp;
-    if (PyArg_ParseTuple(args, "O:cs2shcb", &temp)) {
-        if (!PyCallable_Check(temp)) {
-            if(temp == Py_None){
-                cs2shcb(NULL);
-                Py_RETURN_NONE;
-            } else {
-                PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-                return NULL;
+    // a stride through a node's Morton run spreads its sample over the node
+    #pragma omp parallel for private(k) schedule(dynamic) if(pc->n >= S2PY_OMP_THRESHOLD)
+    for(i = 0; i < pc->nnodes; i++){
+        S2PY_PCNODE *node = &pc->nodes[i];
+        int j;
+        if(node->sample < 0) continue;
+        for(k = 0; k < node->nsample; k++){
+            j = node->start + (int) ((long long) k*node->count/node->nsample);
+            pc->samplesP[node->sample + k] = pc->P[j];
+            if(cols) pc->samplesC[node->sample + k] = pc->cols[j];
+        }
+    }
+    if(!cols) return 1;
+    // the order within a leaf's run or a sample is free once the samples are
+    // taken; sorting them by colour lets a draw batch equal colours
+    ok = 1;
+    #pragma omp parallel for reduction(&&:ok) schedule(dynamic) if(pc->n >= S2PY_OMP_THRESHOLD)
+    for(i = 0; i < pc->nnodes; i++){
+        S2PY_PCNODE *node = &pc->nodes[i];
+        if(node->sample < 0){
+            ok = pcloud_sort_colours(pc->P + node->start, pc->cols + node->start, node->count) && ok;
+        } else {
+            ok = pcloud_sort_colours(pc->samplesP + node->sample, pc->samplesC + node->sample, node->nsample) && ok;
+        }
+    }
+    return ok;
+}
+typedef struct {
+    XYZ eye, vdir, right, up;   // orthonormal camera frame
+    float tx, ty;               // tangents of the half apertures, 0 to skip the sides
+    float sx, sy;               // sphere radius to side plane offset, sqrt(1 + t^2)
+} S2PY_PCVIEW;
+static void pcloud_view(S2PY_PCVIEW *v){
+    // the current camera as seen from world coordinates. Side planes are
+    // only tested for a perspective projection.
+    XYZ up;
+    float len, dot, ap;
+
+    ss2qc(&v->eye, &up, &v->vdir, 1);
+    len = sqrtf(v->vdir.x*v->vdir.x + v->vdir.y*v->vdir.y + v->vdir.z*v->vdir.z);
+    if(len > 0.){
+        v->vdir.x /= len; v->vdir.y /= len; v->vdir.z /= len;
+    }
+    dot = up.x*v->vdir.x + up.y*v->vdir.y + up.z*v->vdir.z;
+    v->up.x = up.x - dot*v->vdir.x;
+    v->up.y = up.y - dot*v->vdir.y;
+    v->up.z = up.z - dot*v->vdir.z;
+    len = sqrtf(v->up.x*v->up.x + v->up.y*v->up.y + v->up.z*v->up.z);
+    ap = ss2qca();
+    v->tx = v->ty = 0.;
+    if(len > 0. && ss2qpt() == 0 && ap > 0. && ap < 180.){
+        v->up.x /= len; v->up.y /= len; v->up.z /= len;
+        v->right.x = v->vdir.y*v->up.z - v->vdir.z*v->up.y;
+        v->right.y = v->vdir.z*v->up.x - v->vdir.x*v->up.z;
+        v->right.z = v->vdir.x*v->up.y - v->vdir.y*v->up.x;
+        // the aperture is the full vertical angle of the view
+        v->ty = tanf(0.5*ap*0.017453293);
+        v->tx = v->ty*ss2qar();
+    }
+    v->sx = sqrtf(1. + v->tx*v->tx);
+    v->sy = sqrtf(1. + v->ty*v->ty);
+}
+static int pcloud_visible(S2PY_PCNODE *node, const S2PY_PCVIEW *v, float *error){
+    // the node's angular size from the eye, or 0 if its bounding sphere lies
+    // wholly behind the eye or outside a side of the view frustum
+    float dx = node->centre.x - v->eye.x, dy = node->centre.y - v->eye.y, dz = node->centre.z - v->eye.z;
+    float radius = 0.8660254*node->size, dist, x, y;
+
+    dist = dx*v->vdir.x + dy*v->vdir.y + dz*v->vdir.z;
+    if(dist < -radius) return 0;
+    if(v->tx > 0.){
+        x = dx*v->right.x + dy*v->right.y + dz*v->right.z;
+        y = dx*v->up.x + dy*v->up.y + dz*v->up.z;
+        if(fabsf(x) > dist*v->tx + radius*v->sx) return 0;
+        if(fabsf(y) > dist*v->ty + radius*v->sy) return 0;
+    }
+    dist = sqrtf(dx*dx + dy*dy + dz*dz) - radius;
+    *error = dist > 1e-6*node->size ? node->size/dist : 1e6;
+    return 1;
+}
+static void pcloud_heap_push(S2PY_PCLOUD *pc, int *nheap, int id){
+    int i = (*nheap)++, parent;
+
+    while(i > 0 && pc->error[pc->heap[parent = (i - 1)/2]] < pc->error[id]){
+        pc->heap[i] = pc->heap[parent];
+        i = parent;
+    }
+    pc->heap[i] = id;
+}
+static int pcloud_heap_pop(S2PY_PCLOUD *pc, int *nheap){
+    int top = pc->heap[0], last = pc->heap[--(*nheap)], i = 0, c;
+
+    while((c = 2*i + 1) < *nheap){
+        if(c + 1 < *nheap && pc->error[pc->heap[c+1]] > pc->error[pc->heap[c]]) c++;
+        if(pc->error[pc->heap[c]] <= pc->error[last]) break;
+        pc->heap[i] = pc->heap[c];
+        i = c;
+    }
+    pc->heap[i] = last;
+    return top;
+}
+static int pcloud_draw(S2PY_PCLOUD *pc){
+    // select and draw the nodes for the current camera; returns the number
+    // of points drawn. Needs no python objects.
+    S2PY_PCVIEW view;
+    XYZ *pts;
+    COLOUR *cols;
+    S2PY_PCNODE *node;
+    int nheap = 0, ndrawn = 0, total = 0, cost, id, i, k, a, n, drawn = 0;
+    float error;
+    int budget = (int) (pc->budget*frameBudget.quality);
+
+    pcloud_view(&view);
+    // drawn[] lists every visible node reached; a refined node is flagged by
+    // a negative error, which is no longer needed once it leaves the heap
+    if(pcloud_visible(&pc->nodes[0], &view, &pc->error[0])){
+        pc->drawn[ndrawn++] = 0;
+        total = pc->nodes[0].nsample;
+        if(pc->nodes[0].sample >= 0) pcloud_heap_push(pc, &nheap, 0);
+    }
+    while(nheap > 0){
+        id = pcloud_heap_pop(pc, &nheap);
+        if(pc->error[id] < pc->tolerance) break;
+        node = &pc->nodes[id];
+        for(cost = -node->nsample, k = 0; k < 8; k++){
+            if(node->child[k] >= 0 && pcloud_visible(&pc->nodes[node->child[k]], &view, &error)){
+                cost += pc->nodes[node->child[k]].nsample;
             }
         }
-        
-        // store a reference to the new callback in the global dict:
-        // the key will be the id of this panel
-        if(pyHCallbackDict == NULL){
-            pyHCallbackDict = PyDict_New();
-            Py_XINCREF(pyHCallbackDict);
+        // a smaller node further down the heap may still fit
+        if(total + cost > budget) continue;
+        total += cost;
+        pc->error[id] = -1.;
+        for(k = 0; k < 8; k++){
+            if(node->child[k] >= 0 && pcloud_visible(&pc->nodes[node->child[k]], &view, &pc->error[node->child[k]])){
+                pc->drawn[ndrawn++] = node->child[k];
+                if(pc->nodes[node->child[k]].sample >= 0) pcloud_heap_push(pc, &nheap, node->child[k]);
+            }
         }
-        Py_XINCREF(temp);
-        
-        PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-        PyObject *currentCallback = PyDict_GetItem(pyHCallbackDict, pyKey);
-        if(currentCallback != NULL){
-            Py_XDECREF(currentCallback);
+    }
+    for(i = 0; i < ndrawn; i++){
+        if(pc->error[pc->drawn[i]] < 0.) continue;
+        node = &pc->nodes[pc->drawn[i]];
+        n = node->nsample;
+        if(node->sample < 0){
+            pts = pc->P + node->start;
+            cols = pc->cols ? pc->cols + node->start : NULL;
+        } else {
+            pts = pc->samplesP + node->sample;
+            cols = pc->samplesC ? pc->samplesC + node->sample : NULL;
         }
-        
-        PyDict_SetItem(pyHCallbackDict, pyKey, temp);
-        
-        cs2shcb(&cHCallBackFunction);
+        if(cols == NULL){
+            ns2vnpoint(pts, pc->col, n);
+        } else {
+            // runs are sorted by colour, so each colour is one call
+            for(a = 0; a < n; a = k){
+                for(k = a + 1; k < n && colour_equal(cols[k], cols[a]); k++);
+                ns2vnpoint(pts + a, cols[a], k - a);
+            }
+        }
+        drawn += n;
+    }
+    return drawn;
+}
+static PyObject *s2plot_ds2cpc(PyObject *self, PyObject *args){
+    S2PY_PCLOUD pc, *grown;
+    PyObject *PIn, *colIn;
+    XYZ *P;
+    COLOUR *cols = NULL;
+    int n = -1, m, id, ok;
 
-        Py_INCREF(Py_None); 
-        result = Py_None; 
-    } 
-    return result;
+    memset(&pc, 0, sizeof(S2PY_PCLOUD));
+    pc.panel = -1;
+    pc.budget = 1000000;
+    pc.tolerance = 0.;
+    if(!PyArg_ParseTuple(args, "OO|if:ds2cpc", &PIn, &colIn, &pc.budget, &pc.tolerance) || NULL == PIn || NULL == colIn){
+        return NULL;
+    }
+    if(!(P = List_to_XYZ(PIn, &n, "the list of positions"))){
+        return NULL;
+    }
+    if(n == 0){
+        PyErr_SetString(PyExc_ValueError, "a point cloud needs at least one point");
+        List_free(PIn, P);
+        return NULL;
+    }
+    if(PyDict_Check(colIn)){
+        pc.col = Dict_to_COLOUR(colIn);
+    } else {
+        m = n;
+        if(!(cols = List_to_COLOUR(colIn, &m, "the list of colours"))){
+            List_free(PIn, P);
+            return NULL;
+        }
+    }
+    pc.n = n;
+
+    Py_BEGIN_ALLOW_THREADS
+    ok = pcloud_build(&pc, P, cols);
+    Py_END_ALLOW_THREADS
+
+    List_free(PIn, P);
+    if(cols) List_free(colIn, cols);
+    if(!ok){
+        pcloud_free(&pc);
+        return PyErr_NoMemory();
+    }
+
+    // reuse a freed slot if there is one
+    for(id = 0; id < nPclouds && pcloudList[id].nodes != NULL; id++);
+    if(id == nPclouds){
+        if(!(grown = (S2PY_PCLOUD *) realloc(pcloudList, (size_t) (nPclouds + 1)*sizeof(S2PY_PCLOUD)))){
+            pcloud_free(&pc);
+            return PyErr_NoMemory();
+        }
+        pcloudList = grown;
+        nPclouds++;
+    }
+    pcloudList[id] = pc;
+
+    return PyInt_FromLong((long) id);
 }
-static PyObject *s2plot_cs2th(PyObject *self, PyObject *args){
-    unsigned int iid;
+static PyObject *s2plot_ds2spc(PyObject *self, PyObject *args){
+    S2PY_PCLOUD *pc;
+    int id, budget;
+    float tolerance = 0.;
 
-    if(!PyArg_ParseTuple(args,"I:cs2th",&iid)){
+    if(!PyArg_ParseTuple(args, "ii|f:ds2spc", &id, &budget, &tolerance)){
         return NULL;
     }
-    
-    cs2th(iid);
-    
+    if(!(pc = pcloud_lookup(id))){
+        return NULL;
+    }
+    pc->budget = budget;
+    pc->tolerance = tolerance;
+
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_cs2qhv(PyObject *self, PyObject *args){
-    PyObject *result;
-
-    result = Py_BuildValue("i:cs2qhv",cs2qhv());
+static PyObject *s2plot_ds2dpc(PyObject *self, PyObject *args){
+    S2PY_PCLOUD *pc;
+    int id, drawn;
 
-    Py_INCREF(result);
+    if(!PyArg_ParseTuple(args, "i:ds2dpc", &id)){
+        return NULL;
+    }
+    if(!(pc = pcloud_lookup(id))){
+        return NULL;
+    }
+    // the GIL is kept so no other thread can free the cloud while it is drawn
+    drawn = pcloud_draw(pc);
+
+    return PyInt_FromLong((long) drawn);
+}
+static PyObject *s2plot_ds2apc(PyObject *self, PyObject *args){
+    S2PY_PCLOUD *pc;
+    int id, on = 1, panel = xs2qsp();
+
+    if(!PyArg_ParseTuple(args, "i|i:ds2apc", &id, &on)){
+        return NULL;
+    }
+    if(!(pc = pcloud_lookup(id))){
+        return NULL;
+    }
+    if(!on){
+        pc->panel = -1;
+        Py_RETURN_NONE;
+    }
+    if(panel < 0){
+        PyErr_SetString(PyExc_RuntimeError, "no panel is selected");
+        return NULL;
+    }
+    pc->panel = panel;
+    cs2scb(&cCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ds2fpc(PyObject *self, PyObject *args){
+    S2PY_PCLOUD *pc;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ds2fpc", &id)){
+        return NULL;
+    }
+    if(!(pc = pcloud_lookup(id))){
+        return NULL;
+    }
+    pcloud_free(pc);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static int retained_attached(int panel){
+    // whether any geometry buffer or point cloud is redrawn in panel, or its
+    // frames are timed for ss2sfb
+    int id;
+
+    if(frameBudget.target > 0. && frameBudget.panel == panel) return 1;
+
+    for(id = 0; id < nPclouds; id++){
+        if(pcloudList[id].nodes != NULL && pcloudList[id].panel == panel) return 1;
+    }
+    return gbuf_attached(panel);
+}
+static void retained_draw_panel(int panel){
+    int id;
+
+    gbuf_draw_panel(panel);
+    for(id = 0; id < nPclouds; id++){
+        if(pcloudList[id].nodes != NULL && pcloudList[id].panel == panel) pcloud_draw(&pcloudList[id]);
+    }
+}
+// CALLBACK AND HANDLE SYSTEM
+// python callbacks are kept per panel, in a table indexed directly by the
+// s2plot panel id so that dispatching one creates no python objects
+enum {S2PY_CB_FRAME, S2PY_CB_KEY, S2PY_CB_NUMBER, S2PY_CB_HANDLE, S2PY_CB_DRAGHANDLE, S2PY_CB_PROMPT, S2PY_CB_KINDS};
+typedef struct {
+    PyObject *callable;     // strong references; callable is NULL when unset
+    PyObject *data;         // NULL if no data argument is passed on
+} S2PY_CALLBACK;
+static S2PY_CALLBACK (*panelCallbacks)[S2PY_CB_KINDS] = NULL;
+static int nCallbackPanels = 0;
+
+static S2PY_CALLBACK *panel_callback(int kind){
+    // the callback of the given kind for the current panel, or NULL
+    int panel = xs2qsp();
+
+    if(panel < 0 || panel >= nCallbackPanels || panelCallbacks[panel][kind].callable == NULL){
+        return NULL;
+    }
+    return &panelCallbacks[panel][kind];
+}
+static int panel_callback_set(int kind, PyObject *callable, PyObject *data){
+    // replace the current panel's callback of the given kind; callable may
+    // be NULL to clear it, data may be NULL or None for no data argument
+    S2PY_CALLBACK (*grown)[S2PY_CB_KINDS], old;
+    int panel = xs2qsp();
+
+    if(panel < 0){
+        PyErr_SetString(PyExc_RuntimeError, "no panel is selected");
+        return 0;
+    }
+    if(panel >= nCallbackPanels){
+        if(callable == NULL) return 1;
+        grown = realloc(panelCallbacks, (size_t) (panel + 1)*sizeof(*panelCallbacks));
+        if(grown == NULL){
+            PyErr_NoMemory();
+            return 0;
+        }
+        memset(grown + nCallbackPanels, 0, (size_t) (panel + 1 - nCallbackPanels)*sizeof(*grown));
+        panelCallbacks = grown;
+        nCallbackPanels = panel + 1;
+    }
+    if(data == Py_None || callable == NULL) data = NULL;
+    Py_XINCREF(callable);
+    Py_XINCREF(data);
+    old = panelCallbacks[panel][kind];
+    panelCallbacks[panel][kind].callable = callable;
+    panelCallbacks[panel][kind].data = data;
+    Py_XDECREF(old.callable);
+    Py_XDECREF(old.data);
+    return 1;
+}
+void   cCallBackFunction(double *time, int *keycount){
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    S2PY_CALLBACK *cb;
+    PyObject *arg, *pyResult;
+    double start = monotonic_seconds();
+    int panel = xs2qsp();
+
+    if(panel == frameBudget.panel) frame_budget_tick(start);
+    // background isosurface builds are swapped in between frames
+    jobs_collect();
+    // retained geometry goes first so the python callback can draw over it
+    retained_draw_panel(panel);
+    if((cb = panel_callback(S2PY_CB_FRAME)) == NULL){
+        // cannot set exception - in callback
+        if(panel == frameBudget.panel) frameBudget.pending += monotonic_seconds() - start;
+        PyGILState_Release(gstate);
+        return;
+    }
+    if(cb->data == NULL){
+        arg = Py_BuildValue("di", *time, *keycount);
+    } else {
+        arg = Py_BuildValue("diO", *time, *keycount, cb->data);
+    }
+    pyResult = PyEval_CallObject(cb->callable, arg);
+    Py_DECREF(arg);
+
+    if (pyResult != NULL){
+        Py_DECREF(pyResult);
+    }
+
+    if(panel == frameBudget.panel) frameBudget.pending += monotonic_seconds() - start;
+    PyGILState_Release(gstate);
+}
+static PyObject *s2plot_cs2scb(PyObject *self, PyObject *args){
+    PyObject *temp;
+
+    if(!PyArg_ParseTuple(args, "O:cs2scb", &temp)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        // keep the trampoline while retained geometry is attached to the panel
+        if(!retained_attached(xs2qsp())) cs2scb(NULL);
+        panel_callback_set(S2PY_CB_FRAME, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // keep the callback for this panel
+    if(!panel_callback_set(S2PY_CB_FRAME, temp, NULL)){
+        return NULL;
+    }
+    cs2scb(&cCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_cs2ecb(PyObject *dummy, PyObject *args){
+
+    cs2ecb();
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_cs2dcb(PyObject *dummy, PyObject *args){
+
+    cs2dcb();
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_cs2tcb(PyObject *dummy, PyObject *args){
+
+    cs2tcb();
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+int    cKCallBackFunction(unsigned char *key){
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    S2PY_CALLBACK *cb;
+    PyObject *argList, *result;
+    int cResult = 0;
+
+    if((cb = panel_callback(S2PY_CB_KEY)) == NULL){
+        // cannot set an error - in a callback
+        PyGILState_Release(gstate);
+        return 0;
+    }
+    // the key is passed as a unit length string
+    argList = Py_BuildValue("(s#)", (const char *) key, 1);
+    result = PyEval_CallObject(cb->callable, argList);
+    Py_DECREF(argList);
+    
+    if (result != NULL){
+        cResult = (int) PyInt_AsLong(result);
+        Py_DECREF(result);
+    }
+    
+    PyGILState_Release(gstate);
+    return cResult;
+}
+static PyObject *s2plot_cs2skcb(PyObject *self, PyObject *args){
+    PyObject *temp;
+
+    if(!PyArg_ParseTuple(args, "O:cs2skcb", &temp)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        cs2skcb(NULL);
+        panel_callback_set(S2PY_CB_KEY, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // keep the callback for this panel
+    if(!panel_callback_set(S2PY_CB_KEY, temp, NULL)){
+        return NULL;
+    }
+    cs2skcb(&cKCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+void   cNCallBackFunction(int *N){
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    S2PY_CALLBACK *cb;
+    PyObject *argList, *result;
+    
+    if((cb = panel_callback(S2PY_CB_NUMBER)) == NULL){
+        // cannot set an error - in a callback
+        PyGILState_Release(gstate);
+        return;
+    }
+    argList = Py_BuildValue("(i)", *N);
+    result = PyEval_CallObject(cb->callable, argList);
+    Py_DECREF(argList);
+    
+    if (result != NULL){
+        Py_DECREF(result);
+    }
+
+    PyGILState_Release(gstate);
+}
+static PyObject *s2plot_cs2sncb(PyObject *self, PyObject *args){
+    PyObject *temp;
+
+    if(!PyArg_ParseTuple(args, "O:cs2sncb", &temp)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        cs2sncb(NULL);
+        panel_callback_set(S2PY_CB_NUMBER, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // keep the callback for this panel
+    if(!panel_callback_set(S2PY_CB_NUMBER, temp, NULL)){
+        return NULL;
+    }
+    cs2sncb(&cNCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ds2ah(PyObject *self, PyObject *args){
+    PyObject *_iP, *_icol, *_ihilite;
+    float size;
+    XYZ iP;
+    COLOUR icol, ihilite;
+    unsigned int iid;
+    int iselected;
+
+    if(!PyArg_ParseTuple(args,"OfOOIi:ds2ah",&_iP, &size, &_icol,&_ihilite,&iid, &iselected) || NULL == _iP || NULL == _icol || NULL == _ihilite){
+        return NULL;
+    }
+
+    // unpack lists into structs; XYZ struct...
+    iP = Dict_to_XYZ(_iP);
+    // COLOUR structs...
+    icol = Dict_to_COLOUR(_icol);
+    ihilite = Dict_to_COLOUR(_ihilite);
+    
+    ds2ah(iP, size, icol, ihilite, iid, iselected);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+void   cHCallBackFunction(int *id){
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    S2PY_CALLBACK *cb;
+    PyObject *argList, *result;
+    
+    if((cb = panel_callback(S2PY_CB_HANDLE)) == NULL){
+        // cannot set an error - in a callback
+        PyGILState_Release(gstate);
+        return;
+    }
+    argList = Py_BuildValue("(i)", *id);
+    result = PyEval_CallObject(cb->callable, argList);
+    Py_DECREF(argList);
+    
+    if (result != NULL){
+        Py_DECREF(result);
+    }
+
+    PyGILState_Release(gstate);
+}
+static PyObject *s2plot_cs2shcb(PyObject *self, PyObject *args){
+    PyObject *temp;
+
+    if(!PyArg_ParseTuple(args, "O:cs2shcb", &temp)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        cs2shcb(NULL);
+        panel_callback_set(S2PY_CB_HANDLE, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // keep the callback for this panel
+    if(!panel_callback_set(S2PY_CB_HANDLE, temp, NULL)){
+        return NULL;
+    }
+    cs2shcb(&cHCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_cs2th(PyObject *self, PyObject *args){
+    unsigned int iid;
+
+    if(!PyArg_ParseTuple(args,"I:cs2th",&iid)){
+        return NULL;
+    }
+    
+    cs2th(iid);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_cs2qhv(PyObject *self, PyObject *args){
+    PyObject *result;
+
+    result = Py_BuildValue("i:cs2qhv",cs2qhv());
+
+    Py_INCREF(result);
     return result;
 }
 // ADVANCED TEXTURE AND COLORMAP HANDLING
@@ -3540,34 +6008,33 @@ static PyObject *s2plot_ss2sl(PyObject *self, PyObject *args){
     int nlights, worldcoords;
     PyObject *ambientIn;
     PyObject *lightposIn, *lightcolIn;
-    int i;
     
     if(!PyArg_ParseTuple(args,"OiOOi:ss2sl", &ambientIn, &nlights, &lightposIn, &lightcolIn, &worldcoords) || NULL == ambientIn || NULL == lightposIn || NULL == lightcolIn){
         return NULL;
     }
 
     // check the arrays - make sure None was not given for listIns (if only ambient light)
-    int nPos = (lightposIn != Py_None) ? (int) PyList_Size(lightposIn) : 0;
-    int nCol = (lightcolIn != Py_None) ? (int) PyList_Size(lightcolIn) : 0;
-    
-    if(nlights != nPos || nlights!= nCol){
+    if(nlights > 0 && (lightposIn == Py_None || lightcolIn == Py_None)){
         PyErr_SetString(PyExc_ValueError,"lights and colours must be lists of length nlights");
         return NULL;
     }
-    
-    lightpos = (XYZ *) calloc(nlights, sizeof(XYZ));
-    lightcol = (COLOUR *) calloc(nlights, sizeof(COLOUR));
-    
-    for(i = 0; i< nlights; i++){
-        lightpos[i] = Dict_to_XYZ(PyList_GetItem(lightposIn,i));
-        lightcol[i] = Dict_to_COLOUR(PyList_GetItem(lightcolIn,i));
+    lightpos = NULL;
+    lightcol = NULL;
+    if(nlights > 0){
+        if(!(lightpos = List_to_XYZ(lightposIn, &nlights, "lightpos"))){
+            return NULL;
+        }
+        if(!(lightcol = List_to_COLOUR(lightcolIn, &nlights, "lightcol"))){
+            List_free(lightposIn, lightpos);
+            return NULL;
+        }
     }
     ambient = Dict_to_COLOUR(ambientIn);
 
     ss2sl(ambient, nlights, lightpos, lightcol, worldcoords);    
 
-    free(lightpos);
-    free(lightcol);
+    List_free(lightposIn, lightpos);
+    List_free(lightcolIn, lightcol);
 
     Py_INCREF(Py_None);
     return Py_None;
@@ -3613,355 +6080,2649 @@ static PyObject *s2plot_ss2sc(PyObject *self, PyObject *args){
     if(!PyArg_ParseTuple(args,"OOOi:ss2sc",&positionIn, &upIn, &vdirIn, &worldcoords) || NULL == positionIn || NULL == upIn || NULL == vdirIn){
         return NULL;
     }
-    position = Dict_to_XYZ(positionIn);
-    up = Dict_to_XYZ(upIn);
-    vdir = Dict_to_XYZ(vdirIn);
-    
-    ss2sc(position, up, vdir, worldcoords);
-    
+    position = Dict_to_XYZ(positionIn);
+    up = Dict_to_XYZ(upIn);
+    vdir = Dict_to_XYZ(vdirIn);
+    
+    ss2sc(position, up, vdir, worldcoords);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2qc(PyObject *self, PyObject *args){
+    PyObject *resultTuple, *positionOut, *upOut, *vdirOut;
+    int worldcoords;
+    XYZ position, up, vdir;
+    
+    if(!PyArg_ParseTuple(args,"i:ss2qc",&worldcoords)){
+        return NULL;
+    }
+    
+    ss2qc(&position, &up, &vdir, worldcoords);
+    
+    resultTuple = (PyObject *) PyTuple_New(3);
+    if(resultTuple == NULL) return NULL;
+    
+    if(!(positionOut = XYZ_to_Dict(position))) return NULL;
+    if(!(upOut = XYZ_to_Dict(up))) return NULL;
+    if(!(vdirOut = XYZ_to_Dict(vdir))) return NULL;
+        
+    PyTuple_SetItem(resultTuple,0,positionOut);
+    PyTuple_SetItem(resultTuple,1,upOut);
+    PyTuple_SetItem(resultTuple,2,vdirOut);
+    Py_INCREF(resultTuple);
+    
+    return resultTuple;
+}
+static PyObject *s2plot_ss2sas(PyObject *self, PyObject *args){
+    int startstop;
+    
+    if(!PyArg_ParseTuple(args, "i:ss2sas", &startstop)){
+        return NULL;
+    }
+    
+    ss2sas(startstop);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2scf(PyObject *self, PyObject *args){
+    XYZ position;
+    int worldcoords;
+    PyObject *positionIn;
+    
+    if(!PyArg_ParseTuple(args, "Oi:ss2scf", &positionIn, &worldcoords) ||
+       !positionIn)
+        return NULL;
+
+    position = Dict_to_XYZ(positionIn);
+
+    ss2scf(position, worldcoords);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2ucf(PyObject *self, PyObject *args){
+    ss2ucf();
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2sca(PyObject *self, PyObject *args){ /* NEW */
+    float aperture;
+
+    if(!PyArg_ParseTuple(args, "f:ss2sca", &aperture))
+      return NULL;
+    ss2sca(aperture);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2qca(PyObject *self, PyObject *args){ /* NEW */
+    PyObject *result;
+
+    result = PyFloat_FromDouble((double) ss2qca());
+
+    Py_INCREF(result);
+    return result;
+}
+static PyObject *s2plot_ss2sss(PyObject *self, PyObject *args){
+    float spd;
+    
+    if(!PyArg_ParseTuple(args, "f:ss2sss", &spd)){
+        return NULL;
+    }
+    
+    ss2sss(spd);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2qss(PyObject *self, PyObject *args){
+    PyObject *result;
+
+    result = PyFloat_FromDouble((double) ss2qss());
+
+    Py_INCREF(result);
+    return result;
+}
+static PyObject *s2plot_ss2scs(PyObject *self, PyObject *args){ /* NEW */
+    float spd;
+    
+    if(!PyArg_ParseTuple(args, "f:ss2scs", &spd)){
+        return NULL;
+    }
+    
+    ss2scs(spd);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ss2qcs(PyObject *self, PyObject *args){ /* NEW */
+    PyObject *result;
+
+    result = PyFloat_FromDouble((double) ss2qcs());
+
+    Py_INCREF(result);
+    return result;
+}
+static PyObject *s2plot_ss2tc(PyObject *self, PyObject *args){
+    int enabledisable;
+
+    if(!PyArg_ParseTuple(args,"i:ss2tc",&enabledisable)){
+        return NULL;
+    }
+    
+    ss2tc(enabledisable);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+
+}
+static PyObject *s2plot_ss2qess(PyObject *self, PyObject *args){
+    PyObject *result;
+
+    result = PyFloat_FromDouble((double) ss2qess());
+
+    Py_INCREF(result);
+    return result;
+}
+static PyObject *s2plot_ss2sess(PyObject *self, PyObject *args){
+    float sep;
+    
+    if(!PyArg_ParseTuple(args, "f:ss2sess", &sep)){
+        return NULL;
+    }
+    
+    ss2sess(sep);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+// ADDITIONAL PRIMITIVES
+static PyObject *s2plot_s2chromapts(PyObject *self, PyObject *args){
+    int n;
+    float *ilong, *lat, *dist, *size, radius, dmin, dmax;
+    PyArrayObject *ilongIn, *latIn, *distIn, *sizeIn;
+
+    // parse the args into numpy array objects
+    if(!PyArg_ParseTuple(args,"iO!O!O!O!fff:s2chromapts",&n, &PyArray_Type,
+                         &ilongIn, &PyArray_Type, &latIn, &PyArray_Type,
+                         &distIn, &PyArray_Type, &sizeIn, &radius, &dmin, 
+                         &dmax) || !ilongIn || !latIn || !distIn || !sizeIn)
+      return NULL;
+
+
+    if(!(ilong = numpy1D_to_float(ilongIn))) {return NULL;}
+    if(!(lat = numpy1D_to_float(latIn))){
+        numpy_free(ilongIn, ilong);
+        return NULL;
+    }
+    if(!(dist = numpy1D_to_float(distIn))){
+        numpy_free(ilongIn, ilong);
+        numpy_free(latIn, lat);
+        return NULL;
+    }
+    if(!(size = numpy1D_to_float(sizeIn))){
+        numpy_free(ilongIn, ilong);
+        numpy_free(latIn, lat);
+        numpy_free(distIn, dist);
+        return NULL;
+    }
+
+    s2chromapts(n, ilong, lat, dist, size, radius, dmin, dmax);
+
+    numpy_free(ilongIn, ilong);
+    numpy_free(latIn, lat);
+    numpy_free(distIn, dist);
+    numpy_free(sizeIn, size);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_s2chromacpts(PyObject *self, PyObject *args){
+    int n;
+    float *ix, *iy, *iz, *dist, *size, dmin, dmax;
+    PyArrayObject *ixIn, *iyIn, *izIn, *distIn, *sizeIn;
+    
+    // parse the args into numpy array objects
+    if(!PyArg_ParseTuple(args,"iO!O!O!O!O!ff:s2chromacpts",&n, &PyArray_Type, &ixIn, &PyArray_Type, &iyIn, &PyArray_Type, &izIn, &PyArray_Type, &distIn, &PyArray_Type, &sizeIn, &dmin, &dmax) || NULL == ixIn || NULL == iyIn || NULL == izIn || NULL == distIn || NULL == sizeIn){
+        return NULL;
+    }
+
+    if(!(ix = numpy1D_to_float(ixIn))) {return NULL;}
+    if(!(iy = numpy1D_to_float(iyIn))){
+        numpy_free(ixIn, ix);
+        return NULL;
+    }
+    if(!(iz = numpy1D_to_float(izIn))) {
+        numpy_free(ixIn, ix);
+        numpy_free(iyIn, iy);
+        return NULL;
+    }
+    if(!(dist = numpy1D_to_float(distIn))) {
+        numpy_free(ixIn, ix);
+        numpy_free(iyIn, iy);
+        numpy_free(izIn, iz);
+        return NULL;
+    }
+    if(!(size = numpy1D_to_float(sizeIn))) {
+        numpy_free(ixIn, ix);
+        numpy_free(iyIn, iy);
+        numpy_free(izIn, iz);
+        numpy_free(distIn, dist);
+        return NULL;
+    }
+
+    s2chromacpts(n, ix, iy, iz, dist, size, dmin, dmax);
+
+    numpy_free(ixIn, ix);
+    numpy_free(iyIn, iy);
+    numpy_free(izIn, iz);
+    numpy_free(distIn, dist);
+    numpy_free(sizeIn, size);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+// **FUNCTIONS IN TESTING/DEVELOPMENT
+static PyObject *s2plot_ss2ltt(PyObject *self, PyObject *args){
+    float aspect;
+    char *command;
+    unsigned int tex_id;
+    PyObject *pyResult = NULL;
+
+    if(!PyArg_ParseTuple(args, "s:ss2ltt", &command)){
+        return NULL;
+    }
+    
+    tex_id = ss2ltt(command, &aspect);
+    
+    pyResult = (PyObject *) PyDict_New();
+    if(pyResult == NULL) return NULL;
+    
+    PyDict_SetItemString(pyResult, "texture_id", PyInt_FromLong((long) tex_id));
+    PyDict_SetItemString(pyResult, "aspect", PyFloat_FromDouble((double) aspect));
+    
+    Py_INCREF(pyResult);
+    return pyResult;
+    
+}
+static PyObject *s2plot_ns2vf3a(PyObject *self, PyObject *args){
+    XYZ *P;
+    COLOUR col;
+    PyObject *PIn, *colIn;
+    int n = 3;
+    char *trans;
+    float alpha;
+
+    if(!PyArg_ParseTuple(args, "OOsf:ns2vf3a", &PIn, &colIn, &trans, &alpha) || NULL == PIn || NULL == colIn){
+        return NULL;
+    }
+    if(!(P = List_to_XYZ(PIn, &n, "vertices"))){
+        return NULL;
+    }
+    col = Dict_to_COLOUR(colIn);
+    
+    ns2vf3a(P, col, trans[0], alpha);
+    
+    List_free(PIn, P);
+    
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ns2vpa(PyObject *self, PyObject *args){
+    XYZ P;
+    COLOUR icol;
+    char *itrans;
+    float isize, ialpha;
+    PyObject *PIn, *colIn;
+    
+    if(!(PyArg_ParseTuple(args, "OOfsf:ns2vpa", &PIn, &colIn, &isize, &itrans, &ialpha)) || NULL == PIn || NULL == colIn){
+        return NULL;
+    }
+
+    P = Dict_to_XYZ(PIn);
+    icol = Dict_to_COLOUR(colIn);
+    
+    ns2vpa(P, icol, isize, itrans[0], ialpha);
+    
+    Py_INCREF(Py_None);
+    return Py_None;    
+}
+static PyObject *s2plot_ns2vnpa(PyObject *self, PyObject *args){
+    XYZ *P, eye, up, vdir;
+    COLOUR *icol = NULL, col = {1., 1., 1.};
+    PyArrayObject *sizeArr;
+    float *isize = NULL, size = 1., ialpha;
+    char *itrans;
+    unsigned int *order = NULL;
+    S2PY_DEPTHSORT sort = {NULL, 0}, *state = NULL;
+    PyObject *PIn, *colIn, *sizeIn;
+    int n = -1, m, i, k, sortid = -1;
+
+    if(!(PyArg_ParseTuple(args, "OOOsf|i:ns2vnpa", &PIn, &colIn, &sizeIn, &itrans, &ialpha, &sortid)) || NULL == PIn || NULL == colIn || NULL == sizeIn){
+        return NULL;
+    }
+    if(!(P = List_to_XYZ(PIn, &n, "the list of positions"))){
+        return NULL;
+    }
+    if(PyDict_Check(colIn)){
+        col = Dict_to_COLOUR(colIn);
+    } else {
+        m = n;
+        if(!(icol = List_to_COLOUR(colIn, &m, "the list of colours"))){
+            List_free(PIn, P);
+            return NULL;
+        }
+    }
+    if(!(sizeArr = per_item_float(sizeIn, n, &size, "size")) && PyErr_Occurred()){
+        List_free(PIn, P);
+        if(icol) List_free(colIn, icol);
+        return NULL;
+    }
+    if(sizeArr) isize = (float *) PyArray_DATA(sizeArr);
+    if(sortid != -1 && !(state = depth_sort_lookup(sortid))){
+        List_free(PIn, P);
+        if(icol) List_free(colIn, icol);
+        Py_XDECREF(sizeArr);
+        return NULL;
+    }
+
+    // translucent dots go back to front, sorted as in ds2vnbb. The order is
+    // for the current camera, so it suits dots drawn each frame from a
+    // dynamic callback.
+    if(itrans[0] != 'o' && n > 1){
+        ss2qc(&eye, &up, &vdir, 1);
+        if(state){
+            order = depth_sort(state, P, n, eye, vdir);
+        } else {
+            Py_BEGIN_ALLOW_THREADS
+            order = depth_sort(&sort, P, n, eye, vdir);
+            Py_END_ALLOW_THREADS
+        }
+    }
+    for(k = 0; k < n; k++){
+        i = order ? (int) order[k] : k;
+        if(icol) col = icol[i];
+        if(isize) size = isize[i];
+        ns2vpa(P[i], col, size, itrans[0], ialpha);
+    }
+    depth_sort_free(&sort);
+
+    List_free(PIn, P);
+    if(icol) List_free(colIn, icol);
+    Py_XDECREF(sizeArr);
+
+    Py_INCREF(Py_None);
+    return Py_None;
+}
+static PyObject *s2plot_ns2cis(PyObject *self, PyObject *args){
+    float ***grid, *tr, level, alpha, red, green, blue, scale = 1., offset = 0.;
+    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, resolution, id;
+    char *trans;
+    PyArrayObject *gridIn, *trIn;
+    PyObject *result;
+    
+    // parse the args into numpy array objects
+    if(!PyArg_ParseTuple(args,"O!iiiiiiiiiOfisffff|ff:ns2cis", &PyArray_Type, &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &level, &resolution, &trans, &alpha, &red, &green, &blue, &scale, &offset) || !gridIn || !trIn){
+        return NULL;
+    }
+    if(!(grid = numpy3D_to_float_scaled(gridIn, scale, offset))) {return NULL;}
+    // None is allowed as input - for standard tr matrix
+    if((PyObject *) trIn == Py_None) {tr = NULL;}
+    else if(!(tr = numpy1D_to_float(trIn))){
+        numpy_free(gridIn, grid);
+        return NULL;
+    }
+    
+    id = ns2cis(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, *trans, alpha, red, green, blue);
+
+    // don't free grid: the memory is used by the surface drawer
+    numpy_free(trIn, tr);
+
+    result = PyInt_FromLong((long) id);
+    Py_INCREF(result);
+    return result;
+}
+// BINDING-SIDE ISOSURFACES
+// a grid is read in place through its numpy strides; a lattice is the part
+// of it visited by an extractor: every res'th node of [a1..a2][b1..b2][c1..c2]
+typedef struct {
+    const char *data;
+    npy_intp stride[3];     // bytes
+    int dim[3];
+    int type, swap;         // element type and byte order, read as
+    float scale, offset;    // value*scale + offset
+} S2PY_GRID;
+typedef struct {
+    S2PY_GRID grid;
+    int a1, b1, c1, res;
+    int n[3];               // nodes along each axis
+    float level;
+    float tr[12];
+} S2PY_LATTICE;
+
+static float grid_value(const S2PY_GRID *g, int a, int b, int c){
+    const char *p = g->data + a*g->stride[0] + b*g->stride[1] + c*g->stride[2];
+
+    return (g->swap ? swapped_to_float(p, g->type) : element_to_float(p, g->type))*g->scale + g->offset;
+}
+static float lattice_value(const S2PY_LATTICE *L, int ia, int ib, int ic){
+    return grid_value(&L->grid, L->a1 + ia*L->res, L->b1 + ib*L->res, L->c1 + ic*L->res);
+}
+static PyArrayObject *grid_from_array(PyObject *in, S2PY_GRID *g, float scale, float offset){
+    // view a 3D float32, float64, uint8, int16, uint16, int32 or float16
+    // array of either byte order in place (converting anything else to
+    // float32); returns a new reference to the array actually read, or NULL
+    // with the error set
+    PyArrayObject *arr;
+    int k, type = PyArray_Check(in) ? PyArray_TYPE((PyArrayObject *) in) : -1;
+
+    if((type == PyArray_FLOAT || type == PyArray_DOUBLE || type == PyArray_UBYTE || type == PyArray_SHORT || type == PyArray_USHORT || type == PyArray_INT || type == PyArray_HALF) && PyArray_NDIM((PyArrayObject *) in) == 3){
+        arr = (PyArrayObject *) in;
+        Py_INCREF(arr);
+    } else if(!(arr = (PyArrayObject *) PyArray_ContiguousFromObject(in, PyArray_FLOAT, 3, 3))){
+        return NULL;
+    }
+    g->type = PyArray_TYPE(arr);
+    g->swap = !PyArray_ISNOTSWAPPED(arr);
+    g->scale = scale;
+    g->offset = offset;
+    g->data = PyArray_DATA(arr);
+    for(k = 0; k < 3; k++){
+        g->stride[k] = PyArray_STRIDE(arr, k);
+        g->dim[k] = (int) PyArray_DIM(arr, k);
+    }
+    return arr;
+}
+static int lattice_init(S2PY_LATTICE *L, int a1, int a2, int b1, int b2, int c1, int c2, PyObject *trIn, float level, int res){
+    // check the range against the grid and take tr (None for unit); returns
+    // 0 with the python error set
+    PyArrayObject *tr;
+    int k, lo[3] = {a1, b1, c1}, hi[3] = {a2, b2, c2};
+
+    if(res < 1) res = 1;
+    for(k = 0; k < 3; k++){
+        if(lo[k] < 0 || hi[k] >= L->grid.dim[k] || hi[k] - lo[k] < res){
+            PyErr_Format(PyExc_ValueError, "index range %d..%d does not fit axis %d of the grid, or is shorter than one cell", lo[k], hi[k], k);
+            return 0;
+        }
+        L->n[k] = (hi[k] - lo[k])/res + 1;
+    }
+    L->a1 = a1; L->b1 = b1; L->c1 = c1;
+    L->res = res;
+    L->level = level;
+    if(trIn == Py_None){
+        for(k = 0; k < 12; k++) L->tr[k] = (k == 1 || k == 6 || k == 11) ? 1. : 0.;
+        return 1;
+    }
+    if(!(tr = (PyArrayObject *) PyArray_ContiguousFromObject(trIn, PyArray_FLOAT, 1, 1))){
+        return 0;
+    }
+    if(PyArray_DIM(tr, 0) != 12){
+        PyErr_SetString(PyExc_ValueError, "tr must have 12 elements");
+        Py_DECREF(tr);
+        return 0;
+    }
+    memcpy(L->tr, PyArray_DATA(tr), 12*sizeof(float));
+    Py_DECREF(tr);
+    return 1;
+}
+static void lattice_to_world(const S2PY_LATTICE *L, const float *u, float *p){
+    // lattice coordinates (in nodes) to world coordinates
+    float a = L->a1 + u[0]*L->res, b = L->b1 + u[1]*L->res, c = L->c1 + u[2]*L->res;
+
+    p[0] = L->tr[0] + L->tr[1]*a + L->tr[2]*b + L->tr[3]*c;
+    p[1] = L->tr[4] + L->tr[5]*a + L->tr[6]*b + L->tr[7]*c;
+    p[2] = L->tr[8] + L->tr[9]*a + L->tr[10]*b + L->tr[11]*c;
+}
+
+// marching tetrahedra. Each cell is split into the 6 tetrahedra that share
+// its main diagonal, so every tetrahedron edge joins a node to node + d with
+// d one of the 7 non-zero 0/1 offsets, and neighbouring cells agree on their
+// shared face diagonals. A crossing edge is numbered by its lower node and d.
+static const int tetOffsets[6][4] = {
+    {0, 4, 6, 7}, {0, 4, 5, 7}, {0, 2, 6, 7}, {0, 2, 3, 7}, {0, 1, 5, 7}, {0, 1, 3, 7}
+};
+
+static int lattice_edge(const S2PY_LATTICE *L, int ia, int ib, int ic, int d, float v, float *t){
+    // whether the edge from node (ia,ib,ic) along offset d (1..7, bits a,b,c
+    // = 4,2,1) crosses the level, and where (0..1 from the node)
+    int ja = ia + ((d >> 2) & 1), jb = ib + ((d >> 1) & 1), jc = ic + (d & 1);
+    float w;
+
+    if(ja >= L->n[0] || jb >= L->n[1] || jc >= L->n[2]) return 0;
+    w = lattice_value(L, ja, jb, jc);
+    if((v < L->level) == (w < L->level)) return 0;
+    *t = (L->level - v)/(w - v);
+    return 1;
+}
+static long lattice_row_vertices(const S2PY_LATTICE *L, int ia, int ib, const int *spans, int nspans, float *P, int *ids, long first){
+    // number the crossings of the edges starting in row (ia,ib), from first;
+    // fills ids[ic*7 + d-1] (-1 where there is none) and/or their world
+    // positions P when these are non-NULL. Only nodes in the nspans [from,to)
+    // ranges are visited. Returns the number of crossings.
+    long count = 0;
+    int s, ic, d;
+    float v, t, u[3];
+
+    for(s = 0; s < nspans; s++)
+    for(ic = spans[2*s]; ic < spans[2*s+1]; ic++){
+        v = lattice_value(L, ia, ib, ic);
+        for(d = 1; d < 8; d++){
+            if(!lattice_edge(L, ia, ib, ic, d, v, &t)){
+                if(ids) ids[ic*7 + d - 1] = -1;
+                continue;
+            }
+            if(ids) ids[ic*7 + d - 1] = (int) (first + count);
+            if(P){
+                u[0] = ia + t*((d >> 2) & 1);
+                u[1] = ib + t*((d >> 1) & 1);
+                u[2] = ic + t*(d & 1);
+                lattice_to_world(L, u, P + 3*(first + count));
+            }
+            count++;
+        }
+    }
+    return count;
+}
+typedef struct {
+    int *faces;
+    long n, cap;            // triangles
+} S2PY_TRIS;
+
+static int tris_add(S2PY_TRIS *T, int i, int j, int k){
+    int *grown;
+
+    if(T->n == T->cap){
+        T->cap = T->cap ? 2*T->cap : 1024;
+        if(!(grown = (int *) realloc(T->faces, (size_t) T->cap*3*sizeof(int)))) return 0;
+        T->faces = grown;
+    }
+    T->faces[3*T->n] = i;
+    T->faces[3*T->n+1] = j;
+    T->faces[3*T->n+2] = k;
+    T->n++;
+    return 1;
+}
+static int lattice_triangle(const S2PY_LATTICE *L, const float *P, S2PY_TRIS *T, int i, int j, int k, const float *out){
+    // add a triangle, wound so that its normal points along out (from the
+    // side above the level to the side below it)
+    const float *p = P + 3*i, *q = P + 3*j, *r = P + 3*k;
+    float a[3] = {q[0] - p[0], q[1] - p[1], q[2] - p[2]}, b[3] = {r[0] - p[0], r[1] - p[1], r[2] - p[2]};
+    float n[3] = {a[1]*b[2] - a[2]*b[1], a[2]*b[0] - a[0]*b[2], a[0]*b[1] - a[1]*b[0]};
+
+    if(n[0]*out[0] + n[1]*out[1] + n[2]*out[2] < 0.) return tris_add(T, i, k, j);
+    return tris_add(T, i, j, k);
+}
+static int lattice_row_triangles(const S2PY_LATTICE *L, int ia, int ib, const int *spans, int nspans, const float *P, int *ids[4], S2PY_TRIS *T){
+    // triangulate the cells between rows (ia,ib) and (ia+1,ib+1) whose lower
+    // corners lie in the spans; ids holds the edge numbering of rows (ia,ib),
+    // (ia,ib+1), (ia+1,ib), (ia+1,ib+1)
+    int s, ic, t, k, m, o, d, corner[4], edge[4][4], above[4], nabove, in[4], outs[4], ni, no;
+    float v[8], pa[3], pb[3], u[3], dir[3];
+
+    for(s = 0; s < nspans; s++)
+    for(ic = spans[2*s]; ic < spans[2*s+1] && ic + 1 < L->n[2]; ic++){
+        for(k = 0; k < 8; k++){
+            v[k] = lattice_value(L, ia + ((k >> 2) & 1), ib + ((k >> 1) & 1), ic + (k & 1));
+        }
+        for(t = 0; t < 6; t++){
+            for(nabove = 0, k = 0; k < 4; k++){
+                corner[k] = tetOffsets[t][k];
+                above[k] = v[corner[k]] >= L->level;
+                nabove += above[k];
+            }
+            if(nabove == 0 || nabove == 4) continue;
+            // vertex numbers of the crossing edges m < o; corners increase
+            // along the tetrahedron, so corner[o] - corner[m] is the offset
+            for(m = 0; m < 4; m++){
+                for(o = m + 1; o < 4; o++){
+                    if(above[m] == above[o]) continue;
+                    d = corner[o] - corner[m];
+                    edge[m][o] = edge[o][m] = ids[corner[m] >> 1][(ic + (corner[m] & 1))*7 + d - 1];
+                }
+            }
+            for(ni = no = 0, k = 0; k < 4; k++){
+                if(above[k]) in[ni++] = k;
+                else         outs[no++] = k;
+            }
+            // any corner above to any corner below gives the outward side
+            u[0] = ia + ((corner[in[0]] >> 2) & 1); u[1] = ib + ((corner[in[0]] >> 1) & 1); u[2] = ic + (corner[in[0]] & 1);
+            lattice_to_world(L, u, pa);
+            u[0] = ia + ((corner[outs[0]] >> 2) & 1); u[1] = ib + ((corner[outs[0]] >> 1) & 1); u[2] = ic + (corner[outs[0]] & 1);
+            lattice_to_world(L, u, pb);
+            dir[0] = pb[0] - pa[0]; dir[1] = pb[1] - pa[1]; dir[2] = pb[2] - pa[2];
+            if(ni == 1){
+                if(!lattice_triangle(L, P, T, edge[in[0]][outs[0]], edge[in[0]][outs[1]], edge[in[0]][outs[2]], dir)) return 0;
+            } else if(no == 1){
+                if(!lattice_triangle(L, P, T, edge[outs[0]][in[0]], edge[outs[0]][in[1]], edge[outs[0]][in[2]], dir)) return 0;
+            } else {
+                if(!lattice_triangle(L, P, T, edge[in[0]][outs[0]], edge[in[0]][outs[1]], edge[in[1]][outs[1]], dir)) return 0;
+                if(!lattice_triangle(L, P, T, edge[in[0]][outs[0]], edge[in[1]][outs[1]], edge[in[1]][outs[0]], dir)) return 0;
+            }
+        }
+    }
+    return 1;
+}
+// a min/max summary of blocks of cells lets an extraction skip every block
+// that cannot contain the level. Every edge from a node lies in the cell with
+// that node as its lower corner (clamped to the last cell), and an edge can
+// only cross the level if that cell's block brackets it, so visiting just the
+// nodes of such blocks keeps the vertex numbering of a full extraction.
+// A checksum per block tells which blocks a change to the grid touched.
+typedef struct {
+    int size;               // cells along each edge of a block
+    int n[3];               // blocks along each axis
+    float *min, *max;       // over each block's nodes, boundaries included
+    unsigned int *sums;     // FNV-1a of the nodes' bits
+    unsigned char *stale;   // marked as changed since the last refresh
+    long nstale;
+    int *spans;             // per block column (ba,bb), n[2]+1 ints: node
+    int *nspans;            // ranges [from,to) of the bracketing blocks
+} S2PY_BLOCKS;
+
+static void blocks_free(S2PY_BLOCKS *B){
+    free(B->min);
+    free(B->max);
+    free(B->sums);
+    free(B->stale);
+    free(B->spans);
+    free(B->nspans);
+    memset(B, 0, sizeof(S2PY_BLOCKS));
+}
+static int blocks_summarise(const S2PY_LATTICE *L, S2PY_BLOCKS *B, int x, int y, int z){
+    // the min/max and checksum of block (x,y,z); returns whether the
+    // checksum changed
+    int ia, ib, ic, i = (x*B->n[1] + y)*B->n[2] + z;
+    int a1 = x*B->size, b1 = y*B->size, c1 = z*B->size;
+    int a2 = a1 + B->size < L->n[0] ? a1 + B->size : L->n[0] - 1;
+    int b2 = b1 + B->size < L->n[1] ? b1 + B->size : L->n[1] - 1;
+    int c2 = c1 + B->size < L->n[2] ? c1 + B->size : L->n[2] - 1;
+    float v, lo = lattice_value(L, a1, b1, c1), hi = lo;
+    unsigned int bits, sum = 2166136261u;
+
+    for(ia = a1; ia <= a2; ia++){
+        for(ib = b1; ib <= b2; ib++){
+            for(ic = c1; ic <= c2; ic++){
+                v = lattice_value(L, ia, ib, ic);
+                if(v < lo) lo = v;
+                if(v > hi) hi = v;
+                memcpy(&bits, &v, sizeof(bits));
+                sum = (sum ^ bits)*16777619u;
+            }
+        }
+    }
+    B->min[i] = lo;
+    B->max[i] = hi;
+    if(B->sums[i] == sum) return 0;
+    B->sums[i] = sum;
+    return 1;
+}
+static int blocks_build(const S2PY_LATTICE *L, S2PY_BLOCKS *B, int size){
+    // summarise every block; returns 0 if out of memory
+    long nblocks, i;
+    int k;
+
+    memset(B, 0, sizeof(S2PY_BLOCKS));
+    B->size = size;
+    for(k = 0; k < 3; k++) B->n[k] = (L->n[k] - 2)/size + 1;
+    nblocks = (long) B->n[0]*B->n[1]*B->n[2];
+    B->min = (float *) malloc((size_t) nblocks*sizeof(float));
+    B->max = (float *) malloc((size_t) nblocks*sizeof(float));
+    B->sums = (unsigned int *) calloc((size_t) nblocks, sizeof(unsigned int));
+    B->stale = (unsigned char *) calloc((size_t) nblocks, 1);
+    B->spans = (int *) malloc((size_t) B->n[0]*B->n[1]*(B->n[2] + 1)*sizeof(int));
+    B->nspans = (int *) malloc((size_t) B->n[0]*B->n[1]*sizeof(int));
+    if(!B->min || !B->max || !B->sums || !B->stale || !B->spans || !B->nspans){
+        blocks_free(B);
+        return 0;
+    }
+    #pragma omp parallel for schedule(dynamic)
+    for(i = 0; i < nblocks; i++){
+        blocks_summarise(L, B, (int) (i/((long) B->n[1]*B->n[2])), (int) (i/B->n[2] % B->n[1]), (int) (i % B->n[2]));
+    }
+    return 1;
+}
+static void blocks_mark(const S2PY_LATTICE *L, S2PY_BLOCKS *B, const int *lo, const int *hi){
+    // mark the blocks holding any lattice node in grid index range [lo..hi]
+    int k, from[3], to[3], first, last, x, y, z;
+    const int origin[3] = {L->a1, L->b1, L->c1};
+    long i;
+
+    for(k = 0; k < 3; k++){
+        // the nodes in range, then the blocks sharing them (a node on a
+        // block boundary belongs to both neighbours)
+        first = lo[k] <= origin[k] ? 0 : (lo[k] - origin[k] + L->res - 1)/L->res;
+        last = hi[k] < origin[k] ? -1 : (hi[k] - origin[k])/L->res;
+        if(last > L->n[k] - 1) last = L->n[k] - 1;
+        if(first > last) return;
+        from[k] = first > 0 ? (first - 1)/B->size : 0;
+        to[k] = last/B->size < B->n[k] - 1 ? last/B->size : B->n[k] - 1;
+    }
+    for(x = from[0]; x <= to[0]; x++){
+        for(y = from[1]; y <= to[1]; y++){
+            for(z = from[2]; z <= to[2]; z++){
+                i = ((long) x*B->n[1] + y)*B->n[2] + z;
+                if(!B->stale[i]){
+                    B->stale[i] = 1;
+                    B->nstale++;
+                }
+            }
+        }
+    }
+}
+static long blocks_refresh(const S2PY_LATTICE *L, S2PY_BLOCKS *B, int scan){
+    // re-summarise the marked blocks, or with scan every block, and clear the
+    // marks; returns how many blocks actually changed
+    long nblocks = (long) B->n[0]*B->n[1]*B->n[2], i, changed = 0;
+
+    if(!scan && B->nstale == 0) return 0;
+    #pragma omp parallel for schedule(dynamic) reduction(+:changed)
+    for(i = 0; i < nblocks; i++){
+        if(scan || B->stale[i]){
+            changed += blocks_summarise(L, B, (int) (i/((long) B->n[1]*B->n[2])), (int) (i/B->n[2] % B->n[1]), (int) (i % B->n[2]));
+            B->stale[i] = 0;
+        }
+    }
+    B->nstale = 0;
+    return changed;
+}
+static long blocks_level(const S2PY_LATTICE *L, S2PY_BLOCKS *B){
+    // find the runs of blocks bracketing L->level; returns how many blocks
+    long col, nactive = 0;
+
+    #pragma omp parallel for schedule(static) reduction(+:nactive)
+    for(col = 0; col < (long) B->n[0]*B->n[1]; col++){
+        int z, start = -1, k = 0, *spans = B->spans + col*(B->n[2] + 1);
+        long i;
+        for(z = 0; z <= B->n[2]; z++){
+            i = col*B->n[2] + z;
+            if(z < B->n[2] && B->min[i] < L->level && B->max[i] >= L->level){
+                if(start < 0) start = z;
+                nactive++;
+            } else if(start >= 0){
+                spans[2*k] = start*B->size;
+                spans[2*k+1] = (z == B->n[2] || z*B->size > L->n[2]) ? L->n[2] : z*B->size;
+                k++;
+                start = -1;
+            }
+        }
+        B->nspans[col] = k;
+    }
+    return nactive;
+}
+static int lattice_spans(const S2PY_LATTICE *L, const S2PY_BLOCKS *B, int ia, int ib, const int **spans, int *full){
+    // the node ranges of row (ia,ib) worth visiting, and how many there are
+    long col;
+
+    if(B == NULL){
+        full[0] = 0;
+        full[1] = L->n[2];
+        *spans = full;
+        return 1;
+    }
+    col = (long) ((ia < L->n[0] - 2 ? ia : L->n[0] - 2)/B->size)*B->n[1] + (ib < L->n[1] - 2 ? ib : L->n[1] - 2)/B->size;
+    *spans = B->spans + col*(B->n[2] + 1);
+    return B->nspans[col];
+}
+static int lattice_extract(const S2PY_LATTICE *L, const S2PY_BLOCKS *B, float **Pout, long *nverts, int **Fout, long *nfaces){
+    // extract the isosurface of the lattice into malloc'd vertex and triangle
+    // arrays, working on slabs of constant ia in parallel, and visiting only
+    // the blocks bracketing the level if B is not NULL. Returns 0 if out of
+    // memory. Needs no python objects.
+    long *rowStart, nv, nf;
+    int na = L->n[0], nb = L->n[1], nc = L->n[2], ia, ok = 1;
+    float *P;
+    int *F;
+    S2PY_TRIS *slabs;
+
+    *Pout = NULL;
+    *Fout = NULL;
+    if(!(rowStart = (long *) calloc((size_t) na*nb + 1, sizeof(long)))) return 0;
+    #pragma omp parallel for schedule(dynamic)
+    for(ia = 0; ia < na; ia++){
+        int ib, nspans, full[2];
+        const int *spans;
+        for(ib = 0; ib < nb; ib++){
+            nspans = lattice_spans(L, B, ia, ib, &spans, full);
+            rowStart[ia*nb + ib + 1] = lattice_row_vertices(L, ia, ib, spans, nspans, NULL, NULL, 0);
+        }
+    }
+    for(ia = 0; ia < na*nb; ia++) rowStart[ia + 1] += rowStart[ia];
+    nv = rowStart[(long) na*nb];
+    if(nv > 0x7FFFFFFFL || !(P = (float *) malloc((size_t) (nv ? nv : 1)*3*sizeof(float)))){
+        free(rowStart);
+        return 0;
+    }
+    #pragma omp parallel for schedule(dynamic)
+    for(ia = 0; ia < na; ia++){
+        int ib, nspans, full[2];
+        const int *spans;
+        for(ib = 0; ib < nb; ib++){
+            nspans = lattice_spans(L, B, ia, ib, &spans, full);
+            lattice_row_vertices(L, ia, ib, spans, nspans, P, NULL, rowStart[ia*nb + ib]);
+        }
+    }
+
+    if(!(slabs = (S2PY_TRIS *) calloc((size_t) na, sizeof(S2PY_TRIS)))){
+        free(rowStart);
+        free(P);
+        return 0;
+    }
+    #pragma omp parallel for schedule(dynamic) reduction(&&:ok)
+    for(ia = 0; ia < na - 1; ia++){
+        int ib, r, nspans, full[2], *ids[4], *block = (int *) malloc((size_t) 4*nc*7*sizeof(int));
+        const int *spans;
+        if(block == NULL){
+            ok = 0;
+            continue;
+        }
+        for(r = 0; r < 4; r++) ids[r] = block + r*nc*7;
+        for(ib = 0; ib + 1 < nb && ok; ib++){
+            if(lattice_spans(L, B, ia, ib, &spans, full) == 0) continue;
+            for(r = 0; r < 4; r++){
+                nspans = lattice_spans(L, B, ia + (r >> 1), ib + (r & 1), &spans, full);
+                lattice_row_vertices(L, ia + (r >> 1), ib + (r & 1), spans, nspans, NULL, ids[r], rowStart[(ia + (r >> 1))*nb + ib + (r & 1)]);
+            }
+            nspans = lattice_spans(L, B, ia, ib, &spans, full);
+            ok = ok && lattice_row_triangles(L, ia, ib, spans, nspans, P, ids, &slabs[ia]);
+        }
+        free(block);
+    }
+    free(rowStart);
+
+    // join the slabs in order
+    for(nf = 0, ia = 0; ia < na; ia++) nf += slabs[ia].n;
+    if(ok && !(F = (int *) malloc((size_t) (nf ? nf : 1)*3*sizeof(int)))) ok = 0;
+    if(ok){
+        for(nf = 0, ia = 0; ia < na; ia++){
+            memcpy(F + 3*nf, slabs[ia].faces, (size_t) slabs[ia].n*3*sizeof(int));
+            nf += slabs[ia].n;
+        }
+    }
+    for(ia = 0; ia < na; ia++) free(slabs[ia].faces);
+    free(slabs);
+    if(!ok){
+        free(P);
+        return 0;
+    }
+    *Pout = P;
+    *nverts = nv;
+    *Fout = F;
+    *nfaces = nf;
+    return 1;
+}
+static PyObject *s2plot_ns2xis(PyObject *self, PyObject *args){
+    S2PY_LATTICE L;
+    S2PY_MESH mesh;
+    PyObject *gridIn, *trIn, *result;
+    PyArrayObject *grid, *vertsOut, *normsOut, *facesOut;
+    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, resolution, ok;
+    float level, *P, scale = 1., offset = 0.;
+    int *F;
+    long nv, nf;
+    npy_intp dims[2];
+
+    if(!PyArg_ParseTuple(args, "OiiiiiiiiiOfi|ff:ns2xis", &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &level, &resolution, &scale, &offset)){
+        return NULL;
+    }
+    if(!(grid = grid_from_array(gridIn, &L.grid, scale, offset))){
+        return NULL;
+    }
+    if(!lattice_init(&L, a1, a2, b1, b2, c1, c2, trIn, level, resolution)){
+        Py_DECREF(grid);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    ok = lattice_extract(&L, NULL, &P, &nv, &F, &nf);
+    Py_END_ALLOW_THREADS
+    Py_DECREF(grid);
+    if(!ok){
+        return PyErr_NoMemory();
+    }
+
+    dims[0] = (npy_intp) nv;
+    dims[1] = 3;
+    vertsOut = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_FLOAT);
+    normsOut = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_FLOAT);
+    dims[0] = (npy_intp) nf;
+    facesOut = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_INT);
+    if(!vertsOut || !normsOut || !facesOut){
+        Py_XDECREF(vertsOut);
+        Py_XDECREF(normsOut);
+        Py_XDECREF(facesOut);
+        free(P);
+        free(F);
+        return NULL;
+    }
+    memcpy(PyArray_DATA(vertsOut), P, (size_t) nv*3*sizeof(float));
+    memcpy(PyArray_DATA(facesOut), F, (size_t) nf*3*sizeof(int));
+    free(P);
+    free(F);
+
+    // the same area-weighted normals as an indexed mesh gets
+    memset(&mesh, 0, sizeof(S2PY_MESH));
+    mesh.nverts = (int) nv;
+    mesh.nfaces = (int) nf;
+    mesh.nside = 3;
+    mesh.verts = (XYZ *) PyArray_DATA(vertsOut);
+    mesh.norms = (XYZ *) PyArray_DATA(normsOut);
+    mesh.faces = (int *) PyArray_DATA(facesOut);
+    Py_BEGIN_ALLOW_THREADS
+    mesh_normals(&mesh);
+    Py_END_ALLOW_THREADS
+
+    result = Py_BuildValue("(NNN)", vertsOut, normsOut, facesOut);
+    return result;
+}
+// isosurface objects that keep their grid and a block min/max summary, so a
+// level change only re-extracts the blocks that can contain the new level
+typedef struct {
+    PyArrayObject *grid;    // read in place; NULL marks a free slot
+    S2PY_LATTICE L;
+    S2PY_BLOCKS B;          // B.min is NULL until the blocks are summarised
+    S2PY_MESH mesh;
+    int generation;         // of the newest requested extraction
+    int shown;              // generation of the mesh being drawn
+    int pending;            // background jobs not yet collected
+} S2PY_XSURF;
+static S2PY_XSURF *xsurfList = NULL;
+static int nXsurfs = 0;
+
+static S2PY_XSURF *xsurf_lookup(int id){
+    if(id < 0 || id >= nXsurfs || xsurfList[id].grid == NULL){
+        PyErr_Format(PyExc_IndexError, "no isosurface with id %d", id);
+        return NULL;
+    }
+    return &xsurfList[id];
+}
+static int surface_extract(const S2PY_LATTICE *L, S2PY_BLOCKS *B, S2PY_MESH *mesh){
+    // extract into mesh (replacing its geometry, keeping its colour) for
+    // L->level; returns 0 if out of memory. Needs no python objects.
+    float *P;
+    int *F;
+    long nv, nf;
+    XYZ *norms;
+
+    blocks_level(L, B);
+    if(!lattice_extract(L, B, &P, &nv, &F, &nf)){
+        return 0;
+    }
+    if(!(norms = (XYZ *) malloc((size_t) (nv ? nv : 1)*sizeof(XYZ)))){
+        free(P);
+        free(F);
+        return 0;
+    }
+    free(mesh->verts);
+    free(mesh->norms);
+    free(mesh->faces);
+    mesh->verts = (XYZ *) P;
+    mesh->norms = norms;
+    mesh->faces = F;
+    mesh->nverts = (int) nv;
+    mesh->nfaces = (int) nf;
+    mesh->nside = 3;
+    mesh_normals(mesh);
+    return 1;
+}
+
+// background builds. Jobs run on a small pthread pool, each on its own copy
+// of the lattice and span lists (the block min/max are shared read-only, so a
+// job is only queued once no synchronous extraction is updating them), and
+// are collected with the GIL held at the start of the next frame, so the old
+// mesh keeps being drawn until the new one is swapped in.
+typedef struct S2PY_JOB {
+    struct S2PY_JOB *next;
+    int xsid, generation;
+    int build;              // summarise the blocks first
+    int cancelled, ok;
+    S2PY_LATTICE L;
+    S2PY_BLOCKS B;
+    S2PY_MESH mesh;
+} S2PY_JOB;
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work, done;
+    S2PY_JOB *queue, *last;  // waiting jobs, oldest first
+    S2PY_JOB *finished;
+    int nthreads;
+    int *busy, nbusy;       // per object: jobs queued or running, and
+                            // extractions running without the GIL
+    int *held;              // per object: just the extractions
+} jobPool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL, NULL, 0, NULL, 0, NULL};
+
+static int xsurf_busy(int id, int delta, int hold){
+    // adjust the busy count of isosurface id (and its held count, for an
+    // extraction), waking waiters when it drops; called with jobPool.lock
+    // held, returns 0 if out of memory
+    int *grown;
+
+    if(id >= jobPool.nbusy){
+        if(!(grown = (int *) realloc(jobPool.busy, (size_t) (id + 1)*sizeof(int)))){
+            return 0;
+        }
+        jobPool.busy = grown;
+        if(!(grown = (int *) realloc(jobPool.held, (size_t) (id + 1)*sizeof(int)))){
+            return 0;
+        }
+        jobPool.held = grown;
+        memset(jobPool.busy + jobPool.nbusy, 0, (size_t) (id + 1 - jobPool.nbusy)*sizeof(int));
+        memset(jobPool.held + jobPool.nbusy, 0, (size_t) (id + 1 - jobPool.nbusy)*sizeof(int));
+        jobPool.nbusy = id + 1;
+    }
+    jobPool.busy[id] += delta;
+    if(hold) jobPool.held[id] += delta;
+    if(delta < 0) pthread_cond_broadcast(&jobPool.done);
+    return 1;
+}
+static S2PY_XSURF *xsurf_unheld(int id){
+    // block (without the GIL) until no extraction of isosurface id runs
+    // without the GIL; jobs may still be in flight. Returns the object, or
+    // NULL with the python error set if it was freed meanwhile.
+    int held;
+
+    pthread_mutex_lock(&jobPool.lock);
+    held = id < jobPool.nbusy ? jobPool.held[id] : 0;
+    pthread_mutex_unlock(&jobPool.lock);
+    if(held > 0){
+        Py_BEGIN_ALLOW_THREADS
+        pthread_mutex_lock(&jobPool.lock);
+        while(id < jobPool.nbusy && jobPool.held[id] > 0){
+            pthread_cond_wait(&jobPool.done, &jobPool.lock);
+        }
+        pthread_mutex_unlock(&jobPool.lock);
+        Py_END_ALLOW_THREADS
+    }
+    // holds only start with the GIL held, so none can begin before the caller
+    // is done with the object
+    return xsurf_lookup(id);
+}
+
+static void job_free(S2PY_JOB *job){
+    // the block min/max belong to the job only if it summarised them
+    if(job->build){
+        blocks_free(&job->B);
+    } else {
+        free(job->B.spans);
+        free(job->B.nspans);
+    }
+    mesh_free(&job->mesh);
+    free(job);
+}
+static void *job_worker(void *arg){
+    S2PY_JOB *job;
+
+    for(;;){
+        pthread_mutex_lock(&jobPool.lock);
+        while(jobPool.queue == NULL){
+            pthread_cond_wait(&jobPool.work, &jobPool.lock);
+        }
+        job = jobPool.queue;
+        if(!(jobPool.queue = job->next)) jobPool.last = NULL;
+        pthread_mutex_unlock(&jobPool.lock);
+
+        if(!job->cancelled){
+            job->ok = (!job->build || blocks_build(&job->L, &job->B, S2PY_XS_BLOCK)) && surface_extract(&job->L, &job->B, &job->mesh);
+        }
+
+        pthread_mutex_lock(&jobPool.lock);
+        job->next = jobPool.finished;
+        jobPool.finished = job;
+        xsurf_busy(job->xsid, -1, 0);
+        pthread_mutex_unlock(&jobPool.lock);
+    }
+    return NULL;
+}
+static int job_submit(int xsid){
+    // queue an extraction of isosurface object xsid at its current level,
+    // superseding any of its jobs still waiting; returns 0 with the python
+    // error set
+    S2PY_XSURF *X;
+    S2PY_JOB *job, *old;
+    pthread_t thread;
+    size_t ncols;
+
+    // the job shares the block min/max, which an extraction running without
+    // the GIL may be rewriting
+    if(!(X = xsurf_unheld(xsid))){
+        return 0;
+    }
+    if(!(job = (S2PY_JOB *) calloc(1, sizeof(S2PY_JOB)))){
+        PyErr_NoMemory();
+        return 0;
+    }
+    job->xsid = xsid;
+    job->generation = ++X->generation;
+    job->L = X->L;
+    job->mesh.col = X->mesh.col;
+    if(!(job->build = X->B.min == NULL)){
+        job->B = X->B;
+        ncols = (size_t) X->B.n[0]*X->B.n[1];
+        job->B.spans = (int *) malloc(ncols*(X->B.n[2] + 1)*sizeof(int));
+        job->B.nspans = (int *) malloc(ncols*sizeof(int));
+        if(!job->B.spans || !job->B.nspans){
+            job_free(job);
+            PyErr_NoMemory();
+            return 0;
+        }
+    }
+
+    pthread_mutex_lock(&jobPool.lock);
+    while(jobPool.nthreads < S2PY_WORKERS){
+        if(pthread_create(&thread, NULL, job_worker, NULL) != 0) break;
+        pthread_detach(thread);
+        jobPool.nthreads++;
+    }
+    if(jobPool.nthreads == 0){
+        pthread_mutex_unlock(&jobPool.lock);
+        job_free(job);
+        PyErr_SetString(PyExc_RuntimeError, "could not start a worker thread");
+        return 0;
+    }
+    if(!xsurf_busy(xsid, 1, 0)){
+        pthread_mutex_unlock(&jobPool.lock);
+        job_free(job);
+        PyErr_NoMemory();
+        return 0;
+    }
+    for(old = jobPool.queue; old != NULL; old = old->next){
+        if(old->xsid == xsid) old->cancelled = 1;
+    }
+    if(jobPool.last) jobPool.last->next = job;
+    else             jobPool.queue = job;
+    jobPool.last = job;
+    pthread_cond_signal(&jobPool.work);
+    pthread_mutex_unlock(&jobPool.lock);
+    X->pending++;
+    return 1;
+}
+static void jobs_collect(void){
+    // swap in finished builds; called with the GIL held, between frames
+    S2PY_JOB *job, *next;
+    S2PY_XSURF *X;
+    S2PY_MESH swap;
+
+    pthread_mutex_lock(&jobPool.lock);
+    job = jobPool.finished;
+    jobPool.finished = NULL;
+    pthread_mutex_unlock(&jobPool.lock);
+
+    // oldest first, so that a newer generation always wins
+    for(next = NULL; job != NULL; ){
+        S2PY_JOB *rest = job->next;
+        job->next = next;
+        next = job;
+        job = rest;
+    }
+    for(job = next; job != NULL; job = next){
+        next = job->next;
+        X = &xsurfList[job->xsid];
+        X->pending--;
+        if(job->ok && job->generation > X->shown){
+            swap = X->mesh;
+            X->mesh = job->mesh;
+            job->mesh = swap;
+            X->shown = job->generation;
+            if(job->build && X->B.min == NULL){
+                X->B = job->B;
+                memset(&job->B, 0, sizeof(S2PY_BLOCKS));
+            }
+        }
+        job_free(job);
+    }
+}
+static S2PY_XSURF *xsurf_wait(int id){
+    // block (without the GIL) until isosurface id has nothing in flight and
+    // all its jobs are collected. Returns the object, which may have moved
+    // meanwhile, or NULL with the python error set if it was freed.
+    S2PY_XSURF *X;
+    int busy;
+
+    for(;;){
+        jobs_collect();
+        if(!(X = xsurf_lookup(id))){
+            return NULL;
+        }
+        pthread_mutex_lock(&jobPool.lock);
+        busy = id < jobPool.nbusy ? jobPool.busy[id] : 0;
+        pthread_mutex_unlock(&jobPool.lock);
+        // a job may finish between the collection and the count
+        if(busy == 0 && X->pending == 0) return X;
+
+        Py_BEGIN_ALLOW_THREADS
+        pthread_mutex_lock(&jobPool.lock);
+        while(id < jobPool.nbusy && jobPool.busy[id] > 0){
+            pthread_cond_wait(&jobPool.done, &jobPool.lock);
+        }
+        pthread_mutex_unlock(&jobPool.lock);
+        Py_END_ALLOW_THREADS
+    }
+}
+static int xsurf_hold(int id){
+    // count an extraction of isosurface id about to run without the GIL, so
+    // that xsurf_wait (and so ns2fxs) waits for it; returns 0 with the python
+    // error set
+    int ok;
+
+    pthread_mutex_lock(&jobPool.lock);
+    ok = xsurf_busy(id, 1, 1);
+    pthread_mutex_unlock(&jobPool.lock);
+    if(!ok) PyErr_NoMemory();
+    return ok;
+}
+static void xsurf_release(int id){
+    pthread_mutex_lock(&jobPool.lock);
+    xsurf_busy(id, -1, 1);
+    pthread_mutex_unlock(&jobPool.lock);
+}
+static void xsurf_free(S2PY_XSURF *X){
+    Py_XDECREF(X->grid);
+    blocks_free(&X->B);
+    mesh_free(&X->mesh);
+    memset(X, 0, sizeof(S2PY_XSURF));
+}
+static void xsurf_show(S2PY_XSURF *X, S2PY_MESH *mesh){
+    // swap in a newly extracted mesh and free the old one; with the GIL held,
+    // so nothing can be drawing it
+    S2PY_MESH old = X->mesh;
+
+    X->mesh = *mesh;
+    memset(mesh, 0, sizeof(S2PY_MESH));
+    mesh_free(&old);
+    X->shown = ++X->generation;
+}
+static long xsurf_refresh(int id, int scan){
+    // bring the blocks of isosurface id up to date with the grid and
+    // re-extract if any changed; returns the number changed, or -1 with the
+    // python error set
+    S2PY_XSURF *X;
+    S2PY_LATTICE L;
+    S2PY_BLOCKS B;
+    S2PY_MESH mesh;
+    long changed;
+    int ok = 1;
+
+    // jobs read the block summary
+    if(!(X = xsurf_wait(id))){
+        return -1;
+    }
+    if(X->B.min == NULL) return 0;
+    if(!xsurf_hold(id)){
+        return -1;
+    }
+
+    // work on copies, so that without the GIL nothing is read through X
+    // (the list may grow) and the mesh being drawn is left alone
+    L = X->L;
+    B = X->B;
+    memset(&mesh, 0, sizeof(S2PY_MESH));
+    mesh.col = X->mesh.col;
+    Py_BEGIN_ALLOW_THREADS
+    if((changed = blocks_refresh(&L, &B, scan)) > 0){
+        ok = surface_extract(&L, &B, &mesh);
+    }
+    Py_END_ALLOW_THREADS
+    xsurf_release(id);
+    X = &xsurfList[id];
+    X->B = B;
+    if(!ok){
+        mesh_free(&mesh);
+        PyErr_NoMemory();
+        return -1;
+    }
+    if(changed > 0) xsurf_show(X, &mesh);
+    return changed;
+}
+static PyObject *s2plot_ns2cxs(PyObject *self, PyObject *args){
+    S2PY_XSURF X, *grown;
+    PyObject *gridIn, *trIn, *colIn;
+    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, resolution, id, ok = 1, background = 0;
+    float level, scale = 1., offset = 0.;
+
+    if(!PyArg_ParseTuple(args, "OiiiiiiiiiOfiO|iff:ns2cxs", &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &level, &resolution, &colIn, &background, &scale, &offset) || NULL == colIn){
+        return NULL;
+    }
+    memset(&X, 0, sizeof(S2PY_XSURF));
+    if(!(X.grid = grid_from_array(gridIn, &X.L.grid, scale, offset))){
+        return NULL;
+    }
+    if(!lattice_init(&X.L, a1, a2, b1, b2, c1, c2, trIn, level, resolution)){
+        Py_DECREF(X.grid);
+        return NULL;
+    }
+    X.mesh.col = Dict_to_COLOUR(colIn);
+
+    if(!background){
+        Py_BEGIN_ALLOW_THREADS
+        ok = blocks_build(&X.L, &X.B, S2PY_XS_BLOCK) && surface_extract(&X.L, &X.B, &X.mesh);
+        Py_END_ALLOW_THREADS
+    }
+    if(!ok){
+        xsurf_free(&X);
+        return PyErr_NoMemory();
+    }
+
+    // reuse a freed slot if there is one
+    for(id = 0; id < nXsurfs && xsurfList[id].grid != NULL; id++);
+    if(id == nXsurfs){
+        if(!(grown = (S2PY_XSURF *) realloc(xsurfList, (size_t) (nXsurfs + 1)*sizeof(S2PY_XSURF)))){
+            xsurf_free(&X);
+            return PyErr_NoMemory();
+        }
+        xsurfList = grown;
+        nXsurfs++;
+    }
+    xsurfList[id] = X;
+    // a background build draws nothing until it is collected
+    if(background && !job_submit(id)){
+        xsurf_free(&xsurfList[id]);
+        return NULL;
+    }
+
+    return PyInt_FromLong((long) id);
+}
+static PyObject *s2plot_ns2sxsl(PyObject *self, PyObject *args){
+    S2PY_XSURF *X;
+    S2PY_LATTICE L;
+    S2PY_BLOCKS B;
+    S2PY_MESH mesh;
+    int id, ok, background = 0;
+    float level;
+
+    if(!PyArg_ParseTuple(args, "if|i:ns2sxsl", &id, &level, &background)){
+        return NULL;
+    }
+    if(!(X = xsurf_lookup(id))){
+        return NULL;
+    }
+    X->L.level = level;
+    if(background){
+        if(!job_submit(id)){
+            return NULL;
+        }
+        Py_RETURN_NONE;
+    }
+    // the blocks (and the spans) may still be in use by a job
+    if(!(X = xsurf_wait(id)) || !xsurf_hold(id)){
+        return NULL;
+    }
+
+    // extract into a new mesh, as in xsurf_refresh
+    L = X->L;
+    B = X->B;
+    memset(&mesh, 0, sizeof(S2PY_MESH));
+    mesh.col = X->mesh.col;
+    Py_BEGIN_ALLOW_THREADS
+    ok = (B.min != NULL || blocks_build(&L, &B, S2PY_XS_BLOCK)) && surface_extract(&L, &B, &mesh);
+    Py_END_ALLOW_THREADS
+    xsurf_release(id);
+    X = &xsurfList[id];
+    // a background build may have summarised the blocks meanwhile
+    if(X->B.min == NULL || X->B.min == B.min) X->B = B;
+    else                                      blocks_free(&B);
+    if(!ok){
+        mesh_free(&mesh);
+        return PyErr_NoMemory();
+    }
+    xsurf_show(X, &mesh);
+
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_ss2qc(PyObject *self, PyObject *args){
-    PyObject *resultTuple, *positionOut, *upOut, *vdirOut;
-    int worldcoords;
-    XYZ position, up, vdir;
-    
-    if(!PyArg_ParseTuple(args,"i:ss2qc",&worldcoords)){
+static PyObject *s2plot_ns2dxs(PyObject *self, PyObject *args){
+    S2PY_XSURF *X;
+    int id, busy;
+
+    if(!PyArg_ParseTuple(args, "i:ns2dxs", &id)){
         return NULL;
     }
-    
-    ss2qc(&position, &up, &vdir, worldcoords);
-    
-    resultTuple = (PyObject *) PyTuple_New(3);
-    if(resultTuple == NULL) return NULL;
-    
-    if(!(positionOut = XYZ_to_Dict(position))) return NULL;
-    if(!(upOut = XYZ_to_Dict(up))) return NULL;
-    if(!(vdirOut = XYZ_to_Dict(vdir))) return NULL;
-        
-    PyTuple_SetItem(resultTuple,0,positionOut);
-    PyTuple_SetItem(resultTuple,1,upOut);
-    PyTuple_SetItem(resultTuple,2,vdirOut);
-    Py_INCREF(resultTuple);
-    
-    return resultTuple;
-}
-static PyObject *s2plot_ss2sas(PyObject *self, PyObject *args){
-    int startstop;
-    
-    if(!PyArg_ParseTuple(args, "i:ss2sas", &startstop)){
+    if(!(X = xsurf_lookup(id))){
         return NULL;
     }
-    
-    ss2sas(startstop);
-    
+    jobs_collect();
+    pthread_mutex_lock(&jobPool.lock);
+    busy = id < jobPool.nbusy ? jobPool.busy[id] : 0;
+    pthread_mutex_unlock(&jobPool.lock);
+    // a refresh would wait for the work in flight and stall the frame, so the
+    // marks are kept for a later frame and the current mesh is drawn
+    if(X->B.nstale > 0 && busy == 0 && X->pending == 0 && xsurf_refresh(id, 0) < 0){
+        return NULL;
+    }
+    // the GIL is kept so no other thread can replace or free the mesh while
+    // it is drawn
+    mesh_draw(&xsurfList[id].mesh);
+
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_ss2scf(PyObject *self, PyObject *args){
-    XYZ position;
-    int worldcoords;
-    PyObject *positionIn;
-    
-    if(!PyArg_ParseTuple(args, "Oi:ss2scf", &positionIn, &worldcoords) ||
-       !positionIn)
+static PyObject *s2plot_ns2qxs(PyObject *self, PyObject *args){
+    S2PY_XSURF *X;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ns2qxs", &id)){
+        return NULL;
+    }
+    if(!(X = xsurf_lookup(id))){
         return NULL;
+    }
+    jobs_collect();
 
-    position = Dict_to_XYZ(positionIn);
+    return PyBool_FromLong((long) (X->pending == 0));
+}
+static PyObject *s2plot_ns2wxs(PyObject *self, PyObject *args){
+    int id;
 
-    ss2scf(position, worldcoords);
+    if(!PyArg_ParseTuple(args, "i:ns2wxs", &id)){
+        return NULL;
+    }
+    if(!xsurf_wait(id)){
+        return NULL;
+    }
 
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_ss2ucf(PyObject *self, PyObject *args){
-    ss2ucf();
+static PyObject *s2plot_ns2fxs(PyObject *self, PyObject *args){
+    S2PY_XSURF *X;
+    int id;
+
+    if(!PyArg_ParseTuple(args, "i:ns2fxs", &id)){
+        return NULL;
+    }
+    // its jobs still read the grid
+    if(!(X = xsurf_wait(id))){
+        return NULL;
+    }
+    xsurf_free(X);
 
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_ss2sca(PyObject *self, PyObject *args){ /* NEW */
-    float aperture;
+static PyObject *s2plot_ns2mxs(PyObject *self, PyObject *args){
+    S2PY_XSURF *X;
+    int id, lo[3], hi[3];
 
-    if(!PyArg_ParseTuple(args, "f:ss2sca", &aperture))
-      return NULL;
-    ss2sca(aperture);
+    if(!PyArg_ParseTuple(args, "iiiiiii:ns2mxs", &id, &lo[0], &hi[0], &lo[1], &hi[1], &lo[2], &hi[2])){
+        return NULL;
+    }
+    // a background build summarises the grid as it finds it, and a refresh
+    // clears the marks
+    if(!(X = xsurf_wait(id))){
+        return NULL;
+    }
+    if(X->B.min != NULL) blocks_mark(&X->L, &X->B, lo, hi);
 
     Py_INCREF(Py_None);
     return Py_None;
 }
-static PyObject *s2plot_ss2qca(PyObject *self, PyObject *args){ /* NEW */
-    PyObject *result;
-
-    result = PyFloat_FromDouble((double) ss2qca());
+static PyObject *s2plot_ns2uxs(PyObject *self, PyObject *args){
+    S2PY_XSURF *X;
+    int id, scan = 0;
+    long changed;
 
-    Py_INCREF(result);
-    return result;
-}
-static PyObject *s2plot_ss2sss(PyObject *self, PyObject *args){
-    float spd;
-    
-    if(!PyArg_ParseTuple(args, "f:ss2sss", &spd)){
+    if(!PyArg_ParseTuple(args, "i|i:ns2uxs", &id, &scan)){
         return NULL;
     }
-    
-    ss2sss(spd);
-    
-    Py_INCREF(Py_None);
-    return Py_None;
+    if(!(X = xsurf_lookup(id))){
+        return NULL;
+    }
+    if((changed = xsurf_refresh(id, scan)) < 0){
+        return NULL;
+    }
+
+    return PyInt_FromLong(changed);
 }
-static PyObject *s2plot_ss2qss(PyObject *self, PyObject *args){
-    PyObject *result;
 
-    result = PyFloat_FromDouble((double) ss2qss());
+// volume renders read their grid in place, so the binding keeps a block
+// checksum summary of it to tell whether the textures need reloading
+typedef struct {
+    int vrid;
+    PyArrayObject *grid;    // NULL marks a free slot
+    S2PY_LATTICE L;
+    S2PY_BLOCKS B;          // built by the first ds2dvr(vrid, -1)
+} S2PY_VRGRID;
+static S2PY_VRGRID *vrGrids = NULL;
+static int nVrGrids = 0;
+
+static S2PY_VRGRID *vrgrid_lookup(int vrid){
+    int i;
 
-    Py_INCREF(result);
-    return result;
-}
-static PyObject *s2plot_ss2scs(PyObject *self, PyObject *args){ /* NEW */
-    float spd;
-    
-    if(!PyArg_ParseTuple(args, "f:ss2scs", &spd)){
-        return NULL;
+    for(i = 0; i < nVrGrids; i++){
+        if(vrGrids[i].grid != NULL && vrGrids[i].vrid == vrid) return &vrGrids[i];
     }
-    
-    ss2scs(spd);
-    
-    Py_INCREF(Py_None);
-    return Py_None;
+    return NULL;
 }
-static PyObject *s2plot_ss2qcs(PyObject *self, PyObject *args){ /* NEW */
-    PyObject *result;
+static void vrgrid_track(int vrid, PyArrayObject *gridIn, int a1, int a2, int b1, int b2, int c1, int c2){
+    // remember a float32 grid read in place by volume render vrid; anything
+    // else was copied and cannot change. Never sets a python error.
+    S2PY_VRGRID V, *grown;
+    int i;
 
-    result = PyFloat_FromDouble((double) ss2qcs());
+    if(PyArray_TYPE(gridIn) != PyArray_FLOAT || !PyArray_ISNOTSWAPPED(gridIn) || PyArray_NDIM(gridIn) != 3 || PyArray_STRIDE(gridIn, 2) != sizeof(float)) return;
+    memset(&V, 0, sizeof(S2PY_VRGRID));
+    V.vrid = vrid;
+    V.grid = grid_from_array((PyObject *) gridIn, &V.L.grid, 1., 0.);
+    if(!lattice_init(&V.L, a1, a2, b1, b2, c1, c2, Py_None, 0., 1)){
+        Py_DECREF(V.grid);
+        PyErr_Clear();
+        return;
+    }
+    for(i = 0; i < nVrGrids && vrGrids[i].grid != NULL && vrGrids[i].vrid != vrid; i++);
+    if(i < nVrGrids && vrGrids[i].grid != NULL){
+        Py_DECREF(vrGrids[i].grid);
+        blocks_free(&vrGrids[i].B);
+    } else if(i == nVrGrids){
+        if(!(grown = (S2PY_VRGRID *) realloc(vrGrids, (size_t) (nVrGrids + 1)*sizeof(S2PY_VRGRID)))){
+            Py_DECREF(V.grid);
+            return;
+        }
+        vrGrids = grown;
+        nVrGrids++;
+    }
+    vrGrids[i] = V;
+}
+static int vrgrid_changed(int vrid){
+    // for ds2dvr(vrid, -1): whether the grid changed since the last check,
+    // looking only at the marked blocks if there are any. Untracked grids
+    // and the first check count as changed.
+    S2PY_VRGRID *V = vrgrid_lookup(vrid);
+    int changed = 1;
 
-    Py_INCREF(result);
-    return result;
+    // the GIL is kept: V points into vrGrids, which ns2cvr may grow, and
+    // ns2mvr writes the marks being cleared here
+    if(V == NULL) return 1;
+    if(V->B.min == NULL){
+        blocks_build(&V->L, &V->B, S2PY_VR_BLOCK);
+        return 1;
+    }
+    changed = blocks_refresh(&V->L, &V->B, V->B.nstale == 0) > 0;
+    return changed;
 }
-static PyObject *s2plot_ss2tc(PyObject *self, PyObject *args){
-    int enabledisable;
+static PyObject *s2plot_ns2mvr(PyObject *self, PyObject *args){
+    S2PY_VRGRID *V;
+    int vrid, lo[3], hi[3];
 
-    if(!PyArg_ParseTuple(args,"i:ss2tc",&enabledisable)){
+    if(!PyArg_ParseTuple(args, "iiiiiii:ns2mvr", &vrid, &lo[0], &hi[0], &lo[1], &hi[1], &lo[2], &hi[2])){
         return NULL;
     }
-    
-    ss2tc(enabledisable);
-    
+    // before the first check everything counts as changed anyway
+    if((V = vrgrid_lookup(vrid)) != NULL && V->B.min != NULL){
+        blocks_mark(&V->L, &V->B, lo, hi);
+    }
+
     Py_INCREF(Py_None);
     return Py_None;
-
 }
-static PyObject *s2plot_ss2qess(PyObject *self, PyObject *args){
-    PyObject *result;
+// MEMORY-MAPPED CUBES
+// files are mapped read-only and wrapped in numpy arrays of their own dtype
+// and byte order, so nothing is read until a grid element is touched; the
+// mapping goes away with the last array using it
+typedef struct {
+    void *addr;
+    size_t len;
+} S2PY_MAPPING;
 
-    result = PyFloat_FromDouble((double) ss2qess());
+static void mapping_release(PyObject *capsule){
+    S2PY_MAPPING *m = (S2PY_MAPPING *) PyCapsule_GetPointer(capsule, "s2plot.mapping");
 
-    Py_INCREF(result);
-    return result;
+    munmap(m->addr, m->len);
+    free(m);
 }
-static PyObject *s2plot_ss2sess(PyObject *self, PyObject *args){
-    float sep;
-    
-    if(!PyArg_ParseTuple(args, "f:ss2sess", &sep)){
+static PyObject *mapping_open(const char *filename, const char **data, size_t *len){
+    // map filename; returns the capsule owning the mapping, or NULL with the
+    // python error set
+    S2PY_MAPPING *m;
+    PyObject *capsule;
+    struct stat st;
+    void *addr;
+    int fd;
+
+    if((fd = open(filename, O_RDONLY)) < 0){
+        return PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char *) filename);
+    }
+    if(fstat(fd, &st) != 0 || st.st_size == 0){
+        close(fd);
+        PyErr_Format(PyExc_IOError, "cannot map empty or unreadable file %s", filename);
         return NULL;
     }
-    
-    ss2sess(sep);
-    
-    Py_INCREF(Py_None);
-    return Py_None;
+    addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED){
+        return PyErr_SetFromErrnoWithFilename(PyExc_IOError, (char *) filename);
+    }
+    if(!(m = (S2PY_MAPPING *) malloc(sizeof(S2PY_MAPPING)))){
+        munmap(addr, (size_t) st.st_size);
+        return PyErr_NoMemory();
+    }
+    m->addr = addr;
+    m->len = (size_t) st.st_size;
+    if(!(capsule = PyCapsule_New(m, "s2plot.mapping", mapping_release))){
+        munmap(addr, m->len);
+        free(m);
+        return NULL;
+    }
+    *data = (const char *) addr;
+    *len = m->len;
+    return capsule;
 }
-// ADDITIONAL PRIMITIVES
-static PyObject *s2plot_s2chromapts(PyObject *self, PyObject *args){
-    int n;
-    float *ilong, *lat, *dist, *size, radius, dmin, dmax;
-    PyArrayObject *ilongIn, *latIn, *distIn, *sizeIn;
-
-    // parse the args into numpy array objects
-    if(!PyArg_ParseTuple(args,"iO!O!O!O!fff:s2chromapts",&n, &PyArray_Type,
-                         &ilongIn, &PyArray_Type, &latIn, &PyArray_Type,
-                         &distIn, &PyArray_Type, &sizeIn, &radius, &dmin, 
-                         &dmax) || !ilongIn || !latIn || !distIn || !sizeIn)
-      return NULL;
-
+static int cube_fits(const npy_intp *dims, size_t elsize, size_t avail){
+    // whether a dims[0] x dims[1] x dims[2] cube of elsize-byte elements
+    // fits in avail bytes, dividing rather than multiplying so that huge
+    // dimensions cannot overflow
+    size_t n;
+    int k;
 
-    if(!(ilong = numpy1D_to_float(ilongIn))) {return NULL;}
-    if(!(lat = numpy1D_to_float(latIn)))
-      numpy_free(ilongIn, ilong); return NULL;
+    if(elsize < 1) return 0;
+    n = avail/elsize;
+    for(k = 0; k < 3; k++){
+        if(dims[k] < 1 || (size_t) dims[k] > n) return 0;
+        n /= (size_t) dims[k];
+    }
+    return 1;
+}
+static PyObject *mapping_cube(PyObject *capsule, const char *data, size_t len, size_t offset, PyArray_Descr *descr, npy_intp *dims){
+    // a read-only C-order 3D array over the mapping, starting at offset;
+    // steals descr
+    PyObject *arr;
 
-    if(!(dist = numpy1D_to_float(distIn))){
-        numpy_free(ilongIn, ilongIn);
-        numpy_free(latIn, lat);
+    if(offset > len || !cube_fits(dims, (size_t) descr->elsize, len - offset)){
+        PyErr_Format(PyExc_ValueError, "%ldx%ldx%ld cube of %d-byte elements at offset %lu does not fit in %lu bytes", (long) dims[0], (long) dims[1], (long) dims[2], descr->elsize, (unsigned long) offset, (unsigned long) len);
+        Py_DECREF(descr);
         return NULL;
     }
-    if(!(size = numpy1D_to_float(sizeIn))){
-        numpy_free(ilongIn, ilongIn);
-        numpy_free(latIn, lat);
-        numpy_free(distIn, dist);
+    if(!(arr = PyArray_NewFromDescr(&PyArray_Type, descr, 3, dims, NULL, (void *) (data + offset), NPY_C_CONTIGUOUS | ((offset % descr->elsize) ? 0 : NPY_ALIGNED), NULL))){
         return NULL;
     }
-
-    s2chromapts(n, ilong, lat, dist, size, radius, dmin, dmax);
-
-    numpy_free(ilongIn, ilong);
-    numpy_free(latIn, lat);
-    numpy_free(distIn, dist);
-    numpy_free(sizeIn, size);
-
-    Py_INCREF(Py_None);
-    return Py_None;
-}
-static PyObject *s2plot_s2chromacpts(PyObject *self, PyObject *args){
-    int n;
-    float *ix, *iy, *iz, *dist, *size, dmin, dmax;
-    PyArrayObject *ixIn, *iyIn, *izIn, *distIn, *sizeIn;
-    
-    // parse the args into numpy array objects
-    if(!PyArg_ParseTuple(args,"iO!O!O!O!O!ff:s2chromacpts",&n, &PyArray_Type, &ixIn, &PyArray_Type, &iyIn, &PyArray_Type, &izIn, &PyArray_Type, &distIn, &PyArray_Type, &sizeIn, &dmin, &dmax) || NULL == ixIn || NULL == iyIn || NULL == izIn || NULL == distIn || NULL == sizeIn){
+    Py_INCREF(capsule);
+    if(PyArray_SetBaseObject((PyArrayObject *) arr, capsule) < 0){
+        Py_DECREF(arr);
         return NULL;
     }
+    return arr;
+}
+static int fits_card(const char *card, const char *key, double *value){
+    // whether the 80-character card sets keyword key, and its numeric value
+    char buf[71], *d;
+    size_t k = strlen(key);
 
-    if(!(ix = numpy1D_to_float(ixIn))) {return NULL;}
-    if(!(iy = numpy1D_to_float(iyIn))){
-        numpy_free(ixIn, ix);
+    if(strncmp(card, key, k) != 0 || (k < 8 && strspn(card + k, " ") < 8 - k) || card[8] != '='){
+        return 0;
+    }
+    memcpy(buf, card + 10, 70);
+    buf[70] = '\0';
+    // fortran double exponents
+    for(d = buf; *d && *d != '/'; d++) if(*d == 'D') *d = 'E';
+    *value = strtod(buf, NULL);
+    return 1;
+}
+static const char *fits_header(const char *data, size_t len, int *type, npy_intp *dims, double *scale, double *offset, size_t *start){
+    // parse the primary header of a mapped FITS file holding a cube: its
+    // (big-endian) element type, numpy shape, BSCALE, BZERO and where the
+    // data starts. Returns NULL, or what is wrong. Needs no python objects.
+    const char *card;
+    size_t pos, end = 0;
+    double v, bitpix = 0, naxis = -1, naxes[16];
+    int k;
+
+    if(len < 2880 || strncmp(data, "SIMPLE  =", 9) != 0){
+        return "not a FITS file";
+    }
+    for(k = 0; k < 16; k++) naxes[k] = 1;
+    *scale = 1.;
+    *offset = 0.;
+    for(pos = 0; pos + 80 <= len && !end; pos += 80){
+        card = data + pos;
+        if(strncmp(card, "END", 3) == 0 && strspn(card + 3, " ") >= 77){
+            end = (pos/2880 + 1)*2880;
+        } else if(fits_card(card, "BITPIX", &v)){
+            bitpix = v;
+        } else if(fits_card(card, "NAXIS", &v)){
+            naxis = v;
+        } else if(strncmp(card, "NAXIS", 5) == 0 && (k = atoi(card + 5)) >= 1 && k <= 16){
+            char key[9];
+            sprintf(key, "NAXIS%d", k);
+            if(fits_card(card, key, &v)) naxes[k - 1] = v;
+        } else if(fits_card(card, "BSCALE", &v)){
+            *scale = v;
+        } else if(fits_card(card, "BZERO", &v)){
+            *offset = v;
+        }
+    }
+    // a cube, possibly with trailing axes of length 1
+    if(!end || !(naxis >= 3 && naxis <= 16) || naxis != (int) naxis){
+        return "primary HDU is not a data cube";
+    }
+    for(k = 0; k < (int) naxis; k++){
+        if(!(naxes[k] >= 1 && naxes[k] <= INT_MAX) || naxes[k] != (int) naxes[k]){
+            return "bad NAXISn value";
+        }
+    }
+    for(k = 3; k < (int) naxis && naxes[k] == 1; k++);
+    if(k < (int) naxis){
+        return "primary HDU is not a data cube";
+    }
+    if(!(bitpix >= -64 && bitpix <= 64) || bitpix != (int) bitpix){
+        return "unsupported BITPIX";
+    }
+    switch((int) bitpix){
+        case 8:   *type = PyArray_UBYTE;  break;
+        case 16:  *type = PyArray_SHORT;  break;
+        case 32:  *type = PyArray_INT;    break;
+        case -32: *type = PyArray_FLOAT;  break;
+        case -64: *type = PyArray_DOUBLE; break;
+        default:  return "unsupported BITPIX";
+    }
+    // NAXIS1 varies fastest, so it is the last numpy axis
+    dims[0] = (npy_intp) naxes[2];
+    dims[1] = (npy_intp) naxes[1];
+    dims[2] = (npy_intp) naxes[0];
+    if(end > len || !cube_fits(dims, (size_t) element_size(*type), len - end)){
+        return "file is shorter than its data cube";
+    }
+    *start = end;
+    return NULL;
+}
+static PyObject *s2plot_ss2mfits(PyObject *self, PyObject *args){
+    const char *filename, *data, *problem;
+    size_t len, start;
+    PyObject *capsule, *arr, *result;
+    PyArray_Descr *descr;
+    npy_intp dims[3];
+    double scale, offset;
+    int type;
+
+    if(!PyArg_ParseTuple(args, "s:ss2mfits", &filename)){
         return NULL;
     }
-    if(!(iz = numpy1D_to_float(izIn))) {
-        numpy_free(ixIn, ix);
-        numpy_free(iyIn, iy);
+    if(!(capsule = mapping_open(filename, &data, &len))){
         return NULL;
     }
-    if(!(dist = numpy1D_to_float(distIn))) {
-        numpy_free(ixIn, ix);
-        numpy_free(iyIn, iy);
-        numpy_free(izIn, iz);
+    if((problem = fits_header(data, len, &type, dims, &scale, &offset, &start)) != NULL){
+        Py_DECREF(capsule);
+        PyErr_Format(PyExc_ValueError, "%s: %s", filename, problem);
         return NULL;
     }
-    if(!(size = numpy1D_to_float(sizeIn))) {
-        numpy_free(ixIn, ix);
-        numpy_free(iyIn, iy);
-        numpy_free(izIn, iz);
-        numpy_free(distIn, dist);
+    descr = PyArray_DescrNewByteorder(PyArray_DescrFromType(type), NPY_BIG);
+    arr = mapping_cube(capsule, data, len, start, descr, dims);
+    Py_DECREF(capsule);
+    if(!arr){
         return NULL;
     }
 
-    s2chromacpts(n, ix, iy, iz, dist, size, dmin, dmax);
+    result = Py_BuildValue("(Ndd)", arr, scale, offset);
+    return result;
+}
+static PyObject *s2plot_ss2mraw(PyObject *self, PyObject *args){
+    const char *filename, *data;
+    size_t len;
+    long offset = 0;
+    int adim, bdim, cdim;
+    PyObject *dtypeIn, *capsule, *arr;
+    PyArray_Descr *descr;
+    npy_intp dims[3];
+
+    if(!PyArg_ParseTuple(args, "siiiO|l:ss2mraw", &filename, &adim, &bdim, &cdim, &dtypeIn, &offset)){
+        return NULL;
+    }
+    if(!PyArray_DescrConverter(dtypeIn, &descr)){
+        return NULL;
+    }
+    if(offset < 0){
+        Py_DECREF(descr);
+        PyErr_SetString(PyExc_ValueError, "offset must not be negative");
+        return NULL;
+    }
+    if(!(capsule = mapping_open(filename, &data, &len))){
+        Py_DECREF(descr);
+        return NULL;
+    }
+    dims[0] = adim;
+    dims[1] = bdim;
+    dims[2] = cdim;
+    arr = mapping_cube(capsule, data, len, (size_t) offset, descr, dims);
+    Py_DECREF(capsule);
+
+    return arr;
+}
+
+// TIME SERIES VOLUMES
+// a series of cube files played through one volume render. A prefetch thread
+// decodes the frames after the current one (in the direction of play) into a
+// ring of float slabs; stepping re-points the row index handed to ns2cvr at
+// the slab holding the new frame, so nothing is copied on the main thread.
+enum {S2PY_SLOT_EMPTY, S2PY_SLOT_LOADING, S2PY_SLOT_READY, S2PY_SLOT_FAILED};
+typedef struct {
+    char **files;
+    int nframes;
+    int fits;               // else raw files of the type below
+    int type, swap;
+    size_t start;           // header bytes of raw files
+    float scale, offset;    // of raw files; FITS files use their own
+    npy_intp dims[3];
+    int nslots;
+    float **slabs;
+    int *slotFrame, *slotState;
+    int current, direction;
+    int shown;              // slot the index points at, -1 for none
+    float ***index;
+    pthread_mutex_t lock;
+    pthread_cond_t work, done;
+} S2PY_SERIES;
+static S2PY_SERIES **seriesList = NULL;
+static int nSeries = 0;
+
+static int native_big_endian(void){
+    const unsigned short one = 1;
+
+    return *(const unsigned char *) &one == 0;
+}
+static int series_frame(const S2PY_SERIES *S, int d){
+    // the frame d steps ahead of the current one, wrapping around
+    return ((S->current + d*S->direction) % S->nframes + S->nframes) % S->nframes;
+}
+static int series_rank(const S2PY_SERIES *S, int frame){
+    // how far ahead a frame is needed; the window is one frame per slot
+    int d, window = S->nslots < S->nframes ? S->nslots : S->nframes;
+
+    if(frame < 0) return window + 1;
+    for(d = 0; d < window; d++){
+        if(series_frame(S, d) == frame) return d;
+    }
+    return window;
+}
+static int series_slot(const S2PY_SERIES *S, int frame){
+    int k;
+
+    for(k = 0; k < S->nslots; k++){
+        if(S->slotState[k] != S2PY_SLOT_EMPTY && S->slotFrame[k] == frame) return k;
+    }
+    return -1;
+}
+static int series_decode(const S2PY_SERIES *S, int frame, float *slab){
+    // read and convert one frame; returns 0 on failure. Needs no python
+    // objects.
+    const char *data;
+    size_t len, start = S->start;
+    npy_intp dims[3], rows = S->dims[0]*S->dims[1], row;
+    double scale = S->scale, offset = S->offset;
+    int fd, type = S->type, swap = S->swap, size, ok = 1;
+    struct stat st;
+    void *addr;
+
+    if((fd = open(S->files[frame], O_RDONLY)) < 0) return 0;
+    if(fstat(fd, &st) != 0 || st.st_size == 0){
+        close(fd);
+        return 0;
+    }
+    len = (size_t) st.st_size;
+    addr = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(addr == MAP_FAILED) return 0;
+    madvise(addr, len, MADV_SEQUENTIAL);
+    data = (const char *) addr;
+
+    if(S->fits){
+        ok = fits_header(data, len, &type, dims, &scale, &offset, &start) == NULL && dims[0] == S->dims[0] && dims[1] == S->dims[1] && dims[2] == S->dims[2];
+        swap = !native_big_endian();
+    }
+    size = element_size(type);
+    if(ok && start <= len && (size_t) rows*S->dims[2]*size <= len - start){
+        #pragma omp parallel for schedule(static)
+        for(row = 0; row < rows; row++){
+            scaled_row_to_float(data + start + (size_t) row*S->dims[2]*size, size, type, swap, (float) scale, (float) offset, slab + row*S->dims[2], S->dims[2]);
+        }
+    } else {
+        ok = 0;
+    }
+    munmap(addr, len);
+    return ok;
+}
+static void *series_prefetch(void *arg){
+    S2PY_SERIES *S = (S2PY_SERIES *) arg;
+    int d, f = 0, k, rank, slot, window, ok;
+
+    pthread_mutex_lock(&S->lock);
+    for(;;){
+        // the nearest frame of the window not yet in a slot, and the slot
+        // holding the frame needed least (never the one on show)
+        window = S->nslots < S->nframes ? S->nslots : S->nframes;
+        slot = -1;
+        for(d = 0; d < window && slot < 0; d++){
+            f = series_frame(S, d);
+            if(series_slot(S, f) >= 0) continue;
+            for(rank = d, k = 0; k < S->nslots; k++){
+                if(k != S->shown && S->slotState[k] != S2PY_SLOT_LOADING && series_rank(S, S->slotState[k] == S2PY_SLOT_EMPTY ? -1 : S->slotFrame[k]) > rank){
+                    rank = series_rank(S, S->slotState[k] == S2PY_SLOT_EMPTY ? -1 : S->slotFrame[k]);
+                    slot = k;
+                }
+            }
+            if(slot < 0) break;
+        }
+        if(slot < 0){
+            pthread_cond_wait(&S->work, &S->lock);
+            continue;
+        }
+        S->slotFrame[slot] = f;
+        S->slotState[slot] = S2PY_SLOT_LOADING;
+        pthread_mutex_unlock(&S->lock);
+
+        ok = series_decode(S, f, S->slabs[slot]);
+
+        pthread_mutex_lock(&S->lock);
+        S->slotState[slot] = ok ? S2PY_SLOT_READY : S2PY_SLOT_FAILED;
+        pthread_cond_broadcast(&S->done);
+    }
+    return NULL;
+}
+static S2PY_SERIES *series_lookup(int id){
+    if(id < 0 || id >= nSeries){
+        PyErr_Format(PyExc_IndexError, "no time series with id %d", id);
+        return NULL;
+    }
+    return seriesList[id];
+}
+static int series_show(S2PY_SERIES *S, int frame){
+    // make frame the current one, waiting (without the GIL) until it is
+    // decoded, and point the index at it. Returns 1 if the frame on show
+    // changed, 0 if not, -1 with the python error set.
+    npy_intp i, m = S->dims[1], l = S->dims[2];
+    int k, state, n = S->nframes, changed = 0;
+
+    Py_BEGIN_ALLOW_THREADS
+    pthread_mutex_lock(&S->lock);
+    if(frame != S->current){
+        if(frame == (S->current + 1) % n) S->direction = 1;
+        else if(frame == (S->current + n - 1) % n) S->direction = -1;
+        else S->direction = frame > S->current ? 1 : -1;
+        S->current = frame;
+        pthread_cond_signal(&S->work);
+    }
+    while((k = series_slot(S, frame)) < 0 || S->slotState[k] == S2PY_SLOT_LOADING){
+        pthread_cond_wait(&S->done, &S->lock);
+    }
+    state = S->slotState[k];
+    if(state == S2PY_SLOT_FAILED){
+        // reported below, once: the slot is freed so the frame is read
+        // again (the file may still have been being written)
+        S->slotState[k] = S2PY_SLOT_EMPTY;
+        pthread_cond_signal(&S->work);
+    } else if(state == S2PY_SLOT_READY && k != S->shown){
+        for(i = 0; i < S->dims[0]*m; i++){
+            S->index[0][i] = S->slabs[k] + i*l;
+        }
+        S->shown = k;
+        changed = 1;
+        // the slot shown before may be reused now
+        pthread_cond_signal(&S->work);
+    }
+    pthread_mutex_unlock(&S->lock);
+    Py_END_ALLOW_THREADS
+
+    if(state == S2PY_SLOT_FAILED){
+        PyErr_Format(PyExc_IOError, "cannot read frame %d (%s) as a %ldx%ldx%ld cube", frame, S->files[frame], (long) S->dims[0], (long) S->dims[1], (long) S->dims[2]);
+        return -1;
+    }
+    return changed;
+}
+static PyObject *s2plot_ss2cts(PyObject *self, PyObject *args){
+    PyObject *filesIn, *dtypeIn = Py_None, *capsule, *item;
+    PyArray_Descr *descr;
+    S2PY_SERIES *S, **grown;
+    const char *data, *problem;
+    size_t len, bytes;
+    double scale = 1., offset = 0.;
+    long skip = 0;
+    int nslots = S2PY_SERIES_RING, adim = 0, bdim = 0, cdim = 0, i, k, ok = 1;
+    float fscale = 1., foffset = 0.;
+    pthread_t thread;
+
+    if(!PyArg_ParseTuple(args, "O|iOiiilff:ss2cts", &filesIn, &nslots, &dtypeIn, &adim, &bdim, &cdim, &skip, &fscale, &foffset)){
+        return NULL;
+    }
+    if(!PySequence_Check(filesIn) || PySequence_Size(filesIn) < 1){
+        PyErr_SetString(PyExc_TypeError, "files must be a non-empty sequence of file names");
+        return NULL;
+    }
+    if(nslots < 2) nslots = 2;
+    if(!(S = (S2PY_SERIES *) calloc(1, sizeof(S2PY_SERIES)))){
+        return PyErr_NoMemory();
+    }
+    S->nframes = (int) PySequence_Size(filesIn);
+    S->nslots = nslots;
+    S->direction = 1;
+    S->shown = -1;
+    S->scale = fscale;
+    S->offset = foffset;
+    if(!(S->files = (char **) calloc((size_t) S->nframes, sizeof(char *)))){
+        free(S);
+        return PyErr_NoMemory();
+    }
+    for(i = 0; i < S->nframes && ok; i++){
+        item = PySequence_GetItem(filesIn, i);
+        data = item ? PyString_AsString(item) : NULL;
+        if(!data || !(S->files[i] = strdup(data))){
+            if(data) PyErr_NoMemory();
+            ok = 0;
+        }
+        Py_XDECREF(item);
+    }
 
-    numpy_free(ixIn, ix);
-    numpy_free(iyIn, iy);
-    numpy_free(izIn, iz);
-    numpy_free(distIn, dist);
-    numpy_free(sizeIn, size);
+    // the frame layout, from the first file for FITS
+    if(ok && dtypeIn == Py_None){
+        S->fits = 1;
+        if(!(capsule = mapping_open(S->files[0], &data, &len))){
+            ok = 0;
+        } else {
+            if((problem = fits_header(data, len, &S->type, S->dims, &scale, &offset, &S->start)) != NULL){
+                PyErr_Format(PyExc_ValueError, "%s: %s", S->files[0], problem);
+                ok = 0;
+            }
+            Py_DECREF(capsule);
+        }
+    } else if(ok){
+        if(!PyArray_DescrConverter(dtypeIn, &descr)){
+            ok = 0;
+        } else {
+            S->type = descr->type_num;
+            S->swap = !PyArray_ISNBO(descr->byteorder);
+            Py_DECREF(descr);
+            S->start = skip < 0 ? 0 : (size_t) skip;
+            S->dims[0] = adim;
+            S->dims[1] = bdim;
+            S->dims[2] = cdim;
+            if(S->type != PyArray_FLOAT && S->type != PyArray_DOUBLE && S->type != PyArray_UBYTE && S->type != PyArray_SHORT && S->type != PyArray_USHORT && S->type != PyArray_INT && S->type != PyArray_HALF){
+                PyErr_SetString(PyExc_ValueError, "dtype must be float32, float64, uint8, int16, uint16, int32 or float16");
+                ok = 0;
+            } else if(adim < 1 || bdim < 1 || cdim < 1){
+                PyErr_SetString(PyExc_ValueError, "raw frames need adim, bdim and cdim");
+                ok = 0;
+            } else if(!cube_fits(S->dims, sizeof(double), (size_t) -1)){
+                // frames are read with elements of up to 8 bytes
+                PyErr_SetString(PyExc_ValueError, "raw frames are too large");
+                ok = 0;
+            }
+        }
+    }
+
+    // the ring, and an index onto it for ns2cvr
+    if(ok){
+        bytes = (size_t) S->dims[0]*S->dims[1]*S->dims[2]*sizeof(float);
+        S->slabs = (float **) calloc((size_t) nslots, sizeof(float *));
+        S->slotFrame = (int *) calloc((size_t) nslots, sizeof(int));
+        S->slotState = (int *) calloc((size_t) nslots, sizeof(int));
+        S->index = (float ***) malloc((size_t) S->dims[0]*sizeof(float **) + (size_t) S->dims[0]*S->dims[1]*sizeof(float *));
+        ok = S->slabs && S->slotFrame && S->slotState && S->index;
+        for(k = 0; ok && k < nslots; k++){
+            ok = (S->slabs[k] = (float *) malloc(bytes)) != NULL;
+        }
+        if(!ok){
+            PyErr_NoMemory();
+        } else {
+            for(i = 0; i < S->dims[0]; i++){
+                S->index[i] = (float **) (S->index + S->dims[0]) + (size_t) i*S->dims[1];
+            }
+        }
+    }
+    if(ok && !(grown = (S2PY_SERIES **) realloc(seriesList, (size_t) (nSeries + 1)*sizeof(S2PY_SERIES *)))){
+        PyErr_NoMemory();
+        ok = 0;
+    } else if(ok){
+        seriesList = grown;
+    }
+    if(ok){
+        pthread_mutex_init(&S->lock, NULL);
+        pthread_cond_init(&S->work, NULL);
+        pthread_cond_init(&S->done, NULL);
+        if(pthread_create(&thread, NULL, series_prefetch, S) != 0){
+            PyErr_SetString(PyExc_RuntimeError, "could not start the prefetch thread");
+            ok = 0;
+        } else {
+            pthread_detach(thread);
+        }
+    }
+    if(!ok){
+        for(i = 0; i < S->nframes; i++) free(S->files[i]);
+        free(S->files);
+        for(k = 0; S->slabs && k < nslots; k++) free(S->slabs[k]);
+        free(S->slabs);
+        free(S->slotFrame);
+        free(S->slotState);
+        free(S->index);
+        free(S);
+        return NULL;
+    }
+    // series are never freed: their index may be held by a volume render
+    seriesList[nSeries] = S;
 
-    Py_INCREF(Py_None);
-    return Py_None;
+    return PyInt_FromLong((long) nSeries++);
 }
-// **FUNCTIONS IN TESTING/DEVELOPMENT
-static PyObject *s2plot_ss2ltt(PyObject *self, PyObject *args){
-    float aspect;
-    char *command;
-    unsigned int tex_id;
-    PyObject *pyResult = NULL;
+static PyObject *s2plot_ss2sts(PyObject *self, PyObject *args){
+    S2PY_SERIES *S;
+    int id, frame, changed;
 
-    if(!PyArg_ParseTuple(args, "s:ss2ltt", &command)){
+    if(!PyArg_ParseTuple(args, "ii:ss2sts", &id, &frame)){
         return NULL;
     }
-    
-    tex_id = ss2ltt(command, &aspect);
-    
-    pyResult = (PyObject *) PyDict_New();
-    if(pyResult == NULL) return NULL;
-    
-    PyDict_SetItemString(pyResult, "texture_id", PyInt_FromLong((long) tex_id));
-    PyDict_SetItemString(pyResult, "aspect", PyFloat_FromDouble((double) aspect));
-    
-    Py_INCREF(pyResult);
-    return pyResult;
-    
-}
-static PyObject *s2plot_ns2vf3a(PyObject *self, PyObject *args){
-    XYZ P[3];
-    COLOUR col;
-    char trans;
-    float alpha;
-    PyObject *PIn, *colIn;
-    int i;
-    
-    if(!(PyArg_ParseTuple(args, "OOsf:ns2vf3a", &PIn, &colIn, &trans, &alpha)) || NULL == PIn || NULL == colIn){
+    if(!(S = series_lookup(id))){
         return NULL;
     }
-
-    for(i = 0; i < 3; i++){
-        P[i] = Dict_to_XYZ(PyList_GetItem(PIn,i));
+    if(frame < 0 || frame >= S->nframes){
+        PyErr_Format(PyExc_IndexError, "frame %d is not in 0..%d", frame, S->nframes - 1);
+        return NULL;
+    }
+    if((changed = series_show(S, frame)) < 0){
+        return NULL;
     }
-    col = Dict_to_COLOUR(colIn);
 
-    ns2vf3a(P, col, trans, alpha);
-    
-    Py_INCREF(Py_None);
-    return Py_None;    
+    return PyBool_FromLong((long) changed);
 }
-static PyObject *s2plot_ns2vpa(PyObject *self, PyObject *args){
-    XYZ P;
-    COLOUR icol;
-    char itrans;
-    float isize, ialpha;
-    PyObject *PIn, *colIn;
-    
-    if(!(PyArg_ParseTuple(args, "OOfsf:ns2vpa", &PIn, &colIn, &isize, &itrans, &ialpha)) || NULL == PIn || NULL == colIn){
+static PyObject *s2plot_ss2qts(PyObject *self, PyObject *args){
+    S2PY_SERIES *S;
+    int id, d, k, ahead = 0;
+
+    if(!PyArg_ParseTuple(args, "i:ss2qts", &id)){
+        return NULL;
+    }
+    if(!(S = series_lookup(id))){
         return NULL;
     }
+    // the frames after the current one that are ready, in order
+    pthread_mutex_lock(&S->lock);
+    for(d = 1; d < S->nslots && d < S->nframes; d++){
+        k = series_slot(S, series_frame(S, d));
+        if(k < 0 || S->slotState[k] != S2PY_SLOT_READY) break;
+        ahead++;
+    }
+    pthread_mutex_unlock(&S->lock);
 
-    P = Dict_to_XYZ(PIn);
-    icol = Dict_to_COLOUR(colIn);
-    
-    ns2vpa(P, icol, isize, itrans, ialpha);
-    
-    Py_INCREF(Py_None);
-    return Py_None;    
+    return Py_BuildValue("(iii)", S->current, S->nframes, ahead);
 }
-static PyObject *s2plot_ns2cis(PyObject *self, PyObject *args){
-    float ***grid, *tr, level, alpha, red, green, blue;
-    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, resolution, id;
+static PyObject *s2plot_ns2cvrts(PyObject *self, PyObject *args){
+    S2PY_SERIES *S;
+    float *tr, datamin, datamax, alphamin, alphamax;
+    int tsid, a1, a2, b1, b2, c1, c2, id;
     char *trans;
-    PyArrayObject *gridIn, *trIn;
-    PyObject *result;
-    
-    // parse the args into numpy array objects
-    if(!PyArg_ParseTuple(args,"O!iiiiiiiiiOfisffff:ns2cis", &PyArray_Type, &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &level, &resolution, &trans, &alpha, &red, &green, &blue) || !gridIn || !trIn){
+    PyArrayObject *trIn;
+
+    if(!PyArg_ParseTuple(args, "iiiiiiiOsffff:ns2cvrts", &tsid, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &trans, &datamin, &datamax, &alphamin, &alphamax)){
+        return NULL;
+    }
+    if(!(S = series_lookup(tsid))){
+        return NULL;
+    }
+    if(series_show(S, S->current) < 0){
         return NULL;
     }
-    if(!(grid = numpy3D_to_float(gridIn))) {return NULL;}
-    // None is allowed as input - for standard tr matrix
     if((PyObject *) trIn == Py_None) {tr = NULL;}
     else if(!(tr = numpy1D_to_float(trIn))){
-        numpy_free(gridIn, grid);
         return NULL;
     }
-    
-    id = ns2cis(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, *trans, alpha, red, green, blue);
 
-    // don't free grid: the memory is used by the surface drawer
-    numpy_free(trIn, tr);
+    id = ns2cvr(S->index, (int) S->dims[0], (int) S->dims[1], (int) S->dims[2], a1, a2, b1, b2, c1, c2, tr, *trans, datamin, datamax, alphamin, alphamax);
+
+    if(tr) numpy_free(trIn, tr);
+
+    return PyInt_FromLong((long) id);
+}
+// VOLUME PYRAMIDS
+// a volume split into bricks of S2PY_VRP_BRICK voxels, each rendered from a
+// mip pyramid of box-filtered copies. Every (level, brick) pair is its own
+// ns2cvr object over its own small float grid, converted from the caller's
+// grid (read in place) the first time it is wanted, so only the bricks and
+// levels actually shown are ever held as floats. A brick spans the same
+// level 0 extent at every level: its level l voxels are spread evenly from
+// one face to the other, about 2^l level 0 voxels apart, and each is the
+// mean of the level 0 voxels within 2^(l-1) of it. Neighbouring bricks share
+// their boundary voxels: ns2cvr only interpolates within its own range, so
+// without the overlap a one-voxel gap shows between bricks.
+typedef struct {
+    int nlevels;
+    PyArrayObject *array;   // the grid read, kept for the pyramid's lifetime
+    S2PY_GRID src;
+    int origin[3];          // of the region within the grid
+    int n[3];               // region size
+    float tr[12];           // level 0 grid to world
+    int nb[3], nbricks;
+    XYZ *centres;           // world positions of the bricks
+    float radius, voxel;    // world size of a brick (half diagonal), voxel
+    int *vrids;             // [level*nbricks + brick], -1 until made
+    int *level;             // level on show per brick
+    unsigned char *target;
+    S2PY_DEPTHSORT sort;
+    char trans;
+    float datamin, datamax, alphamin, alphamax;
+    long budget;            // voxels drawn per frame
+    float pixels;           // screen height, for the projected voxel size
+    XYZ eye, vdir;          // camera of the previous frame
+} S2PY_VRPYR;
+static S2PY_VRPYR *vrpyrList = NULL;
+static int nVrpyrs = 0;
+
+static float ***grid_alloc(const int *dims){
+    // a float grid and its pointer index in one block, or NULL
+    size_t indexBytes = (size_t) dims[0]*sizeof(float **) + (size_t) dims[0]*dims[1]*sizeof(float *);
+    float ***g, **rows, *slab;
+    int i, j;
+
+    indexBytes = (indexBytes + S2PY_ALIGN - 1) & ~((size_t) S2PY_ALIGN - 1);
+    if(posix_memalign((void **) &g, S2PY_ALIGN, indexBytes + (size_t) dims[0]*dims[1]*dims[2]*sizeof(float))){
+        return NULL;
+    }
+    rows = (float **) (g + dims[0]);
+    slab = (float *) ((char *) g + indexBytes);
+    for(i = 0; i < dims[0]; i++){
+        g[i] = rows + (size_t) i*dims[1];
+        for(j = 0; j < dims[1]; j++){
+            g[i][j] = slab + ((size_t) i*dims[1] + j)*dims[2];
+        }
+    }
+    return g;
+}
+static void vrpyr_region(const S2PY_VRPYR *V, int brick, int *lo, int *hi){
+    // the level 0 index range of brick within the region, including the
+    // plane of voxels it shares with the next brick along each axis
+    int k, x[3] = {brick/(V->nb[1]*V->nb[2]), brick/V->nb[2] % V->nb[1], brick % V->nb[2]};
 
-    result = PyInt_FromLong((long) id);
-    Py_INCREF(result);
-    return result;
+    for(k = 0; k < 3; k++){
+        lo[k] = x[k]*S2PY_VRP_BRICK;
+        hi[k] = (x[k] + 1)*S2PY_VRP_BRICK < V->n[k] - 1 ? (x[k] + 1)*S2PY_VRP_BRICK : V->n[k] - 1;
+    }
+}
+static void vrpyr_size(const S2PY_VRPYR *V, int level, int brick, int *m){
+    // voxels along each axis of brick at level: enough to keep them at most
+    // 2^level level 0 voxels apart
+    int k, lo[3], hi[3];
+
+    vrpyr_region(V, brick, lo, hi);
+    for(k = 0; k < 3; k++) m[k] = (hi[k] - lo[k] + (1 << level) - 1)/(1 << level) + 1;
+}
+static long vrpyr_voxels(const S2PY_VRPYR *V, int level, int brick){
+    // voxels rendered for brick at level, counting the shared planes
+    int m[3];
+
+    vrpyr_size(V, level, brick, m);
+    return (long) m[0]*m[1]*m[2];
+}
+static float ***vrpyr_brick(const S2PY_VRPYR *V, int level, int brick, int *m, float *tr){
+    // the float grid of brick at level (m[0] x m[1] x m[2]) and the tr that
+    // places it, or NULL if out of memory. Needs no python objects.
+    int k, j, r, c, h = (1 << level)/2, lo[3], hi[3], *win[3] = {NULL, NULL, NULL}, s0[3], p[3];
+    float ***g = NULL, *buf = NULL, *t2 = NULL, *t1 = NULL, step[3];
+    int i, ok;
+
+    vrpyr_region(V, brick, lo, hi);
+    vrpyr_size(V, level, brick, m);
+    // the window of level 0 voxels averaged for each voxel, along each axis
+    for(ok = 1, k = 0; k < 3; k++){
+        if(!(win[k] = (int *) malloc((size_t) 2*m[k]*sizeof(int)))){
+            ok = 0;
+            break;
+        }
+        step[k] = m[k] > 1 ? (float) (hi[k] - lo[k])/(m[k] - 1) : 0.;
+        for(j = 0; j < m[k]; j++){
+            c = lo[k] + (int) floorf(j*step[k] + 0.5f);
+            win[k][2*j]     = c - h > 0 ? c - h : 0;
+            win[k][2*j + 1] = c + h < V->n[k] - 1 ? c + h : V->n[k] - 1;
+        }
+        s0[k] = win[k][0];
+        p[k] = win[k][2*m[k] - 1] - s0[k] + 1;
+    }
+    if(ok){
+        buf = (float *) malloc((size_t) p[0]*p[1]*p[2]*sizeof(float));
+        t2 = (float *) malloc((size_t) p[0]*p[1]*m[2]*sizeof(float));
+        t1 = (float *) malloc((size_t) p[0]*m[1]*m[2]*sizeof(float));
+        g = grid_alloc(m);
+        ok = buf && t2 && t1 && g;
+    }
+    if(ok){
+        // the source block, then the means along c, b and a in turn
+        #pragma omp parallel for private(j) schedule(static) if((long) p[0]*p[1]*p[2] >= S2PY_OMP_THRESHOLD)
+        for(i = 0; i < p[0]; i++){
+            for(j = 0; j < p[1]; j++){
+                scaled_row_to_float(V->src.data + (npy_intp) (V->origin[0] + s0[0] + i)*V->src.stride[0] + (npy_intp) (V->origin[1] + s0[1] + j)*V->src.stride[1] + (npy_intp) (V->origin[2] + s0[2])*V->src.stride[2],
+                                    V->src.stride[2], V->src.type, V->src.swap, V->src.scale, V->src.offset, buf + ((size_t) i*p[1] + j)*p[2], p[2]);
+            }
+        }
+        #pragma omp parallel for private(j, k, r) schedule(static) if((long) p[0]*p[1]*p[2] >= S2PY_OMP_THRESHOLD)
+        for(i = 0; i < p[0]*p[1]; i++){
+            const float *row = buf + (size_t) i*p[2];
+            float sum;
+            for(k = 0; k < m[2]; k++){
+                for(sum = 0., r = win[2][2*k]; r <= win[2][2*k + 1]; r++) sum += row[r - s0[2]];
+                t2[(size_t) i*m[2] + k] = sum/(win[2][2*k + 1] - win[2][2*k] + 1);
+            }
+        }
+        #pragma omp parallel for private(j, k, r) schedule(static) if((long) p[0]*p[1]*m[2] >= S2PY_OMP_THRESHOLD)
+        for(i = 0; i < p[0]; i++){
+            float sum;
+            for(j = 0; j < m[1]; j++){
+                for(k = 0; k < m[2]; k++){
+                    for(sum = 0., r = win[1][2*j]; r <= win[1][2*j + 1]; r++) sum += t2[((size_t) i*p[1] + r - s0[1])*m[2] + k];
+                    t1[((size_t) i*m[1] + j)*m[2] + k] = sum/(win[1][2*j + 1] - win[1][2*j] + 1);
+                }
+            }
+        }
+        #pragma omp parallel for private(j, k, r) schedule(static) if((long) p[0]*m[1]*m[2] >= S2PY_OMP_THRESHOLD)
+        for(i = 0; i < m[0]; i++){
+            float sum;
+            for(j = 0; j < m[1]; j++){
+                for(k = 0; k < m[2]; k++){
+                    for(sum = 0., r = win[0][2*i]; r <= win[0][2*i + 1]; r++) sum += t1[((size_t) (r - s0[0])*m[1] + j)*m[2] + k];
+                    g[i][j][k] = sum/(win[0][2*i + 1] - win[0][2*i] + 1);
+                }
+            }
+        }
+        // voxel (i,j,k) sits at level 0 index origin + lo + (i,j,k)*step
+        for(r = 0; r < 3; r++){
+            tr[4*r] = V->tr[4*r];
+            for(k = 0; k < 3; k++){
+                tr[4*r] += V->tr[4*r + 1 + k]*(V->origin[k] + lo[k]);
+                tr[4*r + 1 + k] = V->tr[4*r + 1 + k]*step[k];
+            }
+        }
+    } else {
+        free(g);
+        g = NULL;
+    }
+    for(k = 0; k < 3; k++) free(win[k]);
+    free(buf);
+    free(t2);
+    free(t1);
+    return g;
+}
+static int vrpyr_render(S2PY_VRPYR *V, int level, int brick, float ***g, const int *m, float *tr){
+    // the volume render of brick at level over its float grid g; the render
+    // keeps g
+    int *id = &V->vrids[level*V->nbricks + brick];
+
+    *id = ns2cvr(g, m[0], m[1], m[2], 0, m[0] - 1, 0, m[1] - 1, 0, m[2] - 1, tr, V->trans, V->datamin, V->datamax, V->alphamin, V->alphamax);
+    return *id;
+}
+static int vrpyr_make(S2PY_VRPYR *V, int level, int brick){
+    // the volume render of brick at level, made if need be; -1 if out of
+    // memory
+    float ***g, tr[12];
+    int m[3];
+
+    if(V->vrids[level*V->nbricks + brick] >= 0){
+        return V->vrids[level*V->nbricks + brick];
+    }
+    if(!(g = vrpyr_brick(V, level, brick, m, tr))){
+        return -1;
+    }
+    return vrpyr_render(V, level, brick, g, m, tr);
+}
+static int vrpyr_range(const S2PY_VRPYR *V, float *lo, float *hi){
+    // the range of the region's values; returns 0 if out of memory. Needs no
+    // python objects.
+    float vmin = 0., vmax = 0.;
+    int i, ok = 1;
+
+    scaled_row_to_float(V->src.data + (npy_intp) V->origin[0]*V->src.stride[0] + (npy_intp) V->origin[1]*V->src.stride[1] + (npy_intp) V->origin[2]*V->src.stride[2],
+                        V->src.stride[2], V->src.type, V->src.swap, V->src.scale, V->src.offset, &vmin, 1);
+    vmax = vmin;
+    #pragma omp parallel for reduction(min:vmin) reduction(max:vmax) reduction(&&:ok) schedule(static)
+    for(i = 0; i < V->n[0]; i++){
+        float *row = (float *) malloc((size_t) V->n[2]*sizeof(float));
+        int j, k;
+        if(!row){
+            ok = 0;
+            continue;
+        }
+        for(j = 0; j < V->n[1]; j++){
+            scaled_row_to_float(V->src.data + (npy_intp) (V->origin[0] + i)*V->src.stride[0] + (npy_intp) (V->origin[1] + j)*V->src.stride[1] + (npy_intp) V->origin[2]*V->src.stride[2],
+                                V->src.stride[2], V->src.type, V->src.swap, V->src.scale, V->src.offset, row, V->n[2]);
+            for(k = 0; k < V->n[2]; k++){
+                if(row[k] < vmin) vmin = row[k];
+                if(row[k] > vmax) vmax = row[k];
+            }
+        }
+        free(row);
+    }
+    *lo = vmin;
+    *hi = vmax;
+    return ok;
+}
+static void vrpyr_free(S2PY_VRPYR *V){
+    // for a failed build only: made objects hold their grids
+    Py_XDECREF(V->array);
+    free(V->centres);
+    free(V->vrids);
+    free(V->level);
+    free(V->target);
+    depth_sort_free(&V->sort);
+}
+static PyObject *s2plot_ns2cvrp(PyObject *self, PyObject *args){
+    S2PY_VRPYR V, *grown;
+    float *tr = NULL, unit[12] = {0., 1., 0., 0., 0., 0., 1., 0., 0., 0., 0., 1.}, base, *trs = NULL;
+    float datamin, datamax, alphamin, alphamax, ****grids = NULL;
+    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, id, b, k, top, *dims = NULL, ok = 1;
+    char *trans;
+    double pixels = 1024.;
+    long budget = S2PY_VRP_BUDGET;
+    PyObject *gridIn;
+    PyArrayObject *trIn;
+
+    if(!PyArg_ParseTuple(args, "OiiiiiiiiiOsffff|ld:ns2cvrp", &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &trans, &datamin, &datamax, &alphamin, &alphamax, &budget, &pixels) || !gridIn || !trIn){
+        return NULL;
+    }
+    memset(&V, 0, sizeof(S2PY_VRPYR));
+    if(!(V.array = grid_from_array(gridIn, &V.src, 1., 0.))){
+        return NULL;
+    }
+    if(a1 < 0 || b1 < 0 || c1 < 0 || a2 >= adim || b2 >= bdim || c2 >= cdim || a2 >= V.src.dim[0] || b2 >= V.src.dim[1] || c2 >= V.src.dim[2] || a2 < a1 || b2 < b1 || c2 < c1){
+        Py_DECREF(V.array);
+        PyErr_SetString(PyExc_ValueError, "the region must lie within the grid");
+        return NULL;
+    }
+    if((PyObject *) trIn != Py_None && !(tr = numpy1D_to_float(trIn))){
+        Py_DECREF(V.array);
+        return NULL;
+    }
+    V.trans = *trans;
+    V.datamin = datamin;
+    V.datamax = datamax;
+    V.alphamin = alphamin;
+    V.alphamax = alphamax;
+    V.budget = budget;
+    V.pixels = (float) pixels;
+    V.origin[0] = a1; V.origin[1] = b1; V.origin[2] = c1;
+    V.n[0] = a2 - a1 + 1; V.n[1] = b2 - b1 + 1; V.n[2] = c2 - c1 + 1;
+    memcpy(V.tr, tr ? tr : unit, sizeof(unit));
+    if(tr) numpy_free(trIn, tr);
+
+    // the levels, while a brick is still a few voxels across, and the bricks,
+    // S2PY_VRP_BRICK voxel spacings each as they overlap
+    V.nlevels = 1;
+    while(V.nlevels < S2PY_VRP_LEVELS && (S2PY_VRP_BRICK >> V.nlevels) >= 4) V.nlevels++;
+    top = V.nlevels - 1;
+    for(k = 0; k < 3; k++) V.nb[k] = V.n[k] > 1 ? (V.n[k] - 1 + S2PY_VRP_BRICK - 1)/S2PY_VRP_BRICK : 1;
+    V.nbricks = V.nb[0]*V.nb[1]*V.nb[2];
+    V.centres = (XYZ *) malloc((size_t) V.nbricks*sizeof(XYZ));
+    V.vrids = (int *) malloc((size_t) V.nlevels*V.nbricks*sizeof(int));
+    V.level = (int *) malloc((size_t) V.nbricks*sizeof(int));
+    V.target = (unsigned char *) malloc((size_t) V.nbricks);
+    grids = (float ****) calloc((size_t) V.nbricks, sizeof(float ***));
+    trs = (float *) malloc((size_t) 12*V.nbricks*sizeof(float));
+    dims = (int *) malloc((size_t) 3*V.nbricks*sizeof(int));
+    if(!V.centres || !V.vrids || !V.level || !V.target || !grids || !trs || !dims){
+        ok = 0;
+    } else {
+        // auto-scaling would differ from brick to brick, so scale over the
+        // region once. The coarsest level is always there to fall back on.
+        Py_BEGIN_ALLOW_THREADS
+        if(V.datamin > V.datamax) ok = vrpyr_range(&V, &V.datamin, &V.datamax);
+        for(b = 0; b < V.nbricks && ok; b++){
+            ok = (grids[b] = vrpyr_brick(&V, top, b, dims + 3*b, trs + 12*b)) != NULL;
+        }
+        Py_END_ALLOW_THREADS
+    }
+    if(!ok){
+        for(b = 0; grids && b < V.nbricks; b++) free(grids[b]);
+        free(grids);
+        free(trs);
+        free(dims);
+        vrpyr_free(&V);
+        return PyErr_NoMemory();
+    }
+    for(k = 0; k < 3; k++){
+        base = sqrtf(V.tr[1+k]*V.tr[1+k] + V.tr[5+k]*V.tr[5+k] + V.tr[9+k]*V.tr[9+k]);
+        if(base > V.voxel) V.voxel = base;
+    }
+    V.radius = 0.8660254*S2PY_VRP_BRICK*V.voxel;
+    for(b = 0; b < V.nlevels*V.nbricks; b++) V.vrids[b] = -1;
+    for(b = 0; b < V.nbricks; b++){
+        int lo[3], hi[3];
+        float c[3];
+        vrpyr_region(&V, b, lo, hi);
+        for(k = 0; k < 3; k++) c[k] = V.origin[k] + 0.5*(lo[k] + hi[k]);
+        V.centres[b].x = V.tr[0] + V.tr[1]*c[0] + V.tr[2]*c[1] + V.tr[3]*c[2];
+        V.centres[b].y = V.tr[4] + V.tr[5]*c[0] + V.tr[6]*c[1] + V.tr[7]*c[2];
+        V.centres[b].z = V.tr[8] + V.tr[9]*c[0] + V.tr[10]*c[1] + V.tr[11]*c[2];
+        V.level[b] = top;
+        vrpyr_render(&V, top, b, grids[b], dims + 3*b, trs + 12*b);
+    }
+    free(grids);
+    free(trs);
+    free(dims);
+
+    // pyramids are never freed, since their volume renders cannot be
+    if(!(grown = (S2PY_VRPYR *) realloc(vrpyrList, (size_t) (nVrpyrs + 1)*sizeof(S2PY_VRPYR)))){
+        return PyErr_NoMemory();
+    }
+    vrpyrList = grown;
+    id = nVrpyrs++;
+    vrpyrList[id] = V;
+
+    return PyInt_FromLong((long) id);
+}
+static PyObject *s2plot_ds2dvrp(PyObject *self, PyObject *args){
+    S2PY_VRPYR *V;
+    XYZ eye, up, vdir, d;
+    unsigned int *order;
+    float tol, dist, size;
+    long total, voxels = 0;
+    int id, b, i, l, bias, still, made = 0;
+
+    if(!PyArg_ParseTuple(args, "i:ds2dvrp", &id)){
+        return NULL;
+    }
+    if(id < 0 || id >= nVrpyrs){
+        PyErr_Format(PyExc_IndexError, "no volume pyramid with id %d", id);
+        return NULL;
+    }
+    // the GIL is kept throughout, as ns2cvrp may grow vrpyrList meanwhile
+    V = &vrpyrList[id];
+
+    ss2qc(&eye, &up, &vdir, 1);
+    still = eye.x == V->eye.x && eye.y == V->eye.y && eye.z == V->eye.z && vdir.x == V->vdir.x && vdir.y == V->vdir.y && vdir.z == V->vdir.z;
+    V->eye = eye;
+    V->vdir = vdir;
+    // the angle one screen pixel subtends
+    tol = ss2qca()*0.017453293/V->pixels;
+
+    // the level at which a voxel covers about a pixel; 255 marks a brick
+    // wholly behind the camera
+    for(b = 0; b < V->nbricks; b++){
+        d.x = V->centres[b].x - eye.x;
+        d.y = V->centres[b].y - eye.y;
+        d.z = V->centres[b].z - eye.z;
+        if(d.x*vdir.x + d.y*vdir.y + d.z*vdir.z < -V->radius){
+            V->target[b] = 255;
+            continue;
+        }
+        dist = sqrtf(d.x*d.x + d.y*d.y + d.z*d.z) - V->radius;
+        size = dist > 0. ? tol*dist/V->voxel : 0.;
+        for(l = 0; l < V->nlevels - 1 && (2 << l) <= size; l++);
+        V->target[b] = (unsigned char) l;
+    }
+    // coarsen everything alike until the voxels drawn fit the budget
+    for(bias = 0; bias < V->nlevels - 1; bias++){
+        for(total = 0, b = 0; b < V->nbricks; b++){
+            if(V->target[b] == 255) continue;
+            l = V->target[b] + bias < V->nlevels ? V->target[b] + bias : V->nlevels - 1;
+            total += vrpyr_voxels(V, l, b);
+        }
+        if(total <= V->budget) break;
+    }
+    order = V->nbricks > 1 ? depth_sort(&V->sort, V->centres, V->nbricks, eye, vdir) : NULL;
+
+    // nearest bricks first: step to the finest level already made, and while
+    // the camera is still make one level finer for a few bricks per frame
+    for(i = V->nbricks - 1; i >= 0; i--){
+        b = order ? (int) order[i] : i;
+        if(V->target[b] == 255) continue;
+        l = V->target[b] + bias < V->nlevels ? V->target[b] + bias : V->nlevels - 1;
+        if(l >= V->level[b]){
+            // coarser (or the same): the nearest level made at or above it
+            while(V->vrids[l*V->nbricks + b] < 0) l++;
+            V->level[b] = l;
+            continue;
+        }
+        while(V->level[b] > l && V->vrids[(V->level[b] - 1)*V->nbricks + b] >= 0) V->level[b]--;
+        if(still && V->level[b] > l && made < S2PY_VRP_REFINE){
+            if(vrpyr_make(V, V->level[b] - 1, b) >= 0) V->level[b]--;
+            made++;
+        }
+    }
+    // back to front
+    for(i = 0; i < V->nbricks; i++){
+        b = order ? (int) order[i] : i;
+        if(V->target[b] == 255) continue;
+        ds2dvr(V->vrids[V->level[b]*V->nbricks + b], 0);
+        voxels += vrpyr_voxels(V, V->level[b], b);
+    }
+
+    return PyInt_FromLong(voxels);
 }
 static PyObject *pyActiveColourCallback = NULL;
-static PyObject *pyColourCallbackDict = NULL;
+// colour callbacks of ns2cisc surfaces, indexed by isosurface id
+static PyObject **isoColourCallbacks = NULL;
+static int nIsoColourCallbacks = 0;
+
+static int iso_colour_set(int id, PyObject *callable){
+    // keep a reference to the colour function of isosurface id
+    PyObject **grown;
+
+    if(id < 0) return 1;
+    if(id >= nIsoColourCallbacks){
+        grown = (PyObject **) realloc(isoColourCallbacks, (size_t) (id + 1)*sizeof(PyObject *));
+        if(grown == NULL){
+            PyErr_NoMemory();
+            return 0;
+        }
+        memset(grown + nIsoColourCallbacks, 0, (size_t) (id + 1 - nIsoColourCallbacks)*sizeof(PyObject *));
+        isoColourCallbacks = grown;
+        nIsoColourCallbacks = id + 1;
+    }
+    Py_XINCREF(callable);
+    Py_XDECREF(isoColourCallbacks[id]);
+    isoColourCallbacks[id] = callable;
+    return 1;
+}
 void cColourCallback(float *x, float *y, float *z, float *r, float *g, float *b){ 
+    PyGILState_STATE gstate = PyGILState_Ensure();
     PyObject *arg, *pyResult;
     COLOUR result;
     // python signature is: takes x, y, z: returns rgb dictionary
     
+    if(pyActiveColourCallback == NULL){
+        // cannot set exception - in callback
+        PyGILState_Release(gstate);
+        return;
+    }
     arg = Py_BuildValue("fff", *x, *y, *z);
     pyResult = PyEval_CallObject(pyActiveColourCallback, arg);
     Py_DECREF(arg);
 
     // errors?
-    if(pyResult == NULL) return;
+    if(pyResult == NULL){
+        PyGILState_Release(gstate);
+        return;
+    }
 
     result = Dict_to_COLOUR(pyResult);
     *r = result.r;
@@ -3969,32 +8730,335 @@ void cColourCallback(float *x, float *y, float *z, float *r, float *g, float *b)
     *b = result.b;
 
     Py_XDECREF(pyResult);
+
+    PyGILState_Release(gstate);
+}
+// vectorised colour functions of ns2cisc surfaces. Every isosurface vertex
+// lies on a lattice edge whose ends straddle the level, so the crossings are
+// found here first, coloured with one python call, and kept in a hash table
+// keyed by edge; the per-vertex callback from s2plot then only looks them up.
+typedef struct {
+    PyObject *func;
+    float ***grid;
+    int a1, a2, b1, b2, c1, c2, res;
+    float tr[12], inv[9];       // grid to world, and the inverse of its linear part
+    float level;
+    int stale;                  // rebuild before the next extraction
+    unsigned long long *keys;   // 0 marks an empty slot
+    COLOUR *cols;
+    size_t mask;                // table size - 1, a power of two less one
+} S2PY_ISOCOLOUR;
+static S2PY_ISOCOLOUR **isoColourCaches = NULL;
+static int nIsoColourCaches = 0;
+static S2PY_ISOCOLOUR *activeIsoColour = NULL;
+
+static void iso_cache_free(S2PY_ISOCOLOUR *c){
+    if(c == NULL) return;
+    Py_XDECREF(c->func);
+    free(c->keys);
+    free(c->cols);
+    free(c);
+}
+static size_t iso_cache_slot(unsigned long long key, size_t mask){
+    return (size_t) ((key*0x9E3779B97F4A7C15ULL) >> 17) & mask;
+}
+static int iso_cache_build(S2PY_ISOCOLOUR *c){
+    // find and colour every crossing of the current level; returns 0 with the
+    // python error set on failure
+    int na = (c->a2 - c->a1)/c->res + 1, nb = (c->b2 - c->b1)/c->res + 1, nc = (c->c2 - c->c1)/c->res + 1;
+    int ia, ib, ic, axis, ok = 0;
+    long *start, n;
+    npy_intp dims[2];
+    PyArrayObject *points;
+    PyObject *arg;
+    unsigned long long *keys = NULL;
+    float *rgb = NULL;
+    size_t size, slot, i;
+
+    if(!(start = (long *) calloc((size_t) na + 1, sizeof(long)))){
+        PyErr_NoMemory();
+        return 0;
+    }
+    // count the crossings of each a-slab, then fill them in
+    #pragma omp parallel for private(ib, ic, axis) schedule(dynamic) if((long) na*nb*nc >= S2PY_OMP_THRESHOLD)
+    for(ia = 0; ia < na; ia++){
+        long count = 0;
+        int a = c->a1 + ia*c->res, b, cc, d[3];
+        float v;
+        for(ib = 0; ib < nb; ib++){
+            b = c->b1 + ib*c->res;
+            for(ic = 0; ic < nc; ic++){
+                cc = c->c1 + ic*c->res;
+                v = c->grid[a][b][cc];
+                for(axis = 0; axis < 3; axis++){
+                    d[0] = axis == 0; d[1] = axis == 1; d[2] = axis == 2;
+                    if(ia + d[0] >= na || ib + d[1] >= nb || ic + d[2] >= nc) continue;
+                    if((v < c->level) != (c->grid[a + d[0]*c->res][b + d[1]*c->res][cc + d[2]*c->res] < c->level)) count++;
+                }
+            }
+        }
+        start[ia + 1] = count;
+    }
+    for(ia = 0; ia < na; ia++) start[ia + 1] += start[ia];
+    n = start[na];
+
+    dims[0] = (npy_intp) n;
+    dims[1] = 3;
+    if(!(points = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_FLOAT)) ||
+       !(keys = (unsigned long long *) malloc((size_t) (n ? n : 1)*sizeof(unsigned long long)))){
+        Py_XDECREF(points);
+        free(start);
+        if(!PyErr_Occurred()) PyErr_NoMemory();
+        return 0;
+    }
+    #pragma omp parallel for private(ib, ic, axis) schedule(dynamic) if((long) na*nb*nc >= S2PY_OMP_THRESHOLD)
+    for(ia = 0; ia < na; ia++){
+        long k = start[ia];
+        int a = c->a1 + ia*c->res, b, cc, d[3];
+        float v, w, t, g[3], *p;
+        for(ib = 0; ib < nb; ib++){
+            b = c->b1 + ib*c->res;
+            for(ic = 0; ic < nc; ic++){
+                cc = c->c1 + ic*c->res;
+                v = c->grid[a][b][cc];
+                for(axis = 0; axis < 3; axis++){
+                    d[0] = axis == 0; d[1] = axis == 1; d[2] = axis == 2;
+                    if(ia + d[0] >= na || ib + d[1] >= nb || ic + d[2] >= nc) continue;
+                    w = c->grid[a + d[0]*c->res][b + d[1]*c->res][cc + d[2]*c->res];
+                    if((v < c->level) == (w < c->level)) continue;
+                    // linear interpolation along the edge, as the extractor does
+                    t = (c->level - v)/(w - v);
+                    g[0] = a + t*d[0]*c->res;
+                    g[1] = b + t*d[1]*c->res;
+                    g[2] = cc + t*d[2]*c->res;
+                    p = (float *) PyArray_DATA(points) + 3*k;
+                    p[0] = c->tr[0] + c->tr[1]*g[0] + c->tr[2]*g[1] + c->tr[3]*g[2];
+                    p[1] = c->tr[4] + c->tr[5]*g[0] + c->tr[6]*g[1] + c->tr[7]*g[2];
+                    p[2] = c->tr[8] + c->tr[9]*g[0] + c->tr[10]*g[1] + c->tr[11]*g[2];
+                    keys[k++] = (((unsigned long long) ia*nb + ib)*nc + ic)*3 + axis + 1;
+                }
+            }
+        }
+    }
+    free(start);
+
+    arg = Py_BuildValue("(O)", (PyObject *) points);
+    Py_DECREF(points);
+    if(arg != NULL){
+        rgb = vector_call(c->func, arg, (npy_intp) 3*n);
+        Py_DECREF(arg);
+    }
+    if(rgb == NULL){
+        free(keys);
+        return 0;
+    }
+
+    // a table at most half full
+    for(size = 2; size < (size_t) 2*n; size *= 2);
+    free(c->keys);
+    free(c->cols);
+    c->keys = (unsigned long long *) calloc(size, sizeof(unsigned long long));
+    c->cols = (COLOUR *) malloc(size*sizeof(COLOUR));
+    c->mask = size - 1;
+    if(c->keys && c->cols){
+        for(i = 0; i < (size_t) n; i++){
+            for(slot = iso_cache_slot(keys[i], c->mask); c->keys[slot] != 0; slot = (slot + 1) & c->mask);
+            c->keys[slot] = keys[i];
+            memcpy(&c->cols[slot], rgb + 3*i, sizeof(COLOUR));
+        }
+        c->stale = 0;
+        ok = 1;
+    } else {
+        free(c->keys);
+        free(c->cols);
+        c->keys = NULL;
+        c->cols = NULL;
+        PyErr_NoMemory();
+    }
+    free(keys);
+    free(rgb);
+    return ok;
+}
+void cIsoColourVector(float *x, float *y, float *z, float *r, float *g, float *b){
+    // runs without the GIL unless the vertex is not in the table
+    S2PY_ISOCOLOUR *c = activeIsoColour;
+    PyGILState_STATE gstate;
+    PyArrayObject *point;
+    PyObject *arg;
+    npy_intp dims[2] = {1, 3};
+    float d[3], u[3], lo[3], v, w, t, dist, best = 1e-2, *rgb;
+    unsigned long long key;
+    size_t slot;
+    int k, j, axis = -1, n[3], node[3], ix[3], e[3];
+
+    if(c == NULL || c->keys == NULL){
+        // cannot set exception - in callback
+        return;
+    }
+    d[0] = *x - c->tr[0];
+    d[1] = *y - c->tr[4];
+    d[2] = *z - c->tr[8];
+    lo[0] = c->a1; lo[1] = c->b1; lo[2] = c->c1;
+    n[0] = (c->a2 - c->a1)/c->res + 1;
+    n[1] = (c->b2 - c->b1)/c->res + 1;
+    n[2] = (c->c2 - c->c1)/c->res + 1;
+    for(k = 0; k < 3; k++){
+        u[k] = (c->inv[3*k]*d[0] + c->inv[3*k+1]*d[1] + c->inv[3*k+2]*d[2] - lo[k])/c->res;
+        node[k] = (int) floorf(u[k] + 0.5f);
+    }
+    // the vertex lies on an edge along one axis, starting at its nearest
+    // node or the one before; a vertex on or next to a node leaves the axis
+    // ambiguous, so every candidate crossing is interpolated again and the
+    // one nearest the vertex is taken
+    for(k = 0; k < 3; k++){
+        for(j = -1; j <= 0; j++){
+            e[0] = node[0]; e[1] = node[1]; e[2] = node[2];
+            e[k] += j;
+            if(e[0] < 0 || e[1] < 0 || e[2] < 0 || e[0] >= n[0] || e[1] >= n[1] || e[2] >= n[2] || e[k] + 1 >= n[k]){
+                continue;
+            }
+            v = c->grid[c->a1 + e[0]*c->res][c->b1 + e[1]*c->res][c->c1 + e[2]*c->res];
+            w = c->grid[c->a1 + (e[0] + (k == 0))*c->res][c->b1 + (e[1] + (k == 1))*c->res][c->c1 + (e[2] + (k == 2))*c->res];
+            if((v < c->level) == (w < c->level)) continue;
+            t = (c->level - v)/(w - v);
+            dist = fabsf(e[k] + t - u[k]) + fabsf(e[(k+1)%3] - u[(k+1)%3]) + fabsf(e[(k+2)%3] - u[(k+2)%3]);
+            if(dist < best){
+                best = dist;
+                axis = k;
+                ix[0] = e[0]; ix[1] = e[1]; ix[2] = e[2];
+            }
+        }
+    }
+    if(axis >= 0){
+        key = (((unsigned long long) ix[0]*n[1] + ix[1])*n[2] + ix[2])*3 + axis + 1;
+        for(slot = iso_cache_slot(key, c->mask); c->keys[slot] != 0; slot = (slot + 1) & c->mask){
+            if(c->keys[slot] == key){
+                *r = c->cols[slot].r;
+                *g = c->cols[slot].g;
+                *b = c->cols[slot].b;
+                return;
+            }
+        }
+    }
+
+    // not a crossing found above: colour this vertex on its own
+    gstate = PyGILState_Ensure();
+    if((point = (PyArrayObject *) PyArray_SimpleNew(2, dims, PyArray_FLOAT))){
+        ((float *) PyArray_DATA(point))[0] = *x;
+        ((float *) PyArray_DATA(point))[1] = *y;
+        ((float *) PyArray_DATA(point))[2] = *z;
+        arg = Py_BuildValue("(O)", (PyObject *) point);
+        Py_DECREF(point);
+        if(arg != NULL && (rgb = vector_call(c->func, arg, 3))){
+            *r = rgb[0];
+            *g = rgb[1];
+            *b = rgb[2];
+            free(rgb);
+        }
+        Py_XDECREF(arg);
+    }
+    PyErr_Clear();
+    PyGILState_Release(gstate);
+}
+static S2PY_ISOCOLOUR *iso_cache_new(PyObject *func, float ***grid, int a1, int a2, int b1, int b2, int c1, int c2, float *tr, float level, int res){
+    // set up (and fill) the colour table of a new surface, or NULL with the
+    // python error set
+    S2PY_ISOCOLOUR *c;
+    float *m, det;
+    int k;
+
+    if(res < 1) res = 1;
+    if(a2 < a1 || b2 < b1 || c2 < c1){
+        PyErr_SetString(PyExc_ValueError, "empty grid range");
+        return NULL;
+    }
+    if(!(c = (S2PY_ISOCOLOUR *) calloc(1, sizeof(S2PY_ISOCOLOUR)))){
+        PyErr_NoMemory();
+        return NULL;
+    }
+    Py_INCREF(func);
+    c->func = func;
+    c->grid = grid;
+    c->a1 = a1; c->b1 = b1; c->c1 = c1;
+    // only whole steps of res are visited
+    c->a2 = a1 + (a2 - a1)/res*res;
+    c->b2 = b1 + (b2 - b1)/res*res;
+    c->c2 = c1 + (c2 - c1)/res*res;
+    c->res = res;
+    c->level = level;
+    if(tr){
+        memcpy(c->tr, tr, 12*sizeof(float));
+    } else {
+        for(k = 0; k < 12; k++) c->tr[k] = (k == 1 || k == 6 || k == 11) ? 1. : 0.;
+    }
+    m = c->tr;
+    det = m[1]*(m[6]*m[11] - m[7]*m[10]) - m[2]*(m[5]*m[11] - m[7]*m[9]) + m[3]*(m[5]*m[10] - m[6]*m[9]);
+    if(det == 0.){
+        PyErr_SetString(PyExc_ValueError, "tr must be invertible to use a vectorised colour function");
+        iso_cache_free(c);
+        return NULL;
+    }
+    c->inv[0] = (m[6]*m[11] - m[7]*m[10])/det;
+    c->inv[1] = (m[3]*m[10] - m[2]*m[11])/det;
+    c->inv[2] = (m[2]*m[7] - m[3]*m[6])/det;
+    c->inv[3] = (m[7]*m[9] - m[5]*m[11])/det;
+    c->inv[4] = (m[1]*m[11] - m[3]*m[9])/det;
+    c->inv[5] = (m[3]*m[5] - m[1]*m[7])/det;
+    c->inv[6] = (m[5]*m[10] - m[6]*m[9])/det;
+    c->inv[7] = (m[2]*m[9] - m[1]*m[10])/det;
+    c->inv[8] = (m[1]*m[6] - m[2]*m[5])/det;
+    if(!iso_cache_build(c)){
+        iso_cache_free(c);
+        return NULL;
+    }
+    return c;
+}
+static int iso_cache_set(int id, S2PY_ISOCOLOUR *c){
+    // keep (or with NULL, drop) the colour table of isosurface id
+    S2PY_ISOCOLOUR **grown;
+
+    if(id < 0){
+        iso_cache_free(c);
+        return 1;
+    }
+    if(id >= nIsoColourCaches){
+        if(c == NULL) return 1;
+        grown = (S2PY_ISOCOLOUR **) realloc(isoColourCaches, (size_t) (id + 1)*sizeof(S2PY_ISOCOLOUR *));
+        if(grown == NULL){
+            iso_cache_free(c);
+            PyErr_NoMemory();
+            return 0;
+        }
+        memset(grown + nIsoColourCaches, 0, (size_t) (id + 1 - nIsoColourCaches)*sizeof(S2PY_ISOCOLOUR *));
+        isoColourCaches = grown;
+        nIsoColourCaches = id + 1;
+    }
+    if(activeIsoColour == isoColourCaches[id]) activeIsoColour = c;
+    iso_cache_free(isoColourCaches[id]);
+    isoColourCaches[id] = c;
+    return 1;
+}
+static S2PY_ISOCOLOUR *iso_cache_lookup(int id){
+    return (id >= 0 && id < nIsoColourCaches) ? isoColourCaches[id] : NULL;
 }
 static PyObject *s2plot_ns2cisc(PyObject *self, PyObject *args){
-  float ***grid, *tr, level, alpha;
-    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, resolution, id;
+  float ***grid, *tr, level, alpha, scale = 1., offset = 0.;
+    int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, resolution, id, vectorised = 0;
     char *trans;
     PyArrayObject *gridIn, *trIn;
     PyObject *result, *tempColCall;
+    S2PY_ISOCOLOUR *cache = NULL;
+    void *fn;
     
     // parse the args into numpy array objects
-    if(!PyArg_ParseTuple(args,"O!iiiiiiiiiOfisfO:ns2cisc", &PyArray_Type, &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &level, &resolution, &trans, &alpha, &tempColCall) || !gridIn || !trIn || !tempColCall){
+    if(!PyArg_ParseTuple(args,"O!iiiiiiiiiOfisfO|iff:ns2cisc", &PyArray_Type, &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &level, &resolution, &trans, &alpha, &tempColCall, &vectorised, &scale, &offset) || !gridIn || !trIn || !tempColCall){
         return NULL;
     }
-    if (!PyCallable_Check(tempColCall)) {
-        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+    if(!native_callbacks(&tempColCall, &fn, 1)){
         return NULL;
     }
     
-    // store a reference to the new callback
-    Py_XINCREF(tempColCall);
-    // create the callback list if it does not exist
-    if(pyColourCallbackDict == NULL){
-        pyColourCallbackDict = PyDict_New();
-        Py_XINCREF(pyColourCallbackDict);
-    }
-    
-    if(!(grid = numpy3D_to_float(gridIn))) {return NULL;}
+    if(!(grid = numpy3D_to_float_scaled(gridIn, scale, offset))) {return NULL;}
     // None is allowed as input - for standard tr matrix
     if((PyObject *) trIn == Py_None) {tr = NULL;}
     else if(!(tr = numpy1D_to_float(trIn))){
@@ -4002,13 +9066,29 @@ static PyObject *s2plot_ns2cisc(PyObject *self, PyObject *args){
         return NULL;
     }
     
-    id = ns2cisc(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, *trans, alpha, cColourCallback);
-
-    // add the new callback to the dict with id as the key
-    PyDict_SetItem(pyColourCallbackDict, PyInt_FromLong((long) id), tempColCall);
+    // a vectorised function colours every crossing of the level up front
+    if(vectorised && fn == NULL){
+        if(!(cache = iso_cache_new(tempColCall, grid, a1, a2, b1, b2, c1, c2, tr, level, resolution))){
+            numpy_free(trIn, tr);
+            numpy_free(gridIn, grid);
+            return NULL;
+        }
+    }
+    
+    // a native colour function is handed straight to s2plot; the object is
+    // still kept below so that a ctypes callback stays alive
+    pyActiveColourCallback = tempColCall;
+    activeIsoColour = cache;
+    id = ns2cisc(grid, adim, bdim, cdim, a1, a2, b1, b2, c1, c2, tr, level, resolution, *trans, alpha,
+                 fn ? (S2PY_COLFUNC) fn : (cache ? cIsoColourVector : cColourCallback));
 
     numpy_free(trIn, tr);
 
+    // keep the new callback (and colour table) with the surface id
+    if(!iso_colour_set(id, tempColCall) || !iso_cache_set(id, cache)){
+        return NULL;
+    }
+
     result = PyInt_FromLong((long) id);
     Py_INCREF(result);
     return result;
@@ -4022,10 +9102,13 @@ static PyObject *s2plot_ns2dis(PyObject *self, PyObject *args){
 
     // we don't know whether this is a colour callback or not
     // in any case, set the active colour callback to the isid'th one
-    // if the list exists
-    if(pyColourCallbackDict != NULL){
-        // will return NULL if key doesn't exist
-        pyActiveColourCallback = PyDict_GetItem(pyColourCallbackDict, PyInt_FromLong((long) isid));
+    pyActiveColourCallback = (isid >= 0 && isid < nIsoColourCallbacks) ? isoColourCallbacks[isid] : NULL;
+    // a forced redraw may follow changes to the grid data
+    if((activeIsoColour = iso_cache_lookup(isid)) != NULL){
+        if(force) activeIsoColour->stale = 1;
+        if(activeIsoColour->stale && !iso_cache_build(activeIsoColour)){
+            return NULL;
+        }
     }
 
     ns2dis(isid, force);
@@ -4034,12 +9117,17 @@ static PyObject *s2plot_ns2dis(PyObject *self, PyObject *args){
     return Py_None;
 }
 static PyObject *s2plot_ns2sisl(PyObject *self, PyObject *args){
+    S2PY_ISOCOLOUR *cache;
     int isid;
     float level;
     
     if(!PyArg_ParseTuple(args, "if:ns2sisl", &isid, &level)){
         return NULL;
     }
+    if((cache = iso_cache_lookup(isid)) != NULL){
+        cache->level = level;
+        cache->stale = 1;
+    }
 
     ns2sisl(isid, level);
 
@@ -4071,18 +9159,20 @@ static PyObject *s2plot_ns2sisc(PyObject *self, PyObject *args){
     Py_INCREF(Py_None);
     return Py_None;
 }
+static void vrgrid_track(int vrid, PyArrayObject *gridIn, int a1, int a2, int b1, int b2, int c1, int c2);
+static int vrgrid_changed(int vrid);
 static PyObject *s2plot_ns2cvr(PyObject *self, PyObject *args){
-    float ***grid, *tr, datamin, datamax, alphamin, alphamax;
+    float ***grid, *tr, datamin, datamax, alphamin, alphamax, scale = 1., offset = 0.;
     int adim, bdim, cdim, a1, a2, b1, b2, c1, c2, id;
     char *trans;
     PyArrayObject *gridIn, *trIn;
     PyObject *result;
     
     // parse the args into numpy array objects
-    if(!PyArg_ParseTuple(args,"O!iiiiiiiiiOsffff:ns2cvr", &PyArray_Type, &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &trans, &datamin, &datamax, &alphamin, &alphamax) || !gridIn || !trIn){
+    if(!PyArg_ParseTuple(args,"O!iiiiiiiiiOsffff|ff:ns2cvr", &PyArray_Type, &gridIn, &adim, &bdim, &cdim, &a1, &a2, &b1, &b2, &c1, &c2, &trIn, &trans, &datamin, &datamax, &alphamin, &alphamax, &scale, &offset) || !gridIn || !trIn){
         return NULL;
     }
-    if(!(grid = numpy3D_to_float(gridIn))) {return NULL;}
+    if(!(grid = numpy3D_to_float_scaled(gridIn, scale, offset))) {return NULL;}
     // None is allowed as input - for standard tr matrix
     if((PyObject *) trIn == Py_None) {tr = NULL;}
     else if(!(tr = numpy1D_to_float(trIn))){
@@ -4094,6 +9184,8 @@ static PyObject *s2plot_ns2cvr(PyObject *self, PyObject *args){
     
     // don't free grid: the memory is used by the surface drawer
     numpy_free(trIn, tr);
+    // a scaled grid is a copy, so changes to gridIn never reach it
+    if(scale == 1. && offset == 0.) vrgrid_track(id, gridIn, a1, a2, b1, b2, c1, c2);
 
     result = PyInt_FromLong((long) id);
     Py_INCREF(result);
@@ -4105,6 +9197,7 @@ static PyObject *s2plot_ds2dvr(PyObject *self, PyObject *args){
     if(!PyArg_ParseTuple(args, "ii:ds2dvr", &vrid, &force)){
         return NULL;
     }
+    if(force < 0) force = vrgrid_changed(vrid);
 
     ds2dvr(vrid, force);
     
@@ -4599,54 +9692,28 @@ static PyObject *s2plot_ss2qsa(PyObject *self, PyObject *args){
     return pyResult;
 }
 static PyObject *s2plot_cs2scbx(PyObject *self, PyObject *args){
-   PyObject *result = NULL;
-   PyObject *temp, *data = NULL, *tuple;
-   if (PyArg_ParseTuple(args, "O|O:cs2scbx", &temp, &data)) {
-       if (!PyCallable_Check(temp)) {
-           if(temp == Py_None){
-               cs2scbx(NULL, NULL);
-               Py_RETURN_NONE;
-           } else {
-               PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-               return NULL;
-           }
-       }
-       if(!data){
-           result = s2plot_cs2scb(self, args);
-           return result;
-       }
-       // store a reference to the new callback in the global dict:
-       /// the key will be the id of this panel
-       if(pyCallbackDict == NULL){
-           pyCallbackDict = PyDict_New();
-           Py_XINCREF(pyCallbackDict);
-       }
-       Py_XINCREF(temp);
-       Py_XINCREF(data);
-       // create a new tuple containing the callback/data
-       tuple = PyTuple_Pack(2, temp, data);
-       Py_XINCREF(tuple);
-
-       PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-       // decref the current callback if it exists
-       // in this case the pyObjects stored are tuples of (callback, dataObject)
-       PyObject *currentCallback = PyDict_GetItem(pyCallbackDict, pyKey);
-       if(currentCallback != NULL){
-           if(PyTuple_Check(currentCallback) > 0 && PyTuple_Size(currentCallback) == 2){
-               Py_XDECREF(PyTuple_GET_ITEM(currentCallback, 0));
-               Py_XDECREF(PyTuple_GET_ITEM(currentCallback, 1));
-           }
-           Py_XDECREF(currentCallback);
-       }
-       // set the new callback for this pane
-       PyDict_SetItem(pyCallbackDict, pyKey, tuple);
-
-       cs2scb(&cCallBackFunction);
-
-       Py_INCREF(Py_None); 
-       result = Py_None; 
-   } 
-   return result;
+    PyObject *temp, *data = NULL;
+
+    if(!PyArg_ParseTuple(args, "O|O:cs2scbx", &temp, &data)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        if(!retained_attached(xs2qsp())) cs2scbx(NULL, NULL);
+        panel_callback_set(S2PY_CB_FRAME, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // the data object is passed on as the third argument of the callback
+    if(!panel_callback_set(S2PY_CB_FRAME, temp, data)){
+        return NULL;
+    }
+    cs2scb(&cCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
 }
 static PyObject *s2plot_ss2qsd(PyObject *self, PyObject *args){
     int x, y;
@@ -4685,147 +9752,98 @@ static PyObject *s2plot_ss2qnfp(PyObject *self, PyObject *args){
     Py_INCREF(pyResult);
     return pyResult;
 }
-static PyObject *pyDHCallbackDict = NULL;
 void cDHCallBackFunction(int *id, XYZ *pt){ 
-    PyObject *arg;
-    PyObject *currentCallback;
-    PyObject *pyResult;
-    PyObject *pyPt = NULL;
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    S2PY_CALLBACK *cb;
+    PyObject *arg, *pyResult, *pyPt;
     
-    pyPt = XYZ_to_Dict(*pt);
-    
-    if(pyDHCallbackDict == NULL){
-        // cannot set exception - in callback
-        return;
-    }
-    currentCallback = PyDict_GetItem(pyDHCallbackDict, PyInt_FromLong((long) xs2qsp()));
-    if(currentCallback == NULL){
+    if((cb = panel_callback(S2PY_CB_DRAGHANDLE)) == NULL){
         // cannot set exception - in callback
+        PyGILState_Release(gstate);
         return;
     }
-    arg = Py_BuildValue("iO", id, pyPt);
-    pyResult = PyEval_CallObject(currentCallback, arg);
+    pyPt = XYZ_to_Dict(*pt);
+    arg = Py_BuildValue("iN", *id, pyPt);
+    pyResult = PyEval_CallObject(cb->callable, arg);
     Py_DECREF(arg);
     
     if (pyResult != NULL){
         Py_DECREF(pyResult);
     }
+
+    PyGILState_Release(gstate);
 }
 static PyObject *s2plot_cs2sdhcb(PyObject *self, PyObject *args){
-    PyObject *result = NULL;
     PyObject *temp;
-    if (PyArg_ParseTuple(args, "O:cs2sdhcb", &temp)) {
-        if (!PyCallable_Check(temp)) {
-            if(temp == Py_None){
-                cs2sdhcb(NULL);
-                Py_RETURN_NONE;
-            } else {
-                PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-                return NULL;
-            }
-        }
-        
-        // store a reference to the new callback in the global dict:
-        /// the key will be the id of this panel
-        if(pyDHCallbackDict == NULL){
-            pyDHCallbackDict = PyDict_New();
-            Py_XINCREF(pyDHCallbackDict);
-        }
-        Py_XINCREF(temp);
-        
-        PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-        // decref the current callback if it exists
-        PyObject *currentCallback = PyDict_GetItem(pyDHCallbackDict, pyKey);
-        if(currentCallback != NULL){
-            Py_XDECREF(currentCallback);
-        }
-        // set the new callback for this pane
-        PyDict_SetItem(pyDHCallbackDict, pyKey, temp);
-        
-        cs2sdhcb(&cDHCallBackFunction);
-        
-        Py_INCREF(Py_None); 
-        result = Py_None; 
-    } 
-    return result;
+
+    if(!PyArg_ParseTuple(args, "O:cs2sdhcb", &temp)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        cs2sdhcb(NULL);
+        panel_callback_set(S2PY_CB_DRAGHANDLE, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // keep the callback for this panel
+    if(!panel_callback_set(S2PY_CB_DRAGHANDLE, temp, NULL)){
+        return NULL;
+    }
+    cs2sdhcb(&cDHCallBackFunction);
+
+    Py_INCREF(Py_None);
+    return Py_None;
 }
-static PyObject *pyPCallbackDict = NULL;
 void cPCallBackFunction(char *string){ 
-    PyObject *arg;
-    PyObject *currentCallback, *callable, *callData;
-    PyObject *pyResult;
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    S2PY_CALLBACK *cb;
+    PyObject *arg, *pyResult;
     
-    if(pyPCallbackDict == NULL){
+    if((cb = panel_callback(S2PY_CB_PROMPT)) == NULL){
         // cannot set exception - in callback
+        PyGILState_Release(gstate);
         return;
     }
-    currentCallback = PyDict_GetItem(pyPCallbackDict, PyInt_FromLong((long) xs2qsp()));
-    if(currentCallback == NULL || !PyTuple_Check(currentCallback) || PyTuple_Size(currentCallback) != 2){
-        // cannot set exception - in callback
-        return;
-    }
-    callable = PyTuple_GetItem(currentCallback, 0);
-    callData = PyTuple_GetItem(currentCallback, 1);
-    if(callData == Py_None){
+    if(cb->data == NULL){
         arg = Py_BuildValue("(s)", string);
     } else {
-        arg = Py_BuildValue("sO", string, callData);
+        arg = Py_BuildValue("sO", string, cb->data);
     }
-    pyResult = PyEval_CallObject(callable, arg);
+    pyResult = PyEval_CallObject(cb->callable, arg);
     Py_DECREF(arg);
     
     if (pyResult != NULL){
         Py_DECREF(pyResult);
     }
+
+    PyGILState_Release(gstate);
 }
 static PyObject *s2plot_cs2spcb(PyObject *self, PyObject *args){
-    PyObject *result = NULL;
-    PyObject *temp, *data = NULL, *tuple;
-    if (PyArg_ParseTuple(args, "O|O:cs2spcb", &temp, &data)) {
-        if (!PyCallable_Check(temp)) {
-            if(temp == Py_None){
-                cs2spcb(NULL, NULL);
-                Py_RETURN_NONE;
-            } else {
-                PyErr_SetString(PyExc_TypeError, "parameter must be callable");
-                return NULL;
-            }
-        }
-        if(!data){
-            data = Py_None;
-        }
-        // store a reference to the new callback in the global dict:
-        /// the key will be the id of this panel
-        if(pyPCallbackDict == NULL){
-            pyPCallbackDict = PyDict_New();
-            Py_XINCREF(pyPCallbackDict);
-        }
-        Py_XINCREF(temp);
-        Py_XINCREF(data);
-        // create a new tuple containing the callback/data
-        tuple = PyTuple_Pack(2, temp, data);
-        Py_XINCREF(tuple);
-        
-        PyObject *pyKey = PyInt_FromLong((long) xs2qsp());
-        // decref the current callback if it exists
-        // in this case the pyObjects stored are tuples of (callback, dataObject)
-        PyObject *currentCallback = PyDict_GetItem(pyPCallbackDict, pyKey);
-        if(currentCallback != NULL){
-            if(PyTuple_Check(currentCallback) > 0 && PyTuple_Size(currentCallback) == 2){
-                Py_XDECREF(PyTuple_GET_ITEM(currentCallback, 0));
-                Py_XDECREF(PyTuple_GET_ITEM(currentCallback, 1));
-            }
-            Py_XDECREF(currentCallback);
-        }
-        // set the new callback for this pane
-        PyDict_SetItem(pyPCallbackDict, pyKey, tuple);
-        
-        cs2spcb(&cPCallBackFunction, NULL);
-        
-        Py_INCREF(Py_None); 
-        result = Py_None; 
-    } 
-    return result;
+    PyObject *temp, *data = NULL;
+
+    if(!PyArg_ParseTuple(args, "O|O:cs2spcb", &temp, &data)){
+        return NULL;
+    }
+    if(temp == Py_None){
+        cs2spcb(NULL, NULL);
+        panel_callback_set(S2PY_CB_PROMPT, NULL, NULL);
+        Py_RETURN_NONE;
+    }
+    if(!PyCallable_Check(temp)){
+        PyErr_SetString(PyExc_TypeError, "parameter must be callable");
+        return NULL;
+    }
+    // the data object is passed on as the second argument of the callback
+    if(!panel_callback_set(S2PY_CB_PROMPT, temp, data)){
+        return NULL;
+    }
+    cs2spcb(&cPCallBackFunction, NULL);
+
+    Py_INCREF(Py_None);
+    return Py_None;
 }
 static PyObject *s2plot_cs2sptxy(PyObject *self, PyObject *args){ /* NEW */
     char *prompt;
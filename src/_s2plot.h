@@ -41,12 +41,80 @@
 #else
 #include <math.h>
 #endif
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// alignment (bytes) of the float blocks made by the numpy conversion helpers
+#define S2PY_ALIGN 64
+// conversions of at least this many elements are split across OpenMP
+// threads, in chunks of S2PY_OMP_CHUNK elements
+#define S2PY_OMP_THRESHOLD (1 << 18)
+#define S2PY_OMP_CHUNK     (1 << 16)
+// number of scratch buffers kept for converted 1D arrays, and the largest
+// buffer worth keeping
+#define S2PY_POOL_SLOTS     8
+#define S2PY_POOL_MAX_BYTES ((size_t) 64 << 20)
+// depth sorts start from the previous frame's order, and fall back to a full
+// radix sort once the insertion pass has moved this many elements per element
+#define S2PY_SORT_MOVES 8
+// point cloud octrees are at most S2PY_PC_LEVELS deep (Morton codes of 3 bits
+// per level must fit 32 bits); leaves and inner node samples hold at most
+// S2PY_PC_SAMPLE points
+#define S2PY_PC_LEVELS 10
+#define S2PY_PC_SAMPLE 4096
+// lowest quality factor ss2sfb will scale down to, the weight of each new
+// frame in the smoothed frame timings, and the frames the factor is held for
+// after a change so the timings can catch up with it
+#define S2PY_FB_QMIN   0.05
+#define S2PY_FB_SMOOTH 0.1
+#define S2PY_FB_HOLD   15
+// cells along each edge of the blocks summarised by ns2cxs isosurfaces
+#define S2PY_XS_BLOCK 8
+// cells per block edge of the change summary of volume render grids
+#define S2PY_VR_BLOCK 16
+// worker threads for background isosurface builds
+#define S2PY_WORKERS 2
+// decoded frames kept by a time series by default
+#define S2PY_SERIES_RING 4
+// volume pyramids: voxels per brick edge at full resolution, most levels,
+// default voxels drawn per frame and bricks refined per frame
+#define S2PY_VRP_BRICK  64
+#define S2PY_VRP_LEVELS 5
+#define S2PY_VRP_BUDGET 16777216L
+#define S2PY_VRP_REFINE 4
+
+// vectorised conversion kernels are built for x86 with gcc/clang and chosen
+// at run time; define S2PY_NO_SIMD to use the plain C loops everywhere
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(S2PY_NO_SIMD)
+#define S2PY_X86_SIMD
+#include <immintrin.h>
+#endif
+
+// C signatures of the s2plot callbacks, for native functions given from python
+typedef float (*S2PY_TFUNC)(float *);
+typedef float (*S2PY_UVFUNC)(float *, float *);
+typedef void  (*S2PY_COLFUNC)(float *, float *, float *, float *, float *, float *);
 
 // helper functions
+void     double_to_float_init(void);
+void     double_to_float(const double *, float *, npy_intp);
+void     gather32(const char *, npy_intp, void *, npy_intp);
+void     gather_double_to_float(const char *, npy_intp, float *, npy_intp);
+void    *scratch_acquire(size_t);
+int      scratch_release(void *);
 float   *numpy1D_to_float(PyArrayObject *);
 int     *numpy1D_to_int(PyArrayObject *);
 float  **numpy2D_to_float(PyArrayObject *);
 float ***numpy3D_to_float(PyArrayObject *);
+float ***numpy3D_to_float_scaled(PyArrayObject *, float, float);
+XYZ     *List_to_XYZ(PyObject *, int *, const char *);
+COLOUR  *List_to_COLOUR(PyObject *, int *, const char *);
+void     List_free(PyObject *, void *);
 
 static PyMethodDef S2PlotMethods[];
 
@@ -164,6 +232,11 @@ static PyObject *s2plot_ns2vf3(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf3n(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf3c(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf3nc(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2vnf3(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2cmesh(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2umesh(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2dmesh(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2fmesh(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf4(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf4n(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf4c(PyObject *self, PyObject *args);
@@ -179,12 +252,25 @@ static PyObject *s2plot_ns2vm(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2bb(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2vbb(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2vbbr(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2vnbb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2cds(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2fds(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2vbbp(PyObject *self, PyObject *args); /* NEW */
 static PyObject *s2plot_ds2tb(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2vtb(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2protect(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2unprotect(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2isprotected(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2cgb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2ugb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2dgb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2agb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2fgb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2cpc(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2spc(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2dpc(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2apc(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2fpc(PyObject *self, PyObject *args);
 // CALLBACK AND HANDLE SYSTEM
 static PyObject *s2plot_cs2scb(PyObject *self, PyObject *args);
 static PyObject *s2plot_cs2ecb(PyObject *self, PyObject *args);
@@ -210,6 +296,8 @@ static PyObject *s2plot_ss2sl(PyObject *self, PyObject *args);
 static PyObject *s2plot_ss2sbc(PyObject *self, PyObject *args);
 static PyObject *s2plot_ss2sfra(PyObject *self, PyObject *args);
 static PyObject *s2plot_ss2qpt(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2sfb(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2qfq(PyObject *self, PyObject *args);
 // ADVANCED CAMERA CONTROL
 static PyObject *s2plot_ss2sc(PyObject *self, PyObject *args);
 static PyObject *s2plot_ss2qc(PyObject *self, PyObject *args);
@@ -233,14 +321,33 @@ static PyObject *s2plot_ss2ltt(PyObject *self, PyObject *args); /* NEW */
 static PyObject *s2plot_s2latexture(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vf3a(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2vpa(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2vnpa(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2cis(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2cisc(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2xis(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2cxs(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2sxsl(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2dxs(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2qxs(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2wxs(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2fxs(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2mxs(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2uxs(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2dis(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2sisl(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2sisa(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2sisc(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2cvr(PyObject *self, PyObject *args);
 static PyObject *s2plot_ds2dvr(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2mvr(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2mfits(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2mraw(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2cts(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2sts(PyObject *self, PyObject *args);
+static PyObject *s2plot_ss2qts(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2cvrts(PyObject *self, PyObject *args);
+static PyObject *s2plot_ns2cvrp(PyObject *self, PyObject *args);
+static PyObject *s2plot_ds2dvrp(PyObject *self, PyObject *args);
 static PyObject *s2plot_ns2svrl(PyObject *self, PyObject *args);
 static PyObject *s2plot_ss2ct(PyObject *self, PyObject *args);
 static PyObject *s2plot_ss2ctt(PyObject *self, PyObject *args);